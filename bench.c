@@ -0,0 +1,106 @@
+/*--------------------------------------------------------------------*/
+/* bench.c                                                            */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+
+/* State of the xorshift64* pseudo-random number generator. A fixed default
+ * seed keeps runs comparable with each other. */
+static unsigned long long ullRandomState = 0x9E3779B97F4A7C15ULL;
+
+double Bench_now(void) {
+    struct timespec sTime;
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+void Bench_seed(unsigned long long ullSeed) {
+    /* xorshift never leaves the all-zero state */
+    ullRandomState = ullSeed != 0 ? ullSeed : 0x9E3779B97F4A7C15ULL;
+}
+
+double Bench_random(void) {
+    ullRandomState ^= ullRandomState >> 12;
+    ullRandomState ^= ullRandomState << 25;
+    ullRandomState ^= ullRandomState >> 27;
+    return (double)((ullRandomState * 2685821657736338717ULL) >> 11) /
+           9007199254740992.0;
+}
+
+void Bench_shuffle(size_t *auArray, size_t uCount) {
+    size_t i;
+    assert(auArray != NULL || uCount == 0);
+    for (i = uCount; i > 1; i--) {
+        size_t j = (size_t)(Bench_random() * (double)i);
+        size_t uTemp = auArray[i - 1];
+        auArray[i - 1] = auArray[j];
+        auArray[j] = uTemp;
+    }
+}
+
+int Bench_zipf(size_t *auIndices, size_t uCount, size_t uKeyCount,
+               double dExponent) {
+    double *adCdf;
+    size_t *auRankToKey;
+    double dTotal = 0.0;
+    size_t i;
+
+    assert(auIndices != NULL);
+    assert(uKeyCount > 0);
+
+    adCdf = (double *)malloc(sizeof(double) * uKeyCount);
+    auRankToKey = (size_t *)malloc(sizeof(size_t) * uKeyCount);
+    if (adCdf == NULL || auRankToKey == NULL) {
+        free(adCdf);
+        free(auRankToKey);
+        return 0;
+    }
+
+    for (i = 0; i < uKeyCount; i++) {
+        dTotal += 1.0 / pow((double)(i + 1), dExponent);
+        adCdf[i] = dTotal;
+        auRankToKey[i] = i;
+    }
+    Bench_shuffle(auRankToKey, uKeyCount);
+    for (i = 0; i < uCount; i++) {
+        /* Binary search for the first rank whose cumulative weight exceeds
+         * the random draw. */
+        double dTarget = Bench_random() * dTotal;
+        size_t uLow = 0, uHigh = uKeyCount - 1;
+        while (uLow < uHigh) {
+            size_t uMid = (uLow + uHigh) / 2;
+            if (adCdf[uMid] <= dTarget)
+                uLow = uMid + 1;
+            else
+                uHigh = uMid;
+        }
+        auIndices[i] = auRankToKey[uLow];
+    }
+    free(adCdf);
+    free(auRankToKey);
+    return 1;
+}
+
+/* Compare the doubles that pv1 and pv2 point to, for qsort. */
+static int Bench_compareDoubles(const void *pv1, const void *pv2) {
+    double d1 = *(const double *)pv1;
+    double d2 = *(const double *)pv2;
+    return (d1 > d2) - (d1 < d2);
+}
+
+double Bench_percentile(double *adSamples, size_t uCount, double dPercentile) {
+    size_t uIndex;
+    assert(adSamples != NULL);
+    assert(uCount > 0);
+    qsort(adSamples, uCount, sizeof(double), Bench_compareDoubles);
+    uIndex = (size_t)(dPercentile / 100.0 * (double)(uCount - 1) + 0.5);
+    return adSamples[uIndex];
+}
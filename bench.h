@@ -0,0 +1,35 @@
+/*--------------------------------------------------------------------*/
+/* bench.h                                                            */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+/* Returns the current value of the monotonic wall clock in nanoseconds. */
+double Bench_now(void);
+
+/* Sets the seed of the pseudo-random number generator used by the other
+ * functions. Runs with the same seed see the same sequence. */
+void Bench_seed(unsigned long long ullSeed);
+
+/* Returns the next pseudo-random number in [0, 1). */
+double Bench_random(void);
+
+/* Shuffles the uCount elements of auArray into a pseudo-random order. */
+void Bench_shuffle(size_t *auArray, size_t uCount);
+
+/* Fills auIndices with uCount indices in [0, uKeyCount) drawn from a Zipf
+ * distribution with exponent dExponent. Popularity ranks are shuffled over
+ * the indices, so the most popular index is not simply 0. Returns 1, or 0 if
+ * insufficient memory is available. */
+int Bench_zipf(size_t *auIndices, size_t uCount, size_t uKeyCount,
+               double dExponent);
+
+/* Sorts the uCount samples in adSamples in place and returns their
+ * dPercentile-th percentile, where dPercentile is between 0 and 100. */
+double Bench_percentile(double *adSamples, size_t uCount, double dPercentile);
+
+#endif
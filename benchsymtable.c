@@ -0,0 +1,390 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "symtable.h"
+
+/* Number of operations timed together as one sample, the minimum number of
+ * operations of each kind per measurement (small tables are rebuilt until
+ * they reach it), and the largest table the list backend is run with unless
+ * it is requested explicitly. */
+enum {
+    BATCH_SIZE = 32,
+    MIN_OPERATIONS = 1 << 18,
+    LIST_MAX_BINDINGS = 20000,
+    MAX_OPTIONS = 16
+};
+/* DIST_COLLIDE keys all fall into one bucket of a hash backend table with
+ * COLLIDE_BUCKET_COUNT buckets, which is the bucket count of a table of up to
+ * COLLIDE_MAX_BINDINGS bindings. Larger tables are skipped because the table
+ * would expand and scatter the keys. */
+enum { COLLIDE_BUCKET_COUNT = 509, COLLIDE_MAX_BINDINGS = 508 };
+/* Exponent of the Zipf distribution */
+static const double ZIPF_EXPONENT = 1.0;
+/* Length of a generated random key, excluding the terminating '\0' */
+enum { RANDOM_KEY_LENGTH = 12 };
+
+/* The measured operations */
+enum Operation {
+    OP_PUT,
+    OP_GET_HIT,
+    OP_GET_MISS,
+    OP_REPLACE,
+    OP_MAP,
+    OP_REMOVE,
+    OPERATION_COUNT
+};
+static const char *apcOperationNames[OPERATION_COUNT] = {
+    "put", "get-hit", "get-miss", "replace", "map", "remove"};
+
+/* Key distributions. DIST_SEQUENTIAL uses decimal keys accessed in order, as
+ * testsymtable.c does; DIST_RANDOM uses random strings accessed in random
+ * order; DIST_ZIPF uses random strings with gets and replaces drawn from a
+ * Zipf distribution; DIST_COLLIDE uses random strings chosen, as an attacker
+ * would, so that the unkeyed hash sends them all to the same bucket. */
+enum Distribution {
+    DIST_SEQUENTIAL,
+    DIST_RANDOM,
+    DIST_ZIPF,
+    DIST_COLLIDE,
+    DIST_COUNT
+};
+static const char *apcDistributionNames[DIST_COUNT] = {"seq", "random",
+                                                      "zipf", "collide"};
+
+/* Default table sizes */
+static const size_t auDefaultSizes[] = {10,    100,    1000,
+                                        10000, 100000, 1000000};
+
+/* A Samples object is a growable array of per-operation times */
+struct Samples {
+    /* Nanoseconds per operation of each sample */
+    double *adNs;
+    /* Number of samples */
+    size_t uCount;
+    /* Number of samples adNs has room for */
+    size_t uCapacity;
+};
+
+/* A Workload object holds the keys and access orders of one measurement */
+struct Workload {
+    /* Keys that are put into the table */
+    char **apcKeys;
+    /* Keys that are never put into the table */
+    char **apcMissKeys;
+    /* Storage for all of the keys */
+    char *pcKeyChars;
+    /* Indices into apcKeys for gets and replaces */
+    size_t *auGetOrder;
+    /* Indices into apcKeys for removes */
+    size_t *auRemoveOrder;
+    /* Number of keys in apcKeys */
+    size_t uCount;
+};
+
+/* Print the message pcMessage to stderr and exit with EXIT_FAILURE. */
+static void fail(const char *pcMessage) {
+    fprintf(stderr, "%s\n", pcMessage);
+    exit(EXIT_FAILURE);
+}
+
+/* Append dNs to *psSamples. */
+static void addSample(struct Samples *psSamples, double dNs) {
+    if (psSamples->uCount == psSamples->uCapacity) {
+        size_t uCapacity = psSamples->uCapacity * 2 + 64;
+        double *adNs =
+            (double *)realloc(psSamples->adNs, uCapacity * sizeof(double));
+        if (adNs == NULL) fail("insufficient memory");
+        psSamples->adNs = adNs;
+        psSamples->uCapacity = uCapacity;
+    }
+    psSamples->adNs[psSamples->uCount++] = dNs;
+}
+
+/* Return the bucket of pcKey in an unkeyed hash backend table with
+ * uBucketCount buckets. */
+static size_t unkeyedBucket(const char *pcKey, size_t uBucketCount) {
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t uHash = 0;
+    size_t u;
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    return uHash % uBucketCount;
+}
+
+/* Write key uIndex of distribution eDistribution into pcKey. Miss keys, for
+ * which iMiss is nonzero, never equal a key with iMiss zero. */
+static void makeKey(char *pcKey, enum Distribution eDistribution,
+                    size_t uIndex, size_t uCount, int iMiss) {
+    static const char acAlphabet[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    size_t i;
+    if (eDistribution == DIST_SEQUENTIAL) {
+        if (iMiss) uIndex += uCount;
+        sprintf(pcKey, "%lu", (unsigned long)uIndex);
+        return;
+    }
+    do {
+        pcKey[0] = iMiss ? '~' : acAlphabet[(size_t)(Bench_random() * 62)];
+        for (i = 1; i < RANDOM_KEY_LENGTH; i++)
+            pcKey[i] = acAlphabet[(size_t)(Bench_random() * 62)];
+        pcKey[RANDOM_KEY_LENGTH] = '\0';
+    } while (eDistribution == DIST_COLLIDE &&
+             unkeyedBucket(pcKey, COLLIDE_BUCKET_COUNT) != 0);
+}
+
+/* Fill *psWorkload with uCount keys of distribution eDistribution. */
+static void makeWorkload(struct Workload *psWorkload,
+                         enum Distribution eDistribution, size_t uCount) {
+    enum { KEY_SIZE = RANDOM_KEY_LENGTH + 1 };
+    size_t i;
+    psWorkload->uCount = uCount;
+    psWorkload->apcKeys = (char **)malloc(uCount * sizeof(char *));
+    psWorkload->apcMissKeys = (char **)malloc(uCount * sizeof(char *));
+    psWorkload->pcKeyChars = (char *)malloc(2 * uCount * KEY_SIZE);
+    psWorkload->auGetOrder = (size_t *)malloc(uCount * sizeof(size_t));
+    psWorkload->auRemoveOrder = (size_t *)malloc(uCount * sizeof(size_t));
+    if (psWorkload->apcKeys == NULL || psWorkload->apcMissKeys == NULL ||
+        psWorkload->pcKeyChars == NULL || psWorkload->auGetOrder == NULL ||
+        psWorkload->auRemoveOrder == NULL)
+        fail("insufficient memory");
+
+    for (i = 0; i < uCount; i++) {
+        psWorkload->apcKeys[i] = psWorkload->pcKeyChars + 2 * i * KEY_SIZE;
+        psWorkload->apcMissKeys[i] = psWorkload->apcKeys[i] + KEY_SIZE;
+        makeKey(psWorkload->apcKeys[i], eDistribution, i, uCount, 0);
+        makeKey(psWorkload->apcMissKeys[i], eDistribution, i, uCount, 1);
+        psWorkload->auGetOrder[i] = i;
+        psWorkload->auRemoveOrder[i] = i;
+    }
+    if (eDistribution == DIST_RANDOM || eDistribution == DIST_COLLIDE) {
+        Bench_shuffle(psWorkload->auGetOrder, uCount);
+        Bench_shuffle(psWorkload->auRemoveOrder, uCount);
+    } else if (eDistribution == DIST_ZIPF) {
+        if (!Bench_zipf(psWorkload->auGetOrder, uCount, uCount,
+                        ZIPF_EXPONENT))
+            fail("insufficient memory");
+        Bench_shuffle(psWorkload->auRemoveOrder, uCount);
+    }
+}
+
+/* Free the memory owned by *psWorkload. */
+static void freeWorkload(struct Workload *psWorkload) {
+    free(psWorkload->apcKeys);
+    free(psWorkload->apcMissKeys);
+    free(psWorkload->pcKeyChars);
+    free(psWorkload->auGetOrder);
+    free(psWorkload->auRemoveOrder);
+}
+
+/* Count the bindings that SymTable_map visits into *pvExtra, a size_t. */
+static void countBinding(const char *pcKey, void *pvValue, void *pvExtra) {
+    (void)pcKey;
+    (void)pvValue;
+    (*(size_t *)pvExtra)++;
+}
+
+/* Perform operation eOperation on every key of *psWorkload in oSymTable, in
+ * batches of BATCH_SIZE, and append the time per operation of each batch to
+ * *psSamples. Exits if an operation does not have the expected result. */
+static void timeOperation(SymTable_T oSymTable, enum Operation eOperation,
+                          const struct Workload *psWorkload,
+                          struct Samples *psSamples) {
+    size_t uCount = psWorkload->uCount;
+    char **apcKeys = psWorkload->apcKeys;
+    size_t uOk = 0;
+    size_t i, j;
+
+    if (eOperation == OP_MAP) {
+        size_t uVisited = 0;
+        double dStart = Bench_now();
+        SymTable_map(oSymTable, countBinding, &uVisited);
+        addSample(psSamples, (Bench_now() - dStart) / (double)uCount);
+        if (uVisited != uCount) fail("SymTable_map missed bindings");
+        return;
+    }
+
+    for (i = 0; i < uCount; i += BATCH_SIZE) {
+        size_t uEnd = i + BATCH_SIZE < uCount ? i + BATCH_SIZE : uCount;
+        double dStart = Bench_now();
+        switch (eOperation) {
+            case OP_PUT:
+                for (j = i; j < uEnd; j++)
+                    uOk += (size_t)SymTable_put(oSymTable, apcKeys[j],
+                                                apcKeys[j]);
+                break;
+            case OP_GET_HIT:
+                for (j = i; j < uEnd; j++)
+                    uOk += SymTable_get(oSymTable,
+                                        apcKeys[psWorkload->auGetOrder[j]]) !=
+                           NULL;
+                break;
+            case OP_GET_MISS:
+                for (j = i; j < uEnd; j++)
+                    uOk += SymTable_get(oSymTable,
+                                        psWorkload->apcMissKeys[j]) == NULL;
+                break;
+            case OP_REPLACE:
+                for (j = i; j < uEnd; j++) {
+                    char *pcKey = apcKeys[psWorkload->auGetOrder[j]];
+                    uOk += SymTable_replace(oSymTable, pcKey, pcKey) != NULL;
+                }
+                break;
+            case OP_REMOVE:
+                for (j = i; j < uEnd; j++)
+                    uOk += SymTable_remove(
+                               oSymTable,
+                               apcKeys[psWorkload->auRemoveOrder[j]]) != NULL;
+                break;
+            default:
+                assert(0);
+        }
+        addSample(psSamples, (Bench_now() - dStart) / (double)(uEnd - i));
+    }
+    if (uOk != uCount) {
+        fprintf(stderr, "%s: unexpected result\n",
+                apcOperationNames[eOperation]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Measure every operation on tables of backend pcBackend holding the keys of
+ * *psWorkload, and print one line per operation. */
+static void benchCell(const char *pcBackend, const char *pcDistribution,
+                      const struct Workload *psWorkload) {
+    struct Samples asSamples[OPERATION_COUNT];
+    size_t uRounds = MIN_OPERATIONS / psWorkload->uCount;
+    size_t uRound;
+    int iOperation;
+
+    if (uRounds == 0) uRounds = 1;
+    memset(asSamples, 0, sizeof(asSamples));
+    for (uRound = 0; uRound < uRounds; uRound++) {
+        SymTable_T oSymTable = SymTable_newWithBackend(pcBackend);
+        if (oSymTable == NULL) fail("cannot create table");
+        for (iOperation = 0; iOperation < OPERATION_COUNT; iOperation++)
+            timeOperation(oSymTable, (enum Operation)iOperation, psWorkload,
+                          &asSamples[iOperation]);
+        if (SymTable_getLength(oSymTable) != 0) fail("table not empty");
+        SymTable_free(oSymTable);
+    }
+
+    for (iOperation = 0; iOperation < OPERATION_COUNT; iOperation++) {
+        struct Samples *psSamples = &asSamples[iOperation];
+        double dSum = 0.0;
+        size_t i;
+        for (i = 0; i < psSamples->uCount; i++) dSum += psSamples->adNs[i];
+        printf("%-13s %-7s %9lu %-9s %10.1f %10.1f %10.1f %10.1f\n", pcBackend,
+               pcDistribution, (unsigned long)psWorkload->uCount,
+               apcOperationNames[iOperation],
+               dSum / (double)psSamples->uCount,
+               Bench_percentile(psSamples->adNs, psSamples->uCount, 50.0),
+               Bench_percentile(psSamples->adNs, psSamples->uCount, 90.0),
+               Bench_percentile(psSamples->adNs, psSamples->uCount, 99.0));
+        fflush(stdout);
+        free(psSamples->adNs);
+    }
+}
+
+/* Return the index of pcName in apcNames[0..iCount-1], or -1. */
+static int findName(const char *pcName, const char **apcNames, int iCount) {
+    int i;
+    for (i = 0; i < iCount; i++)
+        if (strcmp(pcName, apcNames[i]) == 0) return i;
+    return -1;
+}
+
+/* Print the usage message for program pcProgram and exit. */
+static void usage(const char *pcProgram) {
+    fprintf(stderr,
+            "Usage: %s [-b backend]... [-d seq|random|zipf|collide]... "
+            "[-n bindingcount]...\n",
+            pcProgram);
+    exit(EXIT_FAILURE);
+}
+
+/* Time put, hit-get, miss-get, replace, map and remove separately for each
+ * registered backend, key distribution and table size, and write the mean
+ * and the 50th, 90th and 99th percentile nanoseconds per operation to
+ * stdout. The -b, -d and -n options, each of which may be repeated, restrict
+ * the run to the given backends, distributions and sizes. Exit with
+ * EXIT_FAILURE if the arguments are invalid or an operation misbehaves. */
+int main(int argc, char *argv[]) {
+    const char *apcBackends[MAX_OPTIONS];
+    int aiDistributions[MAX_OPTIONS];
+    size_t auSizes[MAX_OPTIONS];
+    int iBackendCount = 0, iDistributionCount = 0, iSizeCount = 0;
+    int iExplicitBackends;
+    int i, iBackend, iDistribution, iSize;
+
+    for (i = 1; i < argc; i++) {
+        unsigned long ulSize;
+        if (i + 1 == argc || strlen(argv[i]) != 2 || argv[i][0] != '-')
+            usage(argv[0]);
+        if (argv[i][1] == 'b' && iBackendCount < MAX_OPTIONS) {
+            apcBackends[iBackendCount++] = argv[++i];
+        } else if (argv[i][1] == 'd' && iDistributionCount < MAX_OPTIONS) {
+            int iFound = findName(argv[++i], apcDistributionNames, DIST_COUNT);
+            if (iFound < 0) usage(argv[0]);
+            aiDistributions[iDistributionCount++] = iFound;
+        } else if (argv[i][1] == 'n' && iSizeCount < MAX_OPTIONS) {
+            if (sscanf(argv[++i], "%lu", &ulSize) != 1 || ulSize == 0)
+                usage(argv[0]);
+            auSizes[iSizeCount++] = (size_t)ulSize;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    iExplicitBackends = iBackendCount > 0;
+    if (!iExplicitBackends)
+        for (; iBackendCount < MAX_OPTIONS &&
+               (size_t)iBackendCount < SymTable_getBackendCount();
+             iBackendCount++)
+            apcBackends[iBackendCount] =
+                SymTable_getBackendName((size_t)iBackendCount);
+    if (iDistributionCount == 0)
+        for (; iDistributionCount < DIST_COUNT; iDistributionCount++)
+            aiDistributions[iDistributionCount] = iDistributionCount;
+    if (iSizeCount == 0)
+        for (; (size_t)iSizeCount <
+               sizeof(auDefaultSizes) / sizeof(auDefaultSizes[0]);
+             iSizeCount++)
+            auSizes[iSizeCount] = auDefaultSizes[iSizeCount];
+
+    printf("%-13s %-7s %9s %-9s %10s %10s %10s %10s\n", "backend", "keys",
+           "bindings", "operation", "mean ns", "p50 ns", "p90 ns", "p99 ns");
+    for (iDistribution = 0; iDistribution < iDistributionCount;
+         iDistribution++) {
+        for (iSize = 0; iSize < iSizeCount; iSize++) {
+            struct Workload sWorkload;
+            if (aiDistributions[iDistribution] == DIST_COLLIDE &&
+                auSizes[iSize] > COLLIDE_MAX_BINDINGS)
+                continue;
+            Bench_seed((unsigned long long)auSizes[iSize]);
+            makeWorkload(&sWorkload,
+                         (enum Distribution)aiDistributions[iDistribution],
+                         auSizes[iSize]);
+            for (iBackend = 0; iBackend < iBackendCount; iBackend++) {
+                /* The list is quadratic: only run it on big tables when
+                 * asked to */
+                if (!iExplicitBackends &&
+                    strcmp(apcBackends[iBackend], "list") == 0 &&
+                    auSizes[iSize] > LIST_MAX_BINDINGS)
+                    continue;
+                benchCell(apcBackends[iBackend],
+                          apcDistributionNames[aiDistributions[iDistribution]],
+                          &sWorkload);
+            }
+            freeWorkload(&sWorkload);
+        }
+    }
+    return 0;
+}
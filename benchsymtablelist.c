@@ -0,0 +1,122 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtablelist.c                                                */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "symtablelist.h"
+
+/* Default number of bindings and lookups, and the Zipf exponent. Small
+ * scopes with a handful of hot names are what the list is used for. */
+enum { DEFAULT_BINDING_COUNT = 64, DEFAULT_LOOKUP_COUNT = 2000000 };
+static const double ZIPF_EXPONENT = 1.0;
+
+/* Maximum length of a generated key, including the terminating '\0' */
+enum { MAX_KEY_LENGTH = 16 };
+
+/* Build a list table with policy ePolicy holding the keys in acKeys, perform
+ * the lookups in auIndices, and print the time consumed per lookup. */
+static void benchPolicy(const char *pcName, enum SymTableListPolicy ePolicy,
+                        char (*acKeys)[MAX_KEY_LENGTH], int iBindingCount,
+                        const size_t *auIndices, int iLookupCount) {
+    SymTable_T oSymTable = SymTableList_new(ePolicy);
+    size_t uHits = 0;
+    double dStart, dElapsed;
+    int i;
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < iBindingCount; i++)
+        if (!SymTable_put(oSymTable, acKeys[i], acKeys[i])) {
+            fprintf(stderr, "insufficient memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+    dStart = Bench_now();
+    for (i = 0; i < iLookupCount; i++)
+        if (SymTable_get(oSymTable, acKeys[auIndices[i]]) != NULL) uHits++;
+    dElapsed = Bench_now() - dStart;
+
+    assert(uHits == (size_t)iLookupCount);
+    printf("%-14s %10.2f ns/get\n", pcName, dElapsed / iLookupCount);
+    fflush(stdout);
+    SymTable_free(oSymTable);
+}
+
+/* Print the time consumed per binding to build a table holding the keys in
+ * acKeys with pfPut, which is SymTable_put or SymTableList_putUnique. */
+static void benchBuild(const char *pcName,
+                       int (*pfPut)(SymTable_T oSymTable, const char *pcKey,
+                                    const void *pvValue),
+                       char (*acKeys)[MAX_KEY_LENGTH], int iBindingCount) {
+    SymTable_T oSymTable = SymTableList_new(SYMTABLE_LIST_STATIC);
+    double dStart, dElapsed;
+    int i;
+    assert(oSymTable != NULL);
+
+    dStart = Bench_now();
+    for (i = 0; i < iBindingCount; i++)
+        if (!(*pfPut)(oSymTable, acKeys[i], acKeys[i])) {
+            fprintf(stderr, "insufficient memory\n");
+            exit(EXIT_FAILURE);
+        }
+    dElapsed = Bench_now() - dStart;
+
+    printf("%-14s %10.2f ns/put\n", pcName, dElapsed / iBindingCount);
+    fflush(stdout);
+    SymTable_free(oSymTable);
+}
+
+/* Time building a list SymTable with and without the duplicate check, then
+ * time SymTable_get under a Zipf-distributed access pattern with each
+ * self-organizing policy. argv[1], if present, is the number of bindings and
+ * argv[2], if present, is the number of lookups. Exit with EXIT_FAILURE if
+ * an argument is not a positive number. */
+int main(int argc, char *argv[]) {
+    int iBindingCount = DEFAULT_BINDING_COUNT;
+    int iLookupCount = DEFAULT_LOOKUP_COUNT;
+    char (*acKeys)[MAX_KEY_LENGTH];
+    size_t *auIndices;
+    int i;
+
+    if (argc > 3 || (argc > 1 && sscanf(argv[1], "%d", &iBindingCount) != 1) ||
+        (argc > 2 && sscanf(argv[2], "%d", &iLookupCount) != 1) ||
+        iBindingCount <= 0 || iLookupCount <= 0) {
+        fprintf(stderr, "Usage: %s [bindingcount [lookupcount]]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    acKeys = (char (*)[MAX_KEY_LENGTH])malloc(MAX_KEY_LENGTH *
+                                              (size_t)iBindingCount);
+    auIndices = (size_t *)malloc(sizeof(size_t) * (size_t)iLookupCount);
+    if (acKeys == NULL || auIndices == NULL) {
+        fprintf(stderr, "insufficient memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < iBindingCount; i++) sprintf(acKeys[i], "name%d", i);
+    if (!Bench_zipf(auIndices, (size_t)iLookupCount, (size_t)iBindingCount,
+                    ZIPF_EXPONENT)) {
+        fprintf(stderr, "insufficient memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Building a table of %d bindings\n", iBindingCount);
+    benchBuild("put", SymTable_put, acKeys, iBindingCount);
+    benchBuild("putUnique", SymTableList_putUnique, acKeys, iBindingCount);
+
+    printf("Zipf(s=%.2f) lookups: %d bindings, %d gets\n", ZIPF_EXPONENT,
+           iBindingCount, iLookupCount);
+    benchPolicy("static", SYMTABLE_LIST_STATIC, acKeys, iBindingCount,
+                auIndices, iLookupCount);
+    benchPolicy("move-to-front", SYMTABLE_LIST_MOVE_TO_FRONT, acKeys,
+                iBindingCount, auIndices, iLookupCount);
+    benchPolicy("transpose", SYMTABLE_LIST_TRANSPOSE, acKeys, iBindingCount,
+                auIndices, iLookupCount);
+
+    free(acKeys);
+    free(auIndices);
+    return 0;
+}
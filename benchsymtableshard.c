@@ -0,0 +1,285 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtableshard.c                                               */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "bench.h"
+#include "symtableshard.h"
+
+/* Number of gets each thread times, and the largest number of threads or
+ * shards a run may ask for */
+enum { OPERATIONS_PER_THREAD = 1 << 20, MAX_THREADS = 256 };
+/* Default table size, and default number of shards per node */
+enum { DEFAULT_BINDINGS = 1000000, DEFAULT_SHARDS_PER_NODE = 4 };
+/* Length of a generated random key, excluding the terminating '\0' */
+enum { RANDOM_KEY_LENGTH = 12 };
+
+/* A Worker object is the state of one timed thread */
+struct Worker {
+    /* The thread */
+    pthread_t thread;
+    /* Table the thread reads */
+    SymTableShard_T table;
+    /* Keys the thread gets, in the order it gets them */
+    char **apcKeys;
+    /* Number of keys in apcKeys, at least 1 */
+    size_t uKeyCount;
+    /* Index in apcKeys of the first key the thread gets */
+    size_t uStart;
+    /* Node the thread runs on */
+    int node;
+    /* Nanoseconds the thread took */
+    double dNs;
+    /* 1 if every get found its key */
+    int allFound;
+};
+
+/* A Filler object is the state of a thread that puts the keys of the
+ * shards on one node */
+struct Filler {
+    /* The thread */
+    pthread_t thread;
+    /* Table the thread fills */
+    SymTableShard_T table;
+    /* Keys to put, of which the thread puts those of shards on its node */
+    char **apcKeys;
+    /* Number of keys in apcKeys */
+    size_t uKeyCount;
+    /* Node the thread runs on */
+    int node;
+    /* 1 if every put succeeded or found its key already there */
+    int allPut;
+};
+
+/* Print the message pcMessage to stderr and exit with EXIT_FAILURE. */
+static void fail(const char *pcMessage) {
+    fprintf(stderr, "%s\n", pcMessage);
+    exit(EXIT_FAILURE);
+}
+
+/* Print the usage message for program pcProgram and exit. */
+static void usage(const char *pcProgram) {
+    fprintf(stderr,
+            "Usage: %s [-n bindingcount] [-s shardcount] [-t threadcount] "
+            "[-b backend]\n",
+            pcProgram);
+    exit(EXIT_FAILURE);
+}
+
+/* Run the calling thread on node iNode, if shards can be placed. */
+static void runOnNode(int iNode) {
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0 && numa_run_on_node(iNode) != 0)
+        fail("cannot run on node");
+#else
+    (void)iNode;
+#endif
+}
+
+/* Put the keys of the Filler pvFiller that belong to shards on its node,
+ * from its node, so that the bindings are allocated there. */
+static void *runFiller(void *pvFiller) {
+    struct Filler *psFiller = (struct Filler *)pvFiller;
+    size_t u;
+
+    runOnNode(psFiller->node);
+    psFiller->allPut = 1;
+    for (u = 0; u < psFiller->uKeyCount; u++) {
+        char *pcKey = psFiller->apcKeys[u];
+        size_t uShard = SymTableShard_getShard(psFiller->table, pcKey);
+        if (SymTableShard_getNode(psFiller->table, uShard) != psFiller->node)
+            continue;
+        /* A duplicate key is put once and got as often as it occurs */
+        if (!SymTableShard_put(psFiller->table, pcKey, pcKey) &&
+            !SymTableShard_contains(psFiller->table, pcKey))
+            psFiller->allPut = 0;
+    }
+    return NULL;
+}
+
+/* Get OPERATIONS_PER_THREAD keys of the Worker pvWorker, cycling through
+ * its keys, and record the time taken. Every value is non-NULL. */
+static void *runWorker(void *pvWorker) {
+    struct Worker *psWorker = (struct Worker *)pvWorker;
+    size_t uIndex = psWorker->uStart;
+    double dStart;
+    int i;
+
+    runOnNode(psWorker->node);
+    psWorker->allFound = 1;
+    dStart = Bench_now();
+    for (i = 0; i < OPERATIONS_PER_THREAD; i++) {
+        char *pcKey = psWorker->apcKeys[uIndex];
+        if (SymTableShard_get(psWorker->table, pcKey) == NULL)
+            psWorker->allFound = 0;
+        if (++uIndex == psWorker->uKeyCount) uIndex = 0;
+    }
+    psWorker->dNs = Bench_now() - dStart;
+    return NULL;
+}
+
+/* Time iThreadCount threads on node iNode getting the uKeyCount keys
+ * apcKeys from oTable, and write the throughput to stdout under the label
+ * pcKind. Write a dash instead if uKeyCount is 0. */
+static void benchNode(SymTableShard_T oTable, int iNode, const char *pcKind,
+                      char **apcKeys, size_t uKeyCount, int iThreadCount) {
+    struct Worker asWorkers[MAX_THREADS];
+    double dMaxNs = 0.0;
+    int i;
+
+    printf("%4d %-7s %7d %9lu ", iNode, pcKind, iThreadCount,
+           (unsigned long)uKeyCount);
+    if (uKeyCount == 0) {
+        printf("%12s %10s\n", "-", "-");
+        return;
+    }
+    for (i = 0; i < iThreadCount; i++) {
+        struct Worker *psWorker = &asWorkers[i];
+        psWorker->table = oTable;
+        psWorker->apcKeys = apcKeys;
+        psWorker->uKeyCount = uKeyCount;
+        psWorker->uStart = uKeyCount / (size_t)iThreadCount * (size_t)i;
+        psWorker->node = iNode;
+        if (pthread_create(&psWorker->thread, NULL, runWorker, psWorker) != 0)
+            fail("cannot create thread");
+    }
+    for (i = 0; i < iThreadCount; i++) {
+        pthread_join(asWorkers[i].thread, NULL);
+        if (!asWorkers[i].allFound) fail("get failed");
+        if (asWorkers[i].dNs > dMaxNs) dMaxNs = asWorkers[i].dNs;
+    }
+    printf("%12.2f %10.1f\n",
+           (double)OPERATIONS_PER_THREAD * iThreadCount / dMaxNs * 1e3,
+           dMaxNs / OPERATIONS_PER_THREAD);
+    fflush(stdout);
+}
+
+/* Build a SymTableShard with the shards spread over the NUMA nodes, and
+ * for each node time threads pinned to it getting keys held by shards on
+ * that node (local) and on the other nodes (remote). Write the throughput
+ * in millions of gets per second and the time per get of each thread to
+ * stdout. The -n, -s, and -t options set the number of bindings, the
+ * number of shards, and the number of threads per measurement, and the -b
+ * option the backend of the shards, "hash" by default. Exit with
+ * EXIT_FAILURE if the arguments are invalid or an operation misbehaves. */
+int main(int argc, char *argv[]) {
+    static const char acAlphabet[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    int iNodeCount = SymTableShard_getNodeCount();
+    size_t uBindingCount = DEFAULT_BINDINGS;
+    size_t uShardCount = (size_t)iNodeCount * DEFAULT_SHARDS_PER_NODE;
+    int iThreadCount = 1;
+    const char *pcBackend = "hash";
+    SymTableShard_T oTable;
+    struct Filler *asFillers;
+    char *pcKeyChars;
+    char **apcKeys, **apcLocal, **apcRemote;
+    size_t *auOrder;
+    size_t u, uLocalCount, uRemoteCount;
+    int i, iIndex;
+
+    for (i = 1; i < argc; i++) {
+        unsigned long ulValue;
+        if (i + 1 == argc || strlen(argv[i]) != 2 || argv[i][0] != '-')
+            usage(argv[0]);
+        i++;
+        if (argv[i - 1][1] == 'b') {
+            pcBackend = argv[i];
+            continue;
+        }
+        if (sscanf(argv[i], "%lu", &ulValue) != 1 || ulValue == 0)
+            usage(argv[0]);
+        if (argv[i - 1][1] == 'n')
+            uBindingCount = (size_t)ulValue;
+        else if (argv[i - 1][1] == 's')
+            uShardCount = (size_t)ulValue;
+        else if (argv[i - 1][1] == 't' && ulValue <= MAX_THREADS)
+            iThreadCount = (int)ulValue;
+        else
+            usage(argv[0]);
+    }
+
+    oTable = SymTableShard_new(uShardCount, pcBackend, NULL);
+    pcKeyChars = (char *)malloc(uBindingCount * (RANDOM_KEY_LENGTH + 1));
+    apcKeys = (char **)malloc(uBindingCount * sizeof(char *));
+    apcLocal = (char **)malloc(uBindingCount * sizeof(char *));
+    apcRemote = (char **)malloc(uBindingCount * sizeof(char *));
+    auOrder = (size_t *)malloc(uBindingCount * sizeof(size_t));
+    asFillers =
+        (struct Filler *)malloc((size_t)iNodeCount * sizeof(struct Filler));
+    if (oTable == NULL || pcKeyChars == NULL || apcKeys == NULL ||
+        apcLocal == NULL || apcRemote == NULL || auOrder == NULL ||
+        asFillers == NULL)
+        fail("insufficient memory");
+
+    /* Random keys, put in a random order by one thread per node, each
+     * putting the keys of the shards on its node so that their bindings
+     * are allocated there */
+    Bench_seed((unsigned long long)uBindingCount);
+    for (u = 0; u < uBindingCount; u++) {
+        char *pcKey = pcKeyChars + u * (RANDOM_KEY_LENGTH + 1);
+        int j;
+        for (j = 0; j < RANDOM_KEY_LENGTH; j++)
+            pcKey[j] = acAlphabet[(size_t)(Bench_random() *
+                                           (sizeof(acAlphabet) - 1))];
+        pcKey[RANDOM_KEY_LENGTH] = '\0';
+        apcKeys[u] = pcKey;
+        auOrder[u] = u;
+    }
+    Bench_shuffle(auOrder, uBindingCount);
+    for (u = 0; u < uBindingCount; u++) apcLocal[u] = apcKeys[auOrder[u]];
+    for (iIndex = 0; iIndex < iNodeCount; iIndex++) {
+        struct Filler *psFiller = &asFillers[iIndex];
+        psFiller->table = oTable;
+        psFiller->apcKeys = apcLocal;
+        psFiller->uKeyCount = uBindingCount;
+        psFiller->node = SymTableShard_getNodeId(iIndex);
+        if (pthread_create(&psFiller->thread, NULL, runFiller, psFiller) != 0)
+            fail("cannot create thread");
+    }
+    for (iIndex = 0; iIndex < iNodeCount; iIndex++) {
+        pthread_join(asFillers[iIndex].thread, NULL);
+        if (!asFillers[iIndex].allPut) fail("insufficient memory");
+    }
+
+    printf("%d node(s), %lu %s shards\n", iNodeCount,
+           (unsigned long)uShardCount, pcBackend);
+    printf("%4s %-7s %7s %9s %12s %10s\n", "node", "keys", "threads",
+           "bindings", "Mgets/s", "ns/get");
+    for (iIndex = 0; iIndex < iNodeCount; iIndex++) {
+        int iNode = SymTableShard_getNodeId(iIndex);
+        uLocalCount = uRemoteCount = 0;
+        for (u = 0; u < uBindingCount; u++) {
+            char *pcKey = apcKeys[auOrder[u]];
+            size_t uShard = SymTableShard_getShard(oTable, pcKey);
+            if (SymTableShard_getNode(oTable, uShard) == iNode)
+                apcLocal[uLocalCount++] = pcKey;
+            else
+                apcRemote[uRemoteCount++] = pcKey;
+        }
+        benchNode(oTable, iNode, "local", apcLocal, uLocalCount,
+                  iThreadCount);
+        benchNode(oTable, iNode, "remote", apcRemote, uRemoteCount,
+                  iThreadCount);
+    }
+
+    SymTableShard_free(oTable);
+    free(pcKeyChars);
+    free(apcKeys);
+    free(apcLocal);
+    free(apcRemote);
+    free(auOrder);
+    free(asFillers);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*--------------------------------------------------------------------*/
+/* symset.c                                                           */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symset.h"
+#include "symtablebackend.h"
+
+/* Enum containing the initial bucket count, a power of two */
+enum { BUCKET_COUNT = 16 };
+
+/* shortened form for struct SetNode */
+typedef struct SetNode SetNode;
+
+/* A SetNode object is a member of a set, linked into the chain of its
+ * bucket. The key is stored in the same allocation, right after it. */
+struct SetNode {
+    /* The next member in the bucket */
+    struct SetNode *next;
+    /* Hash of the key, so that expansion and the set operations never
+     * rehash keys and most mismatches are rejected without a strcmp */
+    size_t hash;
+};
+
+/* A SymSet object is an array of buckets, each a chain of SetNodes, which
+ * doubles when the members outnumber the buckets. */
+struct SymSet {
+    /* Array of buckets */
+    struct SetNode **buckets;
+    /* Number of buckets, a power of two */
+    size_t size;
+    /* Number of members */
+    size_t numMembers;
+};
+
+/* Return the key of psNode. */
+static const char *SymSet_nodeKey(const SetNode *psNode) {
+    return (const char *)(psNode + 1);
+}
+
+/* Return the link that points to the member of oSymSet whose key is pcKey
+ * and whose hash is hash, or to the NULL at the end of its bucket if there
+ * is no such member. */
+static SetNode **SymSet_findLink(SymSet_T oSymSet, const char *pcKey,
+                                 size_t hash) {
+    SetNode **ppsLink = &oSymSet->buckets[hash & (oSymSet->size - 1)];
+    for (; *ppsLink != NULL; ppsLink = &(*ppsLink)->next)
+        if ((*ppsLink)->hash == hash &&
+            strcmp(SymSet_nodeKey(*ppsLink), pcKey) == 0)
+            break;
+    return ppsLink;
+}
+
+/* Double the buckets of oSymSet, relinking the members by their cached
+ * hashes. If insufficient memory is available the set keeps its
+ * buckets. */
+static void SymSet_expand(SymSet_T oSymSet) {
+    size_t newSize = oSymSet->size * 2;
+    SetNode **newBuckets;
+    size_t i;
+
+    newBuckets = (SetNode **)calloc(newSize, sizeof(SetNode *));
+    if (newBuckets == NULL) return;
+    for (i = 0; i < oSymSet->size; i++) {
+        SetNode *psNode = oSymSet->buckets[i];
+        while (psNode != NULL) {
+            SetNode *psNext = psNode->next;
+            psNode->next = newBuckets[psNode->hash & (newSize - 1)];
+            newBuckets[psNode->hash & (newSize - 1)] = psNode;
+            psNode = psNext;
+        }
+    }
+    free(oSymSet->buckets);
+    oSymSet->buckets = newBuckets;
+    oSymSet->size = newSize;
+}
+
+/* Add pcKey, whose hash is hash, to oSymSet and return 1 if oSymSet does
+ * not contain it and sufficient memory is available, otherwise return 0. */
+static int SymSet_addHashed(SymSet_T oSymSet, const char *pcKey,
+                            size_t hash) {
+    SetNode **ppsLink = SymSet_findLink(oSymSet, pcKey, hash);
+    SetNode *psNode;
+    size_t keyLength;
+
+    if (*ppsLink != NULL) return 0;
+    keyLength = strlen(pcKey) + 1;
+    psNode = (SetNode *)malloc(sizeof(SetNode) + keyLength);
+    if (psNode == NULL) return 0;
+    memcpy((char *)(psNode + 1), pcKey, keyLength);
+    psNode->hash = hash;
+    psNode->next = NULL;
+    *ppsLink = psNode;
+    oSymSet->numMembers++;
+    if (oSymSet->numMembers > oSymSet->size) SymSet_expand(oSymSet);
+    return 1;
+}
+
+/* Return a new SymSet object that contains no keys and has room for
+ * uCount keys before it expands, or NULL if insufficient memory is
+ * available. */
+static SymSet_T SymSet_newSized(size_t uCount) {
+    SymSet_T oSymSet = (SymSet_T)malloc(sizeof(struct SymSet));
+    size_t uSize = BUCKET_COUNT;
+    if (oSymSet == NULL) return NULL;
+    while (uSize < uCount) uSize *= 2;
+    oSymSet->buckets = (SetNode **)calloc(uSize, sizeof(SetNode *));
+    if (oSymSet->buckets == NULL) {
+        free(oSymSet);
+        return NULL;
+    }
+    oSymSet->size = uSize;
+    oSymSet->numMembers = 0;
+    return oSymSet;
+}
+
+SymSet_T SymSet_new(void) { return SymSet_newSized(0); }
+
+void SymSet_free(SymSet_T oSymSet) {
+    size_t i;
+    assert(oSymSet != NULL);
+    for (i = 0; i < oSymSet->size; i++) {
+        SetNode *psNode = oSymSet->buckets[i];
+        while (psNode != NULL) {
+            SetNode *psNext = psNode->next;
+            free(psNode);
+            psNode = psNext;
+        }
+    }
+    free(oSymSet->buckets);
+    free(oSymSet);
+}
+
+size_t SymSet_getLength(SymSet_T oSymSet) {
+    assert(oSymSet != NULL);
+    return oSymSet->numMembers;
+}
+
+int SymSet_add(SymSet_T oSymSet, const char *pcKey) {
+    assert(oSymSet != NULL);
+    assert(pcKey != NULL);
+    return SymSet_addHashed(oSymSet, pcKey, SymTable_mixedHash(pcKey));
+}
+
+int SymSet_contains(SymSet_T oSymSet, const char *pcKey) {
+    assert(oSymSet != NULL);
+    assert(pcKey != NULL);
+    return *SymSet_findLink(oSymSet, pcKey, SymTable_mixedHash(pcKey)) !=
+           NULL;
+}
+
+int SymSet_remove(SymSet_T oSymSet, const char *pcKey) {
+    SetNode **ppsLink;
+    SetNode *psNode;
+    assert(oSymSet != NULL);
+    assert(pcKey != NULL);
+    ppsLink = SymSet_findLink(oSymSet, pcKey, SymTable_mixedHash(pcKey));
+    psNode = *ppsLink;
+    if (psNode == NULL) return 0;
+    *ppsLink = psNode->next;
+    free(psNode);
+    oSymSet->numMembers--;
+    return 1;
+}
+
+void SymSet_map(SymSet_T oSymSet,
+                void (*pfApply)(const char *pcKey, void *pvExtra),
+                const void *pvExtra) {
+    size_t i;
+    assert(oSymSet != NULL);
+    assert(pfApply != NULL);
+    for (i = 0; i < oSymSet->size; i++) {
+        const SetNode *psNode;
+        for (psNode = oSymSet->buckets[i]; psNode != NULL;
+             psNode = psNode->next)
+            (*pfApply)(SymSet_nodeKey(psNode), (void *)pvExtra);
+    }
+}
+
+/* Add to oResult each member of oSource that is in oFilter, if iKeep is
+ * nonzero, or that is not in oFilter, if iKeep is 0; every member of
+ * oSource if oFilter is NULL. Return 1, or 0 if insufficient memory is
+ * available. */
+static int SymSet_addFiltered(SymSet_T oResult, SymSet_T oSource,
+                              SymSet_T oFilter, int iKeep) {
+    size_t i;
+    for (i = 0; i < oSource->size; i++) {
+        const SetNode *psNode;
+        for (psNode = oSource->buckets[i]; psNode != NULL;
+             psNode = psNode->next) {
+            const char *pcKey = SymSet_nodeKey(psNode);
+            if (oFilter != NULL &&
+                (*SymSet_findLink(oFilter, pcKey, psNode->hash) != NULL) !=
+                    (iKeep != 0))
+                continue;
+            if (!SymSet_addHashed(oResult, pcKey, psNode->hash) &&
+                *SymSet_findLink(oResult, pcKey, psNode->hash) == NULL)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* Return oSymSet if iOk is nonzero, or free it and return NULL
+ * otherwise. */
+static SymSet_T SymSet_finish(SymSet_T oSymSet, int iOk) {
+    if (!iOk) {
+        SymSet_free(oSymSet);
+        return NULL;
+    }
+    return oSymSet;
+}
+
+SymSet_T SymSet_union(SymSet_T oSymSet1, SymSet_T oSymSet2) {
+    SymSet_T oResult;
+    assert(oSymSet1 != NULL);
+    assert(oSymSet2 != NULL);
+    oResult = SymSet_newSized(oSymSet1->numMembers + oSymSet2->numMembers);
+    if (oResult == NULL) return NULL;
+    return SymSet_finish(oResult,
+                         SymSet_addFiltered(oResult, oSymSet1, NULL, 0) &&
+                             SymSet_addFiltered(oResult, oSymSet2, NULL, 0));
+}
+
+SymSet_T SymSet_intersection(SymSet_T oSymSet1, SymSet_T oSymSet2) {
+    SymSet_T oSmaller = oSymSet1, oLarger = oSymSet2;
+    SymSet_T oResult;
+    assert(oSymSet1 != NULL);
+    assert(oSymSet2 != NULL);
+    /* Probe the larger set with the members of the smaller one */
+    if (oSmaller->numMembers > oLarger->numMembers) {
+        oSmaller = oSymSet2;
+        oLarger = oSymSet1;
+    }
+    oResult = SymSet_newSized(oSmaller->numMembers);
+    if (oResult == NULL) return NULL;
+    return SymSet_finish(oResult,
+                         SymSet_addFiltered(oResult, oSmaller, oLarger, 1));
+}
+
+SymSet_T SymSet_difference(SymSet_T oSymSet1, SymSet_T oSymSet2) {
+    SymSet_T oResult;
+    assert(oSymSet1 != NULL);
+    assert(oSymSet2 != NULL);
+    oResult = SymSet_newSized(oSymSet1->numMembers);
+    if (oResult == NULL) return NULL;
+    return SymSet_finish(oResult,
+                         SymSet_addFiltered(oResult, oSymSet1, oSymSet2, 0));
+}
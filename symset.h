@@ -0,0 +1,57 @@
+/*--------------------------------------------------------------------*/
+/* symset.h                                                           */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMSET_H
+#define SYMSET_H
+
+#include <stddef.h>
+
+/* A SymSet_T stores a collection of unique string keys without values. It
+ * is a hash table like the hash backend of SymTable_T, but each member is
+ * one allocation holding its hash and a copy of its key, with no value
+ * pointer, and all sets hash alike, so union, intersection, and difference
+ * reuse the cached hashes instead of rehashing keys. */
+typedef struct SymSet *SymSet_T;
+
+/* Return a new SymSet object that contains no keys, or NULL if
+ * insufficient memory is available. */
+SymSet_T SymSet_new(void);
+
+/* Free all memory occupied by oSymSet. */
+void SymSet_free(SymSet_T oSymSet);
+
+/* Return the number of keys in oSymSet. */
+size_t SymSet_getLength(SymSet_T oSymSet);
+
+/* Add a copy of pcKey to oSymSet and return 1 if oSymSet does not contain
+ * pcKey and sufficient memory is available, otherwise return 0. */
+int SymSet_add(SymSet_T oSymSet, const char *pcKey);
+
+/* Return 1 if oSymSet contains pcKey, and 0 otherwise. */
+int SymSet_contains(SymSet_T oSymSet, const char *pcKey);
+
+/* Remove pcKey from oSymSet and return 1 if oSymSet contains it, otherwise
+ * return 0. */
+int SymSet_remove(SymSet_T oSymSet, const char *pcKey);
+
+/* Apply function *pfApply to each key in oSymSet, passing pvExtra as an
+ * extra parameter. The keys are visited in no particular order. */
+void SymSet_map(SymSet_T oSymSet,
+                void (*pfApply)(const char *pcKey, void *pvExtra),
+                const void *pvExtra);
+
+/* Return a new SymSet object that contains the keys in oSymSet1 or
+ * oSymSet2, or NULL if insufficient memory is available. */
+SymSet_T SymSet_union(SymSet_T oSymSet1, SymSet_T oSymSet2);
+
+/* Return a new SymSet object that contains the keys in both oSymSet1 and
+ * oSymSet2, or NULL if insufficient memory is available. */
+SymSet_T SymSet_intersection(SymSet_T oSymSet1, SymSet_T oSymSet2);
+
+/* Return a new SymSet object that contains the keys in oSymSet1 but not in
+ * oSymSet2, or NULL if insufficient memory is available. */
+SymSet_T SymSet_difference(SymSet_T oSymSet1, SymSet_T oSymSet2);
+
+#endif
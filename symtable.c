@@ -0,0 +1,515 @@
+/*--------------------------------------------------------------------*/
+/* symtable.c                                                         */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "symtablebackend.h"
+
+/* The backend used by SymTable_new. The Makefile overrides it to build the
+ * test drivers for each backend. */
+#ifndef SYMTABLE_DEFAULT_BACKEND
+#define SYMTABLE_DEFAULT_BACKEND SymTableHash_backend
+#endif
+
+/* Enum containing the capacity of the backend registry */
+enum { MAX_BACKENDS = 32 };
+
+/* Registered backends, the built-in ones first */
+static const struct SymTableBackend *apsBackends[MAX_BACKENDS] = {
+    &SymTableList_backend, &SymTableHash_backend, &SymTableHybrid_backend,
+    &SymTableHashKeyed_backend, &SymTableHamt_backend,
+    &SymTableHashFiltered_backend, &SymTableCompact_backend};
+/* Number of registered backends */
+static size_t uBackendCount = 7;
+
+/* A CloneState object is the state of a SymTable_clone that copies the
+ * bindings one at a time */
+struct CloneState {
+    /* The table being built */
+    SymTable_T clone;
+    /* 0 once a put has failed */
+    int ok;
+};
+
+/* Enum containing the kinds of change that an undo record reverses */
+enum UndoKind { UNDO_PUT, UNDO_REPLACE, UNDO_REMOVE };
+
+/* A SymTableUndo object records one change made to a table during a
+ * transaction. The key is stored in the same allocation, right after it. */
+struct SymTableUndo {
+    /* The kind of change */
+    enum UndoKind kind;
+    /* Value of the binding before a replace or remove */
+    void *value;
+    /* The next older record */
+    struct SymTableUndo *next;
+};
+
+/* Every public operation is bracketed by these macros, which record its
+ * latency in builds with SYMTABLE_LATENCY defined and compile to nothing
+ * otherwise. LATENCY_START must be the first statement of its block. */
+#ifdef SYMTABLE_LATENCY
+#define LATENCY_START double dLatencyStart = SymTable_now();
+#define LATENCY_END(oSymTable, eOperation) \
+    SymTable_recordLatency((oSymTable), (eOperation), dLatencyStart)
+#else
+#define LATENCY_START
+#define LATENCY_END(oSymTable, eOperation) ((void)0)
+#endif
+
+#if defined(SYMTABLE_STATS) || defined(SYMTABLE_LATENCY)
+double SymTable_now(void) {
+    struct timespec sTime;
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+#endif
+
+#ifdef SYMTABLE_LATENCY
+/* Add an operation eOperation on oSymTable that started at time dStart to
+ * the latency histograms of oSymTable. The operation goes unrecorded if the
+ * histograms cannot be allocated. */
+static void SymTable_recordLatency(SymTable_T oSymTable,
+                                   enum SymTableOperation eOperation,
+                                   double dStart) {
+    double dElapsed = SymTable_now() - dStart;
+    size_t uBucket = 0;
+    if (oSymTable->latency == NULL) {
+        oSymTable->latency = (size_t(*)[SYMTABLE_LATENCY_BUCKETS])calloc(
+            SYMTABLE_OP_COUNT, sizeof(*oSymTable->latency));
+        if (oSymTable->latency == NULL) return;
+    }
+    while (dElapsed >= 2.0 && uBucket + 1 < SYMTABLE_LATENCY_BUCKETS) {
+        dElapsed /= 2.0;
+        uBucket++;
+    }
+    oSymTable->latency[eOperation][uBucket]++;
+}
+#endif
+
+void SymTable_initHeader(SymTable_T oSymTable,
+                         const struct SymTableBackend *psBackend) {
+    assert(oSymTable != NULL);
+    assert(psBackend != NULL);
+    oSymTable->backend = psBackend;
+#ifdef SYMTABLE_STATS
+    memset(&oSymTable->counters, 0, sizeof(oSymTable->counters));
+#endif
+#ifdef SYMTABLE_LATENCY
+    oSymTable->latency = NULL;
+#endif
+    oSymTable->inTxn = 0;
+    oSymTable->undoLog = NULL;
+}
+
+void SymTable_addChain(struct SymTableStats *psStats, size_t uLength) {
+    size_t uIndex = uLength;
+    assert(psStats != NULL);
+    if (uIndex >= SYMTABLE_CHAIN_HISTOGRAM_SIZE)
+        uIndex = SYMTABLE_CHAIN_HISTOGRAM_SIZE - 1;
+    psStats->chainHistogram[uIndex]++;
+    psStats->numChains++;
+    if (uLength > psStats->maxChainLength) psStats->maxChainLength = uLength;
+}
+
+int SymTable_getStats(SymTable_T oSymTable, struct SymTableStats *psStats) {
+    size_t uNonEmpty;
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+
+    memset(psStats, 0, sizeof(*psStats));
+    psStats->numBindings = oSymTable->backend->pfGetLength(oSymTable);
+    if (oSymTable->backend->pfGetStats != NULL)
+        oSymTable->backend->pfGetStats(oSymTable, psStats);
+    if (psStats->numChains > 0)
+        psStats->loadFactor =
+            (double)psStats->numBindings / (double)psStats->numChains;
+    uNonEmpty = psStats->numChains - psStats->chainHistogram[0];
+    if (uNonEmpty > 0)
+        psStats->meanChainLength =
+            (double)psStats->numBindings / (double)uNonEmpty;
+
+#ifdef SYMTABLE_LATENCY
+    if (oSymTable->latency != NULL)
+        memcpy(psStats->latencyHistogram, oSymTable->latency,
+               sizeof(psStats->latencyHistogram));
+#endif
+#ifdef SYMTABLE_STATS
+    psStats->resizeCount = oSymTable->counters.resizeCount;
+    psStats->resizeNs = oSymTable->counters.resizeNs;
+    psStats->keyComparisons = oSymTable->counters.keyComparisons;
+    psStats->bytesAllocated += oSymTable->counters.bytesAllocated;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* Return the registered backend named pcName, or NULL if there is none. */
+static const struct SymTableBackend *SymTable_findBackend(const char *pcName) {
+    size_t i;
+    for (i = 0; i < uBackendCount; i++)
+        if (strcmp(apsBackends[i]->name, pcName) == 0) return apsBackends[i];
+    return NULL;
+}
+
+int SymTable_registerBackend(const struct SymTableBackend *psBackend) {
+    assert(psBackend != NULL);
+    assert(psBackend->name != NULL);
+    if (uBackendCount == MAX_BACKENDS) return 0;
+    if (SymTable_findBackend(psBackend->name) != NULL) return 0;
+    apsBackends[uBackendCount++] = psBackend;
+    return 1;
+}
+
+size_t SymTable_getBackendCount(void) { return uBackendCount; }
+
+const char *SymTable_getBackendName(size_t uIndex) {
+    assert(uIndex < uBackendCount);
+    return apsBackends[uIndex]->name;
+}
+
+SymTable_T SymTable_new(void) { return SYMTABLE_DEFAULT_BACKEND.pfNew(); }
+
+SymTable_T SymTable_newWithBackend(const char *pcBackend) {
+    const struct SymTableBackend *psBackend;
+    assert(pcBackend != NULL);
+    psBackend = SymTable_findBackend(pcBackend);
+    if (psBackend == NULL) return NULL;
+    return psBackend->pfNew();
+}
+
+/* Put the binding of pcKey and pvValue into the table that *pvExtra, a
+ * struct CloneState, is building. */
+static void SymTable_putClone(const char *pcKey, void *pvValue,
+                              void *pvExtra) {
+    struct CloneState *psState = (struct CloneState *)pvExtra;
+    if (psState->ok && !SymTable_put(psState->clone, pcKey, pvValue))
+        psState->ok = 0;
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    struct CloneState sState;
+    assert(oSymTable != NULL);
+    if (oSymTable->backend->pfClone != NULL)
+        return oSymTable->backend->pfClone(oSymTable);
+
+    sState.clone = oSymTable->backend->pfNew();
+    if (sState.clone == NULL) return NULL;
+    sState.ok = 1;
+    oSymTable->backend->pfMap(oSymTable, SymTable_putClone, &sState);
+    if (!sState.ok) {
+        SymTable_free(sState.clone);
+        return NULL;
+    }
+    return sState.clone;
+}
+
+/* Return the key of psUndo. */
+static const char *SymTable_undoKey(const struct SymTableUndo *psUndo) {
+    return (const char *)(psUndo + 1);
+}
+
+/* Add a record of a change of kind eKind to the binding with key pcKey, whose
+ * value was pvValue, to the undo log of oSymTable. Return 1, or 0 if
+ * insufficient memory is available. */
+static int SymTable_logChange(SymTable_T oSymTable, enum UndoKind eKind,
+                              const char *pcKey, const void *pvValue) {
+    size_t keyLength = strlen(pcKey) + 1;
+    struct SymTableUndo *psUndo =
+        (struct SymTableUndo *)malloc(sizeof(struct SymTableUndo) + keyLength);
+    if (psUndo == NULL) return 0;
+    memcpy((char *)(psUndo + 1), pcKey, keyLength);
+    psUndo->kind = eKind;
+    psUndo->value = (void *)pvValue;
+    psUndo->next = oSymTable->undoLog;
+    oSymTable->undoLog = psUndo;
+    return 1;
+}
+
+/* Discard the most recent record in the undo log of oSymTable, for a change
+ * that did not happen. */
+static void SymTable_dropChange(SymTable_T oSymTable) {
+    struct SymTableUndo *psUndo = oSymTable->undoLog;
+    oSymTable->undoLog = psUndo->next;
+    free(psUndo);
+}
+
+/* Free every record in the undo log of oSymTable. */
+static void SymTable_freeUndoLog(SymTable_T oSymTable) {
+    struct SymTableUndo *psUndo;
+    struct SymTableUndo *psNext;
+    for (psUndo = oSymTable->undoLog; psUndo != NULL; psUndo = psNext) {
+        psNext = psUndo->next;
+        free(psUndo);
+    }
+    oSymTable->undoLog = NULL;
+}
+
+int SymTable_beginTxn(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    if (oSymTable->inTxn || oSymTable->backend == &SymTableCache_backend)
+        return 0;
+    oSymTable->inTxn = 1;
+    return 1;
+}
+
+void SymTable_commit(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->inTxn);
+    SymTable_freeUndoLog(oSymTable);
+    oSymTable->inTxn = 0;
+}
+
+int SymTable_rollback(SymTable_T oSymTable) {
+    const struct SymTableBackend *psBackend;
+    struct SymTableUndo *psUndo;
+    const char *pcKey;
+    int iSuccessful = 1;
+    assert(oSymTable != NULL);
+    assert(oSymTable->inTxn);
+
+    /* Undo the changes directly through the backend, without logging them */
+    psBackend = oSymTable->backend;
+    for (psUndo = oSymTable->undoLog; psUndo != NULL; psUndo = psUndo->next) {
+        pcKey = SymTable_undoKey(psUndo);
+        switch (psUndo->kind) {
+        case UNDO_PUT:
+            psBackend->pfRemove(oSymTable, pcKey);
+            if (psBackend->pfContains(oSymTable, pcKey)) iSuccessful = 0;
+            break;
+        case UNDO_REPLACE:
+            psBackend->pfReplace(oSymTable, pcKey, psUndo->value);
+            if (psBackend->pfGet(oSymTable, pcKey) != psUndo->value)
+                iSuccessful = 0;
+            break;
+        case UNDO_REMOVE:
+            if (!psBackend->pfPut(oSymTable, pcKey, psUndo->value))
+                iSuccessful = 0;
+            break;
+        }
+    }
+    SymTable_freeUndoLog(oSymTable);
+    oSymTable->inTxn = 0;
+    return iSuccessful;
+}
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount) {
+    assert(oSymTable != NULL);
+    if (oSymTable->backend->pfReserve == NULL) return 1;
+    return oSymTable->backend->pfReserve(oSymTable, uCount);
+}
+
+const char *SymTable_getBackend(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->backend->name;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+#ifdef SYMTABLE_LATENCY
+    free(oSymTable->latency);
+#endif
+    SymTable_freeUndoLog(oSymTable);
+    oSymTable->backend->pfFree(oSymTable);
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->backend->pfGetLength(oSymTable);
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    LATENCY_START
+    int iResult;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!oSymTable->inTxn)
+        iResult = oSymTable->backend->pfPut(oSymTable, pcKey, pvValue);
+    else if (!SymTable_logChange(oSymTable, UNDO_PUT, pcKey, NULL))
+        iResult = 0;
+    else {
+        iResult = oSymTable->backend->pfPut(oSymTable, pcKey, pvValue);
+        if (!iResult) SymTable_dropChange(oSymTable);
+    }
+    LATENCY_END(oSymTable, SYMTABLE_OP_PUT);
+    return iResult;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue) {
+    LATENCY_START
+    void *pvResult;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!oSymTable->inTxn)
+        pvResult = oSymTable->backend->pfReplace(oSymTable, pcKey, pvValue);
+    else if (!SymTable_logChange(oSymTable, UNDO_REPLACE, pcKey, NULL))
+        pvResult = NULL;
+    else {
+        /* The old value is known only once it has been replaced */
+        pvResult = oSymTable->backend->pfReplace(oSymTable, pcKey, pvValue);
+        oSymTable->undoLog->value = pvResult;
+        if (pvResult == NULL &&
+            (!oSymTable->backend->pfContains(oSymTable, pcKey) ||
+             oSymTable->backend->pfGet(oSymTable, pcKey) != pvValue))
+            SymTable_dropChange(oSymTable);
+    }
+    LATENCY_END(oSymTable, SYMTABLE_OP_REPLACE);
+    return pvResult;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    LATENCY_START
+    int iResult;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    iResult = oSymTable->backend->pfContains(oSymTable, pcKey);
+    LATENCY_END(oSymTable, SYMTABLE_OP_CONTAINS);
+    return iResult;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    LATENCY_START
+    void *pvResult;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    pvResult = oSymTable->backend->pfGet(oSymTable, pcKey);
+    LATENCY_END(oSymTable, SYMTABLE_OP_GET);
+    return pvResult;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    LATENCY_START
+    void *pvResult;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    /* Only a live binding is logged: a backend may also purge a binding
+     * that is invisible, such as an expired one, which must stay gone */
+    if (!oSymTable->inTxn || !oSymTable->backend->pfContains(oSymTable, pcKey))
+        pvResult = oSymTable->backend->pfRemove(oSymTable, pcKey);
+    else if (!SymTable_logChange(oSymTable, UNDO_REMOVE, pcKey, NULL))
+        pvResult = NULL;
+    else {
+        pvResult = oSymTable->backend->pfRemove(oSymTable, pcKey);
+        oSymTable->undoLog->value = pvResult;
+    }
+    LATENCY_END(oSymTable, SYMTABLE_OP_REMOVE);
+    return pvResult;
+}
+
+/* A MergeState object holds copies of the bindings of the source table of a
+ * SymTable_merge that moves the bindings one at a time */
+struct MergeState {
+    /* Keys of the bindings, pointing into one allocation */
+    char **keys;
+    /* Values of the bindings */
+    void **values;
+    /* Number of bindings copied */
+    size_t count;
+    /* Number of bindings keys and values have room for */
+    size_t capacity;
+    /* Bytes of the keys, including their terminating '\0's */
+    size_t keyBytes;
+    /* Where the next key is copied */
+    char *next;
+};
+
+/* Add the size of pcKey to the keyBytes of *pvExtra, a struct MergeState,
+ * ignoring pvValue. */
+static void SymTable_measureKey(const char *pcKey, void *pvValue,
+                                void *pvExtra) {
+    struct MergeState *psState = (struct MergeState *)pvExtra;
+    (void)pvValue;
+    psState->keyBytes += strlen(pcKey) + 1;
+}
+
+/* Append a copy of the binding of pcKey and pvValue to *pvExtra, a struct
+ * MergeState, if it has room. */
+static void SymTable_copyBinding(const char *pcKey, void *pvValue,
+                                 void *pvExtra) {
+    struct MergeState *psState = (struct MergeState *)pvExtra;
+    size_t keyLength = strlen(pcKey) + 1;
+    if (psState->count == psState->capacity || keyLength > psState->keyBytes)
+        return;
+    memcpy(psState->next, pcKey, keyLength);
+    psState->keys[psState->count] = psState->next;
+    psState->values[psState->count] = pvValue;
+    psState->count++;
+    psState->next += keyLength;
+    psState->keyBytes -= keyLength;
+}
+
+int SymTable_merge(SymTable_T oDst, SymTable_T oSrc,
+                   enum SymTableConflict eConflict) {
+    struct MergeState sState;
+    char *pcKeys;
+    int iSuccessful = 1;
+    size_t i;
+    assert(oDst != NULL);
+    assert(oSrc != NULL);
+    assert(oDst != oSrc);
+
+    if (oDst->backend->pfMerge != NULL &&
+        oDst->backend->pfMerge == oSrc->backend->pfMerge && !oDst->inTxn &&
+        !oSrc->inTxn)
+        return oDst->backend->pfMerge(oDst, oSrc,
+                                      eConflict == SYMTABLE_KEEP_SRC);
+
+    /* Copy the bindings of oSrc first, since it cannot change while it is
+     * being mapped, and its own keys must not be passed to its remove */
+    sState.capacity = SymTable_getLength(oSrc);
+    if (sState.capacity == 0) return 1;
+    sState.keyBytes = 0;
+    oSrc->backend->pfMap(oSrc, SymTable_measureKey, &sState);
+    sState.keys = (char **)malloc(sState.capacity * sizeof(char *));
+    sState.values = (void **)malloc(sState.capacity * sizeof(void *));
+    pcKeys = (char *)malloc(sState.keyBytes);
+    if (sState.keys == NULL || sState.values == NULL || pcKeys == NULL) {
+        free(sState.keys);
+        free(sState.values);
+        free(pcKeys);
+        return 0;
+    }
+    sState.count = 0;
+    sState.next = pcKeys;
+    oSrc->backend->pfMap(oSrc, SymTable_copyBinding, &sState);
+
+    SymTable_reserve(oDst, SymTable_getLength(oDst) + sState.count);
+    for (i = 0; i < sState.count; i++) {
+        const char *pcKey = sState.keys[i];
+        if (SymTable_contains(oDst, pcKey)) {
+            if (eConflict == SYMTABLE_KEEP_SRC)
+                SymTable_replace(
+                    oSrc, pcKey,
+                    SymTable_replace(oDst, pcKey, sState.values[i]));
+        } else if (SymTable_put(oDst, pcKey, sState.values[i])) {
+            SymTable_remove(oSrc, pcKey);
+        } else {
+            iSuccessful = 0;
+        }
+    }
+    free(sState.keys);
+    free(sState.values);
+    free(pcKeys);
+    return iSuccessful;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra) {
+    LATENCY_START
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    oSymTable->backend->pfMap(oSymTable, pfApply, pvExtra);
+    LATENCY_END(oSymTable, SYMTABLE_OP_MAP);
+}
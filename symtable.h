@@ -18,6 +18,37 @@ typedef struct SymTable *SymTable_T;
  * insufficient memory is available.*/
 SymTable_T SymTable_new(void);
 
+/* Return a new SymTable object that contains no bindings and is implemented
+ * by the backend registered under the name pcBackend (such as "list",
+ * "hash", "hybrid", "hamt", or "compact"), or NULL if there is no such
+ * backend or insufficient memory is available. SymTable_map visits the
+ * bindings of a "compact" table in the order they were put, so its output
+ * is the same from run to run. */
+SymTable_T SymTable_newWithBackend(const char *pcBackend);
+
+/* Returns the name of the backend that implements oSymTable. */
+const char *SymTable_getBackend(SymTable_T oSymTable);
+
+/* Returns the number of registered backends. */
+size_t SymTable_getBackendCount(void);
+
+/* Returns the name of the uIndex-th registered backend, where uIndex is less
+ * than SymTable_getBackendCount(). */
+const char *SymTable_getBackendName(size_t uIndex);
+
+/* Return a new SymTable object with the same backend and bindings as
+ * oSymTable, or NULL if insufficient memory is available. The two tables are
+ * independent afterwards. A "hamt" table is cloned in constant time and
+ * shares its structure with the clone until either changes; other backends
+ * copy every binding. */
+SymTable_T SymTable_clone(SymTable_T oSymTable);
+
+/* Prepares oSymTable to hold uCount bindings without resizing, so that
+ * loading a known number of bindings does not rehash them along the way.
+ * Returns 1, or 0 if insufficient memory is available; oSymTable is usable
+ * either way. Backends that never resize ignore the request. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount);
+
 /* Frees all memory occupied by oSymTable. */
 void SymTable_free(SymTable_T oSymTable);
 
@@ -47,6 +78,45 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
  * oSymTable contains the binding, otherwise returns NULL */
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/* How SymTable_merge resolves a key that both tables bind */
+enum SymTableConflict {
+    /* The key keeps its value in oDst, and its binding stays in oSrc */
+    SYMTABLE_KEEP_DST,
+    /* The key takes its value from oSrc, and its value from oDst is left
+     * bound to it in oSrc */
+    SYMTABLE_KEEP_SRC
+};
+
+/* Moves every binding of oSrc whose key oDst does not contain into oDst,
+ * and resolves every key that both contain as eConflict says, so that
+ * afterwards oSrc holds only the losing bindings of conflicting keys and
+ * no value has been lost. Tables of the hash backends move their bindings
+ * without copying keys and, unless either is keyed, without rehashing them;
+ * other tables put and remove each binding. Returns 1, or 0 if
+ * insufficient memory was available to move every binding, in which case
+ * the bindings not moved are still in oSrc. */
+int SymTable_merge(SymTable_T oDst, SymTable_T oSrc,
+                   enum SymTableConflict eConflict);
+
+/* Begins a transaction on oSymTable and returns 1, or returns 0 if a
+ * transaction on oSymTable is already open or oSymTable is a cache table
+ * (symtablecache.h), whose puts may evict bindings that a rollback could
+ * not restore. Until the transaction ends, each change made by
+ * SymTable_put, SymTable_replace, or SymTable_remove is recorded so that it
+ * can be undone; those functions fail as they do when insufficient memory
+ * is available if the record cannot be allocated. Changes made through
+ * backend-specific functions are not recorded, so a binding of a TTL table
+ * (symtablettl.h) that a rollback puts back never expires. */
+int SymTable_beginTxn(SymTable_T oSymTable);
+
+/* Ends the open transaction on oSymTable, keeping its changes. */
+void SymTable_commit(SymTable_T oSymTable);
+
+/* Ends the open transaction on oSymTable and undoes its changes, most recent
+ * first, in time proportional to their number. Returns 1, or 0 if
+ * insufficient memory was available to undo every change. */
+int SymTable_rollback(SymTable_T oSymTable);
+
 /* Applies function *pfApply to each binding in oSymTable, using pcKey, pcValue,
  * and pvExtra as arguments to *pfApply */
 void SymTable_map(SymTable_T oSymTable,
@@ -0,0 +1,156 @@
+/*--------------------------------------------------------------------*/
+/* symtablebackend.h                                                  */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEBACKEND_H
+#define SYMTABLEBACKEND_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "symtable.h"
+#include "symtablestats.h"
+
+/* A SymTableBackend object is the function table of one SymTable
+ * implementation. Each function has the semantics of the symtable.h
+ * function of the same name, and receives only SymTable objects created by
+ * the backend's own pfNew. */
+struct SymTableBackend {
+    /* Name under which the backend is registered */
+    const char *name;
+    SymTable_T (*pfNew)(void);
+    void (*pfFree)(SymTable_T oSymTable);
+    size_t (*pfGetLength)(SymTable_T oSymTable);
+    int (*pfPut)(SymTable_T oSymTable, const char *pcKey, const void *pvValue);
+    void *(*pfReplace)(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue);
+    int (*pfContains)(SymTable_T oSymTable, const char *pcKey);
+    void *(*pfGet)(SymTable_T oSymTable, const char *pcKey);
+    void *(*pfRemove)(SymTable_T oSymTable, const char *pcKey);
+    void (*pfMap)(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra);
+    /* Reports every chain of oSymTable to SymTable_addChain, and may add
+     * to psStats->bytesAllocated bytes that the counters do not track */
+    void (*pfGetStats)(SymTable_T oSymTable, struct SymTableStats *psStats);
+    /* Returns a copy of oSymTable, or NULL if insufficient memory is
+     * available. May be NULL, in which case SymTable_clone puts every
+     * binding into a new table of the backend. */
+    SymTable_T (*pfClone)(SymTable_T oSymTable);
+    /* Prepares oSymTable to hold uCount bindings without resizing, and
+     * returns 1, or 0 if insufficient memory is available. May be NULL for
+     * a backend that never resizes. */
+    int (*pfReserve)(SymTable_T oSymTable, size_t uCount);
+    /* Moves the bindings of oSrc into oDst as SymTable_merge does, where
+     * iKeepSrc is nonzero for SYMTABLE_KEEP_SRC, and returns 1, or 0 if
+     * insufficient memory was available to move every binding. Called only
+     * outside transactions, for two tables whose backends share pfMerge.
+     * May be NULL, in which case SymTable_merge moves the bindings through
+     * the other functions. */
+    int (*pfMerge)(SymTable_T oDst, SymTable_T oSrc, int iKeepSrc);
+};
+
+#ifdef SYMTABLE_STATS
+/* A SymTableCounters object accumulates the work done by one table. The
+ * fields have the meaning of the SymTableStats fields of the same name. */
+struct SymTableCounters {
+    size_t resizeCount;
+    double resizeNs;
+    size_t keyComparisons;
+    size_t bytesAllocated;
+};
+#endif
+
+/* A SymTable object is the common header of every backend's table: a
+ * backend defines its own table structure whose first member is a struct
+ * SymTable, initializes it with SymTable_initHeader, and returns a pointer
+ * to that member from pfNew. All objects must be built with the same
+ * SYMTABLE_STATS and SYMTABLE_LATENCY settings. */
+struct SymTable {
+    /* The backend that implements this table */
+    const struct SymTableBackend *backend;
+#ifdef SYMTABLE_STATS
+    /* Work done by the table */
+    struct SymTableCounters counters;
+#endif
+#ifdef SYMTABLE_LATENCY
+    /* Latency histograms, allocated by the first timed operation */
+    size_t (*latency)[SYMTABLE_LATENCY_BUCKETS];
+#endif
+    /* 1 between SymTable_beginTxn and SymTable_commit or SymTable_rollback */
+    int inTxn;
+    /* Undo records of the open transaction, the most recent first */
+    struct SymTableUndo *undoLog;
+};
+
+/* Initializes the header of a new table oSymTable of backend *psBackend. */
+void SymTable_initHeader(SymTable_T oSymTable,
+                         const struct SymTableBackend *psBackend);
+
+/* Records a chain of uLength bindings in *psStats. */
+void SymTable_addChain(struct SymTableStats *psStats, size_t uLength);
+
+#if defined(SYMTABLE_STATS) || defined(SYMTABLE_LATENCY)
+/* Returns the current value of the monotonic clock in nanoseconds. */
+double SymTable_now(void);
+#endif
+
+/* Backends update their counters through these macros, which compile to
+ * nothing (or to a plain strcmp) unless SYMTABLE_STATS is defined. */
+#ifdef SYMTABLE_STATS
+#define SYMTABLE_STATS_ADD(oBase, field, n) ((oBase)->counters.field += (n))
+#define SYMTABLE_STATS_SUB(oBase, field, n) ((oBase)->counters.field -= (n))
+#define SYMTABLE_STRCMP(oBase, pcKey1, pcKey2) \
+    ((oBase)->counters.keyComparisons++, strcmp((pcKey1), (pcKey2)))
+#else
+#define SYMTABLE_STATS_ADD(oBase, field, n) ((void)0)
+#define SYMTABLE_STATS_SUB(oBase, field, n) ((void)0)
+#define SYMTABLE_STRCMP(oBase, pcKey1, pcKey2) \
+    ((void)(oBase), strcmp((pcKey1), (pcKey2)))
+#endif
+
+/* Returns a 64-bit value that depends on every bit of uValue (the
+ * splitmix64 finalizer). */
+static inline uint64_t SymTable_mix(uint64_t uValue) {
+    uValue = (uValue ^ (uValue >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    uValue = (uValue ^ (uValue >> 27)) * 0x94d049bb133111ebULL;
+    return uValue ^ (uValue >> 31);
+}
+
+/* Returns the hash code that tables which pick a bucket, slot, or shard
+ * from any bits of it use for pcKey: the 65599 polynomial of the hash
+ * backend, passed through SymTable_mix. It depends on nothing but the key,
+ * so it is the same in every table and every process. */
+static inline uint64_t SymTable_mixedHash(const char *pcKey) {
+    const uint64_t HASH_MULTIPLIER = 65599;
+    uint64_t uHash = 0;
+    size_t u;
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (uint64_t)pcKey[u];
+    return SymTable_mix(uHash);
+}
+
+/* The backends that are always registered */
+extern const struct SymTableBackend SymTableList_backend;
+extern const struct SymTableBackend SymTableHash_backend;
+extern const struct SymTableBackend SymTableHybrid_backend;
+extern const struct SymTableBackend SymTableHashKeyed_backend;
+extern const struct SymTableBackend SymTableHashFiltered_backend;
+extern const struct SymTableBackend SymTableHamt_backend;
+extern const struct SymTableBackend SymTableCompact_backend;
+/* The backends of SymTableDurable_open, SymTableCache_new, SymTableTtl_new,
+ * and SymTableShm_create, which are not registered */
+extern const struct SymTableBackend SymTableDurable_backend;
+extern const struct SymTableBackend SymTableCache_backend;
+extern const struct SymTableBackend SymTableTtl_backend;
+extern const struct SymTableBackend SymTableShm_backend;
+
+/* Registers *psBackend so that SymTable_newWithBackend can find it by name.
+ * Returns 1 on success, or 0 if a backend with the same name is already
+ * registered or the registry is full. Backends must be registered before
+ * tables are created on other threads. */
+int SymTable_registerBackend(const struct SymTableBackend *psBackend);
+
+#endif
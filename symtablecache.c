@@ -0,0 +1,327 @@
+/*--------------------------------------------------------------------*/
+/* symtablecache.c                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symtablebackend.h"
+#include "symtablecache.h"
+
+/* shortened form for struct CacheEntry */
+typedef struct CacheEntry CacheEntry;
+
+/* A CacheEntry object is a binding of a cache, linked into the list of
+ * bindings in order of use. The key is stored in the same allocation, right
+ * after it. */
+struct CacheEntry {
+    /* The binding used next after this one, or NULL if it is the newest */
+    struct CacheEntry *newer;
+    /* The binding used last before this one, or NULL if it is the oldest */
+    struct CacheEntry *older;
+    /* Value associated with the key */
+    void *value;
+    /* Bytes the binding counts against the byte limit */
+    size_t bytes;
+};
+
+/* A SymTableCache object is a table that maps each key to its CacheEntry,
+ * the list of entries in order of use, and the limits that decide when the
+ * oldest entry is evicted. */
+struct SymTableCache {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* The table that maps each key to its CacheEntry */
+    SymTable_T table;
+    /* The most recently used entry, or NULL if there is none */
+    struct CacheEntry *newest;
+    /* The least recently used entry, or NULL if there is none */
+    struct CacheEntry *oldest;
+    /* Maximum number of bindings, or 0 for no limit */
+    size_t maxBindings;
+    /* Maximum number of bytes, or 0 for no limit */
+    size_t maxBytes;
+    /* Bytes counted against maxBytes */
+    size_t bytes;
+    /* Function called with each evicted binding, or NULL */
+    void (*evict)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* Last argument of evict */
+    void *extra;
+    /* What has happened to the cache */
+    struct SymTableCacheCounts counts;
+};
+
+/* shortened form for a pointer to struct SymTableCache */
+typedef struct SymTableCache *SymTableCache_T;
+
+/* Return the key of psEntry. */
+static const char *SymTable_entryKey(const CacheEntry *psEntry) {
+    return (const char *)(psEntry + 1);
+}
+
+/* Remove psEntry from the list of oSymTable. */
+static void SymTable_unlink(SymTableCache_T oSymTable, CacheEntry *psEntry) {
+    if (psEntry->newer != NULL)
+        psEntry->newer->older = psEntry->older;
+    else
+        oSymTable->newest = psEntry->older;
+    if (psEntry->older != NULL)
+        psEntry->older->newer = psEntry->newer;
+    else
+        oSymTable->oldest = psEntry->newer;
+}
+
+/* Add psEntry to the list of oSymTable as its newest entry. */
+static void SymTable_pushNewest(SymTableCache_T oSymTable,
+                                CacheEntry *psEntry) {
+    psEntry->newer = NULL;
+    psEntry->older = oSymTable->newest;
+    if (oSymTable->newest != NULL)
+        oSymTable->newest->newer = psEntry;
+    else
+        oSymTable->oldest = psEntry;
+    oSymTable->newest = psEntry;
+}
+
+/* Evict the oldest entries of oSymTable until it respects its limits or
+ * only its newest entry is left. */
+static void SymTable_evict(SymTableCache_T oSymTable) {
+    while (oSymTable->oldest != oSymTable->newest &&
+           ((oSymTable->maxBindings != 0 &&
+             SymTable_getLength(oSymTable->table) > oSymTable->maxBindings) ||
+            (oSymTable->maxBytes != 0 &&
+             oSymTable->bytes > oSymTable->maxBytes))) {
+        CacheEntry *psEntry = oSymTable->oldest;
+        SymTable_unlink(oSymTable, psEntry);
+        SymTable_remove(oSymTable->table, SymTable_entryKey(psEntry));
+        oSymTable->bytes -= psEntry->bytes;
+        oSymTable->counts.evictions++;
+        if (oSymTable->evict != NULL)
+            (*oSymTable->evict)(SymTable_entryKey(psEntry), psEntry->value,
+                                oSymTable->extra);
+        free(psEntry);
+    }
+}
+
+/* Return a new cache that contains no bindings and keeps them in oTable,
+ * which is empty, with the limits and callback of SymTableCache_new, or
+ * NULL if insufficient memory is available. oTable is freed either way. */
+static SymTable_T SymTable_newCache(SymTable_T oTable, size_t uMaxBindings,
+                                    size_t uMaxBytes,
+                                    void (*pfEvict)(const char *pcKey,
+                                                    void *pvValue,
+                                                    void *pvExtra),
+                                    const void *pvExtra) {
+    SymTableCache_T symtable =
+        (SymTableCache_T)malloc(sizeof(struct SymTableCache));
+    if (symtable == NULL) {
+        SymTable_free(oTable);
+        return NULL;
+    }
+    SymTable_initHeader(&symtable->base, &SymTableCache_backend);
+    symtable->table = oTable;
+    symtable->newest = NULL;
+    symtable->oldest = NULL;
+    symtable->maxBindings = uMaxBindings;
+    symtable->maxBytes = uMaxBytes;
+    symtable->bytes = 0;
+    symtable->evict = pfEvict;
+    symtable->extra = (void *)pvExtra;
+    memset(&symtable->counts, 0, sizeof(symtable->counts));
+    return &symtable->base;
+}
+
+SymTable_T SymTableCache_new(const char *pcBackend, size_t uMaxBindings,
+                             size_t uMaxBytes,
+                             void (*pfEvict)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra) {
+    SymTable_T oTable;
+    assert(pcBackend != NULL);
+    oTable = SymTable_newWithBackend(pcBackend);
+    if (oTable == NULL) return NULL;
+    return SymTable_newCache(oTable, uMaxBindings, uMaxBytes, pfEvict,
+                             pvExtra);
+}
+
+void SymTableCache_getCounts(SymTable_T oBase,
+                             struct SymTableCacheCounts *psCounts) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableCache_backend);
+    assert(psCounts != NULL);
+    *psCounts = oSymTable->counts;
+}
+
+/* Caches are created only by SymTableCache_new, so return NULL. */
+static SymTable_T SymTableCache_newDefault(void) { return NULL; }
+
+static void SymTableCache_free(SymTable_T oBase) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    CacheEntry *psOlder;
+    assert(oSymTable != NULL);
+    for (psEntry = oSymTable->newest; psEntry != NULL; psEntry = psOlder) {
+        psOlder = psEntry->older;
+        free(psEntry);
+    }
+    SymTable_free(oSymTable->table);
+    free(oSymTable);
+}
+
+static size_t SymTableCache_getLength(SymTable_T oBase) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_getLength(oSymTable->table);
+}
+
+static int SymTableCache_put(SymTable_T oBase, const char *pcKey,
+                             const void *pvValue) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    size_t keyLength;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    keyLength = strlen(pcKey) + 1;
+    psEntry = (CacheEntry *)malloc(sizeof(CacheEntry) + keyLength);
+    if (psEntry == NULL) return 0;
+    memcpy((char *)(psEntry + 1), pcKey, keyLength);
+    psEntry->value = (void *)pvValue;
+    psEntry->bytes = sizeof(CacheEntry) + keyLength;
+    if (!SymTable_put(oSymTable->table, pcKey, psEntry)) {
+        free(psEntry);
+        return 0;
+    }
+    SymTable_pushNewest(oSymTable, psEntry);
+    oSymTable->bytes += psEntry->bytes;
+    SymTable_evict(oSymTable);
+    return 1;
+}
+
+static void *SymTableCache_replace(SymTable_T oBase, const char *pcKey,
+                                   const void *pvValue) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    void *oldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = (CacheEntry *)SymTable_get(oSymTable->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    oldValue = psEntry->value;
+    psEntry->value = (void *)pvValue;
+    SymTable_unlink(oSymTable, psEntry);
+    SymTable_pushNewest(oSymTable, psEntry);
+    return oldValue;
+}
+
+static int SymTableCache_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_contains(oSymTable->table, pcKey);
+}
+
+static void *SymTableCache_get(SymTable_T oBase, const char *pcKey) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = (CacheEntry *)SymTable_get(oSymTable->table, pcKey);
+    if (psEntry == NULL) {
+        oSymTable->counts.misses++;
+        return NULL;
+    }
+    oSymTable->counts.hits++;
+    SymTable_unlink(oSymTable, psEntry);
+    SymTable_pushNewest(oSymTable, psEntry);
+    return psEntry->value;
+}
+
+static void *SymTableCache_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    void *value;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = (CacheEntry *)SymTable_remove(oSymTable->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    SymTable_unlink(oSymTable, psEntry);
+    oSymTable->bytes -= psEntry->bytes;
+    value = psEntry->value;
+    free(psEntry);
+    return value;
+}
+
+static void SymTableCache_map(SymTable_T oBase,
+                              void (*pfApply)(const char *pcKey, void *pvValue,
+                                              void *pvExtra),
+                              const void *pvExtra) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    CacheEntry *psEntry;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    for (psEntry = oSymTable->newest; psEntry != NULL; psEntry = psEntry->older)
+        (*pfApply)(SymTable_entryKey(psEntry), psEntry->value,
+                   (void *)pvExtra);
+}
+
+static void SymTableCache_getStats(SymTable_T oBase,
+                                   struct SymTableStats *psStats) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    assert(oSymTable != NULL);
+    if (oSymTable->table->backend->pfGetStats != NULL)
+        oSymTable->table->backend->pfGetStats(oSymTable->table, psStats);
+#ifdef SYMTABLE_STATS
+    psStats->bytesAllocated += oSymTable->bytes;
+#endif
+}
+
+static SymTable_T SymTableCache_clone(SymTable_T oBase) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    SymTable_T oTable, oClone;
+    CacheEntry *psEntry;
+    assert(oSymTable != NULL);
+
+    oTable = oSymTable->table->backend->pfNew();
+    if (oTable == NULL) return NULL;
+    oClone = SymTable_newCache(oTable, oSymTable->maxBindings,
+                               oSymTable->maxBytes, oSymTable->evict,
+                               oSymTable->extra);
+    if (oClone == NULL) return NULL;
+    /* Putting the oldest first reproduces the order of use */
+    for (psEntry = oSymTable->oldest; psEntry != NULL; psEntry = psEntry->newer)
+        if (!SymTableCache_put(oClone, SymTable_entryKey(psEntry),
+                               psEntry->value)) {
+            SymTableCache_free(oClone);
+            return NULL;
+        }
+    return oClone;
+}
+
+static int SymTableCache_reserve(SymTable_T oBase, size_t uCount) {
+    SymTableCache_T oSymTable = (SymTableCache_T)oBase;
+    assert(oSymTable != NULL);
+    if (oSymTable->maxBindings != 0 && uCount > oSymTable->maxBindings)
+        uCount = oSymTable->maxBindings;
+    return SymTable_reserve(oSymTable->table, uCount);
+}
+
+/* The function table of caches, which is not registered because they need
+ * limits to be created */
+const struct SymTableBackend SymTableCache_backend = {
+    "cache",
+    SymTableCache_newDefault,
+    SymTableCache_free,
+    SymTableCache_getLength,
+    SymTableCache_put,
+    SymTableCache_replace,
+    SymTableCache_contains,
+    SymTableCache_get,
+    SymTableCache_remove,
+    SymTableCache_map,
+    SymTableCache_getStats,
+    SymTableCache_clone,
+    SymTableCache_reserve,
+    NULL};
@@ -0,0 +1,51 @@
+/*--------------------------------------------------------------------*/
+/* symtablecache.h                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLECACHE_H
+#define SYMTABLECACHE_H
+
+#include <stddef.h>
+
+#include "symtable.h"
+
+/* A cache SymTable object holds a bounded number of bindings. When
+ * SymTable_put would take it past its limits, it evicts the least recently
+ * used bindings, in constant time each, and passes each one to its eviction
+ * callback. SymTable_get and SymTable_replace count as uses of a binding;
+ * SymTable_contains does not. SymTable_map visits the bindings from the
+ * most to the least recently used, and SymTable_clone copies the limits,
+ * the callback, and the order of use. SymTable_beginTxn fails on a cache,
+ * since a rollback could not restore the bindings it evicted. */
+
+/* A SymTableCacheCounts object counts what has happened to a cache. */
+struct SymTableCacheCounts {
+    /* Calls of SymTable_get that found a binding */
+    size_t hits;
+    /* Calls of SymTable_get that found none */
+    size_t misses;
+    /* Bindings evicted to respect the limits */
+    size_t evictions;
+};
+
+/* Return a new cache SymTable object that contains no bindings and keeps
+ * them in a table of the backend registered under the name pcBackend, or
+ * NULL if there is no such backend or insufficient memory is available.
+ * The cache holds at most uMaxBindings bindings, and its bindings occupy
+ * at most uMaxBytes bytes, counting each as its key, its '\0', and the
+ * cache's own bookkeeping; either limit may be 0 for none, and the binding
+ * just put is never evicted. pfEvict, which may be NULL, is called with
+ * the key and value of each evicted binding and with pvExtra. */
+SymTable_T SymTableCache_new(const char *pcBackend, size_t uMaxBindings,
+                             size_t uMaxBytes,
+                             void (*pfEvict)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra);
+
+/* Store the counts of cache oSymTable in *psCounts. oSymTable must be a
+ * cache SymTable. */
+void SymTableCache_getCounts(SymTable_T oSymTable,
+                             struct SymTableCacheCounts *psCounts);
+
+#endif
@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------*/
+/* symtablecat.c                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "symtable.h"
+#include "symtabletext.h"
+
+/* Import the text file of bindings argv[argc-2], or argv[argc-1] if there
+ * is no output file, into a table of the backend named by the -b option
+ * ("hybrid" if there is none), and export the table to the output file
+ * argv[argc-1], if present. Report the time each step takes to stderr.
+ * Return 0, or EXIT_FAILURE if the arguments are invalid or a step fails. */
+int main(int argc, char *argv[]) {
+    const char *pcBackend = "hybrid";
+    const char *pcInput, *pcOutput = NULL;
+    SymTable_T oSymTable;
+    SymTableText_T oText;
+    double dStart;
+    int iArg = 1;
+
+    if (argc > 2 && strcmp(argv[1], "-b") == 0) {
+        pcBackend = argv[2];
+        iArg = 3;
+    }
+    if (argc - iArg < 1 || argc - iArg > 2) {
+        fprintf(stderr, "Usage: %s [-b backend] infile [outfile]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    pcInput = argv[iArg];
+    if (argc - iArg == 2) pcOutput = argv[iArg + 1];
+
+    dStart = Bench_now();
+    oSymTable = SymTableText_import(pcInput, pcBackend, &oText);
+    if (oSymTable == NULL) {
+        fprintf(stderr, "%s: cannot import %s into a %s table\n", argv[0],
+                pcInput, pcBackend);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(stderr, "imported %lu bindings in %.3f s\n",
+            (unsigned long)SymTable_getLength(oSymTable),
+            (Bench_now() - dStart) / 1e9);
+
+    if (pcOutput != NULL) {
+        dStart = Bench_now();
+        if (!SymTableText_export(oSymTable, pcOutput)) {
+            fprintf(stderr, "%s: cannot export to %s\n", argv[0], pcOutput);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "exported in %.3f s\n", (Bench_now() - dStart) / 1e9);
+    }
+
+    SymTable_free(oSymTable);
+    SymTableText_free(oText);
+    return 0;
+}
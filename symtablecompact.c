@@ -0,0 +1,403 @@
+/*--------------------------------------------------------------------*/
+/* symtablecompact.c                                                  */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symtablebackend.h"
+
+/* Enum containing the number of entries a new table has room for */
+enum { ENTRY_CAPACITY = 8 };
+
+/* shortened form for struct Entry */
+typedef struct Entry Entry;
+
+/* An Entry object is a binding in the dense entries array of a table. */
+struct Entry {
+    /* Key for the binding, or NULL once the binding has been removed */
+    const char *key;
+    /* Value associated with the key */
+    void *value;
+    /* Hash of the key, so that resizing never rehashes keys and most
+     * mismatches are rejected without a strcmp */
+    size_t hash;
+};
+
+/* A SymTableCompact object keeps its bindings in an array of entries in
+ * the order they were put, and finds them through a separate index: an
+ * open-addressing array of slots, each 0 if empty or one more than the
+ * position of an entry. A slot is 1, 2, 4, or 8 bytes wide, the narrowest
+ * width that can hold every position the entries array has room for, so
+ * that the index of a small table is a fraction of the size of an array of
+ * bucket pointers. Removing a binding leaves a hole in the entries array,
+ * and its slot still points there so that probe sequences stay intact;
+ * both are reclaimed the next time the entries array fills up. */
+struct SymTableCompact {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* Array of entries, in the order their bindings were put */
+    struct Entry *entries;
+    /* Number of entries in use, including the holes left by removals */
+    size_t numEntries;
+    /* Number of entries the array has room for */
+    size_t capacity;
+    /* Number of bindings in symbol table */
+    size_t numBindings;
+    /* Array of slots, probed linearly */
+    void *index;
+    /* Number of slots, a power of two above capacity * 3 / 2 */
+    size_t indexSize;
+    /* Width of a slot in bytes */
+    size_t slotWidth;
+};
+
+/* shortened form for a pointer to struct SymTableCompact */
+typedef struct SymTableCompact *SymTableCompact_T;
+
+/* Return the width in bytes of the slots of an index for an entries array
+ * with room for uCapacity entries. */
+static size_t SymTable_slotWidth(size_t uCapacity) {
+    if (uCapacity < UINT8_MAX) return 1;
+    if (uCapacity < UINT16_MAX) return 2;
+    if (uCapacity < UINT32_MAX) return 4;
+    return 8;
+}
+
+/* Return the number of slots of an index for an entries array with room
+ * for uCapacity entries, so that the index is at most two thirds full. */
+static size_t SymTable_indexSize(size_t uCapacity) {
+    size_t uSize = 1;
+    while (uSize < uCapacity + uCapacity / 2 + 1) uSize *= 2;
+    return uSize;
+}
+
+/* Return slot uSlot of the index of oSymTable. */
+static size_t SymTable_getSlot(SymTableCompact_T oSymTable, size_t uSlot) {
+    switch (oSymTable->slotWidth) {
+        case 1:
+            return ((const uint8_t *)oSymTable->index)[uSlot];
+        case 2:
+            return ((const uint16_t *)oSymTable->index)[uSlot];
+        case 4:
+            return ((const uint32_t *)oSymTable->index)[uSlot];
+        default:
+            return (size_t)((const uint64_t *)oSymTable->index)[uSlot];
+    }
+}
+
+/* Set slot uSlot of the index of oSymTable to uValue. */
+static void SymTable_setSlot(SymTableCompact_T oSymTable, size_t uSlot,
+                             size_t uValue) {
+    switch (oSymTable->slotWidth) {
+        case 1:
+            ((uint8_t *)oSymTable->index)[uSlot] = (uint8_t)uValue;
+            break;
+        case 2:
+            ((uint16_t *)oSymTable->index)[uSlot] = (uint16_t)uValue;
+            break;
+        case 4:
+            ((uint32_t *)oSymTable->index)[uSlot] = (uint32_t)uValue;
+            break;
+        default:
+            ((uint64_t *)oSymTable->index)[uSlot] = (uint64_t)uValue;
+            break;
+    }
+}
+
+/* Return the slot of oSymTable that points to the entry whose key is pcKey
+ * and whose hash is hash, or the empty slot that ends its probe sequence if
+ * there is no such entry. */
+static size_t SymTable_findSlot(SymTableCompact_T oSymTable,
+                                const char *pcKey, size_t hash) {
+    size_t uMask = oSymTable->indexSize - 1;
+    size_t uSlot = hash & uMask;
+    size_t uValue;
+    while ((uValue = SymTable_getSlot(oSymTable, uSlot)) != 0) {
+        const Entry *psEntry = &oSymTable->entries[uValue - 1];
+        if (psEntry->hash == hash && psEntry->key != NULL &&
+            SYMTABLE_STRCMP(&oSymTable->base, psEntry->key, pcKey) == 0)
+            break;
+        uSlot = (uSlot + 1) & uMask;
+    }
+    return uSlot;
+}
+
+/* Return the entry of oSymTable whose key is pcKey, or NULL if there is no
+ * such entry. */
+static Entry *SymTable_findEntry(SymTableCompact_T oSymTable,
+                                 const char *pcKey) {
+    size_t uValue = SymTable_getSlot(
+        oSymTable,
+        SymTable_findSlot(oSymTable, pcKey, SymTable_mixedHash(pcKey)));
+    if (uValue == 0) return NULL;
+    return &oSymTable->entries[uValue - 1];
+}
+
+/* Give oSymTable room for uCapacity entries, which must be at least its
+ * current room: close the holes in its entries array, keeping the
+ * order of the rest, and rebuild its index at the size and width that
+ * uCapacity calls for. Keys are neither copied nor rehashed. Returns 1 on
+ * success, or 0 and leaves oSymTable unchanged if insufficient memory is
+ * available. */
+static int SymTable_resize(SymTableCompact_T oSymTable, size_t uCapacity) {
+    size_t uIndexSize = SymTable_indexSize(uCapacity);
+    size_t uSlotWidth = SymTable_slotWidth(uCapacity);
+    void *pvIndex;
+    Entry *psEntries;
+    size_t i, uCount;
+#ifdef SYMTABLE_STATS
+    double dStart = SymTable_now();
+#endif
+
+    assert(uCapacity >= oSymTable->capacity);
+
+    pvIndex = calloc(uIndexSize, uSlotWidth);
+    if (pvIndex == NULL) return 0;
+    psEntries = oSymTable->entries;
+    if (uCapacity != oSymTable->capacity) {
+        psEntries = (Entry *)realloc(psEntries, uCapacity * sizeof(Entry));
+        if (psEntries == NULL) {
+            free(pvIndex);
+            return 0;
+        }
+    }
+    SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                       uCapacity * sizeof(Entry) + uIndexSize * uSlotWidth);
+    SYMTABLE_STATS_SUB(&oSymTable->base, bytesAllocated,
+                       oSymTable->capacity * sizeof(Entry) +
+                           oSymTable->indexSize * oSymTable->slotWidth);
+    free(oSymTable->index);
+    oSymTable->entries = psEntries;
+    oSymTable->capacity = uCapacity;
+    oSymTable->index = pvIndex;
+    oSymTable->indexSize = uIndexSize;
+    oSymTable->slotWidth = uSlotWidth;
+
+    uCount = 0;
+    for (i = 0; i < oSymTable->numEntries; i++) {
+        size_t uSlot;
+        if (psEntries[i].key == NULL) continue;
+        psEntries[uCount] = psEntries[i];
+        uSlot = psEntries[uCount].hash & (uIndexSize - 1);
+        while (SymTable_getSlot(oSymTable, uSlot) != 0)
+            uSlot = (uSlot + 1) & (uIndexSize - 1);
+        SymTable_setSlot(oSymTable, uSlot, uCount + 1);
+        uCount++;
+    }
+    oSymTable->numEntries = uCount;
+#ifdef SYMTABLE_STATS
+    oSymTable->base.counters.resizeCount++;
+    oSymTable->base.counters.resizeNs += SymTable_now() - dStart;
+#endif
+    return 1;
+}
+
+/* Return a new compact SymTable object that contains no bindings, or NULL
+ * if insufficient memory is available. */
+static SymTable_T SymTableCompact_new(void) {
+    SymTableCompact_T symtable =
+        (SymTableCompact_T)malloc(sizeof(struct SymTableCompact));
+    if (symtable == NULL) return NULL;
+    symtable->indexSize = SymTable_indexSize(ENTRY_CAPACITY);
+    symtable->slotWidth = SymTable_slotWidth(ENTRY_CAPACITY);
+    symtable->entries = (Entry *)malloc(ENTRY_CAPACITY * sizeof(Entry));
+    symtable->index = calloc(symtable->indexSize, symtable->slotWidth);
+    if (symtable->entries == NULL || symtable->index == NULL) {
+        free(symtable->entries);
+        free(symtable->index);
+        free(symtable);
+        return NULL;
+    }
+    SymTable_initHeader(&symtable->base, &SymTableCompact_backend);
+    SYMTABLE_STATS_ADD(&symtable->base, bytesAllocated,
+                       sizeof(struct SymTableCompact) +
+                           ENTRY_CAPACITY * sizeof(Entry) +
+                           symtable->indexSize * symtable->slotWidth);
+    symtable->numEntries = 0;
+    symtable->capacity = ENTRY_CAPACITY;
+    symtable->numBindings = 0;
+    return &symtable->base;
+}
+
+static void SymTableCompact_free(SymTable_T oBase) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    size_t i;
+    assert(oSymTable != NULL);
+    for (i = 0; i < oSymTable->numEntries; i++)
+        free((char *)oSymTable->entries[i].key);
+    free(oSymTable->entries);
+    free(oSymTable->index);
+    free(oSymTable);
+}
+
+static size_t SymTableCompact_getLength(SymTable_T oBase) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    assert(oSymTable != NULL);
+    return oSymTable->numBindings;
+}
+
+static int SymTableCompact_put(SymTable_T oBase, const char *pcKey,
+                               const void *pvValue) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    size_t hash, uSlot;
+    char *key;
+    Entry *psEntry;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_mixedHash(pcKey);
+    uSlot = SymTable_findSlot(oSymTable, pcKey, hash);
+    if (SymTable_getSlot(oSymTable, uSlot) != 0) return 0;
+
+    key = (char *)malloc(strlen(pcKey) + 1);
+    if (key == NULL) return 0;
+    strcpy(key, pcKey);
+
+    if (oSymTable->numEntries == oSymTable->capacity) {
+        /* Close the holes in place if they are a quarter of the entries,
+         * otherwise double the room */
+        size_t uCapacity = oSymTable->capacity;
+        if (oSymTable->numBindings > uCapacity - uCapacity / 4)
+            uCapacity *= 2;
+        if (!SymTable_resize(oSymTable, uCapacity)) {
+            free(key);
+            return 0;
+        }
+        uSlot = SymTable_findSlot(oSymTable, pcKey, hash);
+    }
+
+    SYMTABLE_STATS_ADD(oBase, bytesAllocated, strlen(pcKey) + 1);
+    psEntry = &oSymTable->entries[oSymTable->numEntries];
+    psEntry->key = key;
+    psEntry->value = (void *)pvValue;
+    psEntry->hash = hash;
+    oSymTable->numEntries++;
+    SymTable_setSlot(oSymTable, uSlot, oSymTable->numEntries);
+    oSymTable->numBindings++;
+    return 1;
+}
+
+static void *SymTableCompact_replace(SymTable_T oBase, const char *pcKey,
+                                     const void *pvValue) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    Entry *psEntry;
+    void *oldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_findEntry(oSymTable, pcKey);
+    if (psEntry == NULL) return NULL;
+    oldValue = psEntry->value;
+    psEntry->value = (void *)pvValue;
+    return oldValue;
+}
+
+static int SymTableCompact_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_findEntry(oSymTable, pcKey) != NULL;
+}
+
+static void *SymTableCompact_get(SymTable_T oBase, const char *pcKey) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    Entry *psEntry;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_findEntry(oSymTable, pcKey);
+    if (psEntry == NULL) return NULL;
+    return psEntry->value;
+}
+
+static void *SymTableCompact_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    Entry *psEntry;
+    void *value;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psEntry = SymTable_findEntry(oSymTable, pcKey);
+    if (psEntry == NULL) return NULL;
+    value = psEntry->value;
+    SYMTABLE_STATS_SUB(oBase, bytesAllocated, strlen(psEntry->key) + 1);
+    free((char *)psEntry->key);
+    psEntry->key = NULL;
+    oSymTable->numBindings--;
+
+    /* An empty table has nothing to probe past: start over */
+    if (oSymTable->numBindings == 0) {
+        memset(oSymTable->index, 0,
+               oSymTable->indexSize * oSymTable->slotWidth);
+        oSymTable->numEntries = 0;
+    }
+    return value;
+}
+
+static void SymTableCompact_map(SymTable_T oBase,
+                                void (*pfApply)(const char *pcKey,
+                                                void *pvValue, void *pvExtra),
+                                const void *pvExtra) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    for (i = 0; i < oSymTable->numEntries; i++)
+        if (oSymTable->entries[i].key != NULL)
+            (*pfApply)(oSymTable->entries[i].key, oSymTable->entries[i].value,
+                       (void *)pvExtra);
+}
+
+/* Each run of occupied slots, which a lookup may have to probe to its end,
+ * is reported as a chain of the bindings it points to, and each empty slot
+ * as an empty chain. */
+static void SymTableCompact_getStats(SymTable_T oBase,
+                                     struct SymTableStats *psStats) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    size_t uLength = 0;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+    for (i = 0; i < oSymTable->indexSize; i++) {
+        size_t uValue = SymTable_getSlot(oSymTable, i);
+        if (uValue != 0) {
+            if (oSymTable->entries[uValue - 1].key != NULL) uLength++;
+            continue;
+        }
+        if (uLength > 0) SymTable_addChain(psStats, uLength);
+        SymTable_addChain(psStats, 0);
+        uLength = 0;
+    }
+    if (uLength > 0) SymTable_addChain(psStats, uLength);
+}
+
+static int SymTableCompact_reserve(SymTable_T oBase, size_t uCount) {
+    SymTableCompact_T oSymTable = (SymTableCompact_T)oBase;
+    assert(oSymTable != NULL);
+    /* The holes count against the room until put closes them */
+    if (uCount <= oSymTable->capacity - oSymTable->numEntries +
+                      oSymTable->numBindings)
+        return 1;
+    if (uCount < oSymTable->capacity) uCount = oSymTable->capacity;
+    return SymTable_resize(oSymTable, uCount);
+}
+
+/* The function table of the compact backend */
+const struct SymTableBackend SymTableCompact_backend = {
+    "compact",
+    SymTableCompact_new,
+    SymTableCompact_free,
+    SymTableCompact_getLength,
+    SymTableCompact_put,
+    SymTableCompact_replace,
+    SymTableCompact_contains,
+    SymTableCompact_get,
+    SymTableCompact_remove,
+    SymTableCompact_map,
+    SymTableCompact_getStats,
+    NULL,
+    SymTableCompact_reserve,
+    NULL};
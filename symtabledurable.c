@@ -0,0 +1,604 @@
+/*--------------------------------------------------------------------*/
+/* symtabledurable.c                                                  */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "symtablebackend.h"
+#include "symtabledurable.h"
+
+/* Enum containing the number of buffered log bytes that triggers a group
+ * commit, the size the log must reach before it is compacted, and how many
+ * times larger than the snapshot it must also be */
+enum { SYNC_BYTES = 64 * 1024, COMPACT_BYTES = 1024 * 1024, COMPACT_RATIO = 2 };
+
+/* Enum containing the kinds of log record: a SET record binds its key to its
+ * value whether or not the key was bound, and a REMOVE record unbinds it */
+enum RecordKind { RECORD_SET = 1, RECORD_REMOVE = 2 };
+
+/* A record is a kind byte, a 4-byte key length, the key without its '\0',
+ * an 8-byte value for a SET record, and a 4-byte checksum of all that, with
+ * integers in the byte order of the machine. RECORD_HEADER is the size of
+ * the first two fields. */
+enum { RECORD_HEADER = 5, RECORD_VALUE = 8, RECORD_CHECKSUM = 4 };
+
+/* Magic number that begins a snapshot, followed by an 8-byte binding count
+ * and then a SET record for each binding */
+static const char acSnapshotMagic[8] = {'S', 'Y', 'M', 'S', 'N', 'A', 'P', '1'};
+/* Enum containing the size of the snapshot header */
+enum { SNAPSHOT_HEADER = 16 };
+
+/* A SymTableDurable object is an ordinary table together with the log that
+ * records its changes and the buffer of records not yet written to it. */
+struct SymTableDurable {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* The table that holds the bindings */
+    SymTable_T table;
+    /* Paths of the log, the snapshot, and the snapshot being written */
+    char *logPath;
+    char *snapshotPath;
+    char *tempPath;
+    /* Descriptor of the log, opened for appending */
+    int logFd;
+    /* Records not yet written to the log */
+    char *buffer;
+    /* Number of bytes in buffer */
+    size_t bufferLength;
+    /* Number of bytes buffer has room for */
+    size_t bufferCapacity;
+    /* Size of the log on disk */
+    size_t logBytes;
+    /* Size of the snapshot on disk */
+    size_t snapshotBytes;
+    /* 1 once an I/O error has occurred */
+    int failed;
+};
+
+/* shortened form for a pointer to struct SymTableDurable */
+typedef struct SymTableDurable *SymTableDurable_T;
+
+/* A SnapshotState object is the state of a snapshot being written by
+ * SymTable_map. */
+struct SnapshotState {
+    /* The file being written */
+    FILE *file;
+    /* Record buffer, grown to hold the longest key */
+    char *record;
+    /* Number of bytes record has room for */
+    size_t capacity;
+    /* 0 once a write or allocation has failed */
+    int ok;
+};
+
+/* Return the FNV-1a hash of the uLength bytes at pcBytes. */
+static uint32_t SymTable_checksum(const char *pcBytes, size_t uLength) {
+    uint32_t uHash = 2166136261u;
+    size_t i;
+    for (i = 0; i < uLength; i++) {
+        uHash ^= (unsigned char)pcBytes[i];
+        uHash *= 16777619u;
+    }
+    return uHash;
+}
+
+/* Return the size of a record of kind eKind whose key is uKeyLength bytes
+ * long. */
+static size_t SymTable_recordSize(enum RecordKind eKind, size_t uKeyLength) {
+    return RECORD_HEADER + uKeyLength +
+           (eKind == RECORD_SET ? RECORD_VALUE : 0) + RECORD_CHECKSUM;
+}
+
+/* Write a record of kind eKind binding pcKey, which is uKeyLength bytes
+ * long, to pvValue into pcRecord, and return its size. */
+static size_t SymTable_encodeRecord(char *pcRecord, enum RecordKind eKind,
+                                    const char *pcKey, size_t uKeyLength,
+                                    const void *pvValue) {
+    uint32_t uLength = (uint32_t)uKeyLength;
+    uint64_t uValue = (uint64_t)(uintptr_t)pvValue;
+    uint32_t uChecksum;
+    size_t uSize = RECORD_HEADER + uKeyLength;
+    pcRecord[0] = (char)eKind;
+    memcpy(pcRecord + 1, &uLength, sizeof(uLength));
+    memcpy(pcRecord + RECORD_HEADER, pcKey, uKeyLength);
+    if (eKind == RECORD_SET) {
+        memcpy(pcRecord + uSize, &uValue, sizeof(uValue));
+        uSize += RECORD_VALUE;
+    }
+    uChecksum = SymTable_checksum(pcRecord, uSize);
+    memcpy(pcRecord + uSize, &uChecksum, sizeof(uChecksum));
+    return uSize + RECORD_CHECKSUM;
+}
+
+/* Write the uLength bytes at pcBytes to iFd. Return 1, or 0 if an I/O error
+ * occurs. */
+static int SymTable_writeAll(int iFd, const char *pcBytes, size_t uLength) {
+    while (uLength > 0) {
+        ssize_t iWritten = write(iFd, pcBytes, uLength);
+        if (iWritten < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        pcBytes += iWritten;
+        uLength -= (size_t)iWritten;
+    }
+    return 1;
+}
+
+/* Read the whole file pcPath into a new buffer *ppcContents of *puLength
+ * bytes, which the caller frees. A missing file reads as empty, with
+ * *ppcContents NULL. Return 1, or 0 if an I/O error occurs or insufficient
+ * memory is available. */
+static int SymTable_readFile(const char *pcPath, char **ppcContents,
+                             size_t *puLength) {
+    struct stat sStat;
+    size_t uRead = 0;
+    int iFd = open(pcPath, O_RDONLY);
+    *ppcContents = NULL;
+    *puLength = 0;
+    if (iFd < 0) return errno == ENOENT;
+    if (fstat(iFd, &sStat) != 0) {
+        close(iFd);
+        return 0;
+    }
+    *ppcContents = (char *)malloc((size_t)sStat.st_size + 1);
+    if (*ppcContents == NULL) {
+        close(iFd);
+        return 0;
+    }
+    while (uRead < (size_t)sStat.st_size) {
+        ssize_t iCount =
+            read(iFd, *ppcContents + uRead, (size_t)sStat.st_size - uRead);
+        if (iCount < 0 && errno == EINTR) continue;
+        if (iCount <= 0) break;
+        uRead += (size_t)iCount;
+    }
+    close(iFd);
+    *puLength = uRead;
+    return 1;
+}
+
+/* Decode the record at the start of the uLength bytes at pcRecord: store its
+ * kind in *peKind, its key in *ppcKey, and its value in *ppvValue, and
+ * return its size. The key is left in place and terminated by overwriting
+ * the byte after it, so the record cannot be decoded again. Return 0 if the
+ * bytes do not begin with a whole record whose checksum matches. */
+static size_t SymTable_decodeRecord(char *pcRecord, size_t uLength,
+                                    enum RecordKind *peKind,
+                                    const char **ppcKey, void **ppvValue) {
+    uint32_t uKeyLength, uChecksum;
+    uint64_t uValue = 0;
+    size_t uSize;
+    if (uLength < RECORD_HEADER) return 0;
+    if (pcRecord[0] != RECORD_SET && pcRecord[0] != RECORD_REMOVE) return 0;
+    *peKind = (enum RecordKind)pcRecord[0];
+    memcpy(&uKeyLength, pcRecord + 1, sizeof(uKeyLength));
+    if (uKeyLength > uLength) return 0;
+    uSize = SymTable_recordSize(*peKind, uKeyLength);
+    if (uSize > uLength) return 0;
+    memcpy(&uChecksum, pcRecord + uSize - RECORD_CHECKSUM, sizeof(uChecksum));
+    if (SymTable_checksum(pcRecord, uSize - RECORD_CHECKSUM) != uChecksum)
+        return 0;
+    if (*peKind == RECORD_SET)
+        memcpy(&uValue, pcRecord + RECORD_HEADER + uKeyLength, sizeof(uValue));
+    *ppvValue = (void *)(uintptr_t)uValue;
+    pcRecord[RECORD_HEADER + uKeyLength] = '\0';
+    *ppcKey = pcRecord + RECORD_HEADER;
+    return uSize;
+}
+
+/* Apply the records at the start of the uLength bytes at pcRecords to
+ * oSymTable, and store the number of bytes that held whole records in
+ * *puValid, decoding them in place. A SET record of a snapshot, where
+ * bUnique is 1, binds a key that no earlier record bound. Return 1, or 0 if
+ * insufficient memory is available. */
+static int SymTable_replay(SymTable_T oSymTable, char *pcRecords,
+                           size_t uLength, int bUnique, size_t *puValid) {
+    const struct SymTableBackend *psBackend = oSymTable->backend;
+    size_t uOffset = 0;
+    for (;;) {
+        enum RecordKind eKind;
+        const char *pcKey;
+        void *pvValue;
+        size_t uSize =
+            SymTable_decodeRecord(pcRecords + uOffset, uLength - uOffset,
+                                  &eKind, &pcKey, &pvValue);
+        if (uSize == 0) break;
+        if (eKind == RECORD_REMOVE)
+            psBackend->pfRemove(oSymTable, pcKey);
+        else if (!bUnique && psBackend->pfContains(oSymTable, pcKey))
+            psBackend->pfReplace(oSymTable, pcKey, pvValue);
+        else if (!psBackend->pfPut(oSymTable, pcKey, pvValue))
+            return 0;
+        uOffset += uSize;
+    }
+    *puValid = uOffset;
+    return 1;
+}
+
+/* Rebuild the bindings of oSymTable from its snapshot and its log, and
+ * truncate the log after its last whole record, which is where a crash
+ * interrupted it. Return 1, or 0 if an I/O error occurs, the snapshot is
+ * damaged, or insufficient memory is available. */
+static int SymTable_recover(SymTableDurable_T oSymTable) {
+    char *pcContents;
+    size_t uLength, uValid;
+    uint64_t uCount;
+    int iSuccessful;
+
+    if (!SymTable_readFile(oSymTable->snapshotPath, &pcContents, &uLength))
+        return 0;
+    if (pcContents != NULL) {
+        /* A snapshot is renamed into place only once it is complete, and
+         * its binding count sizes the table before the bulk load */
+        if (uLength >= SNAPSHOT_HEADER) {
+            memcpy(&uCount, pcContents + sizeof(acSnapshotMagic),
+                   sizeof(uCount));
+            SymTable_reserve(oSymTable->table, (size_t)uCount);
+        }
+        iSuccessful =
+            uLength >= SNAPSHOT_HEADER &&
+            memcmp(pcContents, acSnapshotMagic, sizeof(acSnapshotMagic)) == 0 &&
+            SymTable_replay(oSymTable->table, pcContents + SNAPSHOT_HEADER,
+                            uLength - SNAPSHOT_HEADER, 1, &uValid) &&
+            uValid == uLength - SNAPSHOT_HEADER;
+        free(pcContents);
+        if (!iSuccessful) return 0;
+        oSymTable->snapshotBytes = uLength;
+    }
+
+    if (!SymTable_readFile(oSymTable->logPath, &pcContents, &uLength))
+        return 0;
+    iSuccessful =
+        SymTable_replay(oSymTable->table, pcContents, uLength, 0, &uValid);
+    free(pcContents);
+    if (!iSuccessful) return 0;
+    if (uValid < uLength &&
+        (ftruncate(oSymTable->logFd, (off_t)uValid) != 0 ||
+         fsync(oSymTable->logFd) != 0))
+        return 0;
+    oSymTable->logBytes = uValid;
+    return 1;
+}
+
+/* Write the buffered records of oSymTable to its log and fsync it, and
+ * compact the log if it has grown large enough. Return 1, or 0 and mark
+ * oSymTable failed if an I/O error occurs. */
+static int SymTable_flush(SymTableDurable_T oSymTable) {
+    if (oSymTable->failed) return 0;
+    if (oSymTable->bufferLength > 0) {
+        if (!SymTable_writeAll(oSymTable->logFd, oSymTable->buffer,
+                               oSymTable->bufferLength) ||
+            fsync(oSymTable->logFd) != 0) {
+            oSymTable->failed = 1;
+            return 0;
+        }
+        oSymTable->logBytes += oSymTable->bufferLength;
+        oSymTable->bufferLength = 0;
+    }
+    if (oSymTable->logBytes >= COMPACT_BYTES &&
+        oSymTable->logBytes >= COMPACT_RATIO * oSymTable->snapshotBytes)
+        return SymTableDurable_compact(&oSymTable->base);
+    return 1;
+}
+
+/* Make room in the buffer of oSymTable for a record of uSize bytes. Return
+ * 1, or 0 if oSymTable has failed or insufficient memory is available. */
+static int SymTable_reserveRecord(SymTableDurable_T oSymTable, size_t uSize) {
+    size_t uCapacity = oSymTable->bufferCapacity;
+    char *pcBuffer;
+    if (oSymTable->failed) return 0;
+    if (oSymTable->bufferLength + uSize <= uCapacity) return 1;
+    while (uCapacity < oSymTable->bufferLength + uSize) uCapacity *= 2;
+    pcBuffer = (char *)realloc(oSymTable->buffer, uCapacity);
+    if (pcBuffer == NULL) return 0;
+    oSymTable->buffer = pcBuffer;
+    oSymTable->bufferCapacity = uCapacity;
+    return 1;
+}
+
+/* Append to the buffer of oSymTable, which has room for it, a record of kind
+ * eKind binding pcKey to pvValue, and commit the buffer if it is full. */
+static void SymTable_logRecord(SymTableDurable_T oSymTable,
+                               enum RecordKind eKind, const char *pcKey,
+                               const void *pvValue) {
+    oSymTable->bufferLength += SymTable_encodeRecord(
+        oSymTable->buffer + oSymTable->bufferLength, eKind, pcKey,
+        strlen(pcKey), pvValue);
+    if (oSymTable->bufferLength >= SYNC_BYTES) SymTable_flush(oSymTable);
+}
+
+/* Append a SET record for the binding of pcKey and pvValue to the snapshot
+ * that *pvExtra, a struct SnapshotState, is writing. */
+static void SymTable_writeBinding(const char *pcKey, void *pvValue,
+                                  void *pvExtra) {
+    struct SnapshotState *psState = (struct SnapshotState *)pvExtra;
+    size_t uKeyLength = strlen(pcKey);
+    size_t uSize = SymTable_recordSize(RECORD_SET, uKeyLength);
+    if (!psState->ok) return;
+    if (uSize > psState->capacity) {
+        char *pcRecord = (char *)realloc(psState->record, uSize);
+        if (pcRecord == NULL) {
+            psState->ok = 0;
+            return;
+        }
+        psState->record = pcRecord;
+        psState->capacity = uSize;
+    }
+    SymTable_encodeRecord(psState->record, RECORD_SET, pcKey, uKeyLength,
+                          pvValue);
+    if (fwrite(psState->record, 1, uSize, psState->file) != uSize)
+        psState->ok = 0;
+}
+
+/* Wait until the directory entries of the file pcPath are on disk. Return
+ * 1, or 0 if an I/O error occurs. */
+static int SymTable_syncDirectory(const char *pcPath) {
+    const char *pcSlash = strrchr(pcPath, '/');
+    char *pcDirectory;
+    int iFd, iSuccessful;
+    if (pcSlash == NULL) {
+        pcPath = ".";
+        pcSlash = pcPath + 1;
+    }
+    pcDirectory = (char *)malloc((size_t)(pcSlash - pcPath) + 2);
+    if (pcDirectory == NULL) return 0;
+    memcpy(pcDirectory, pcPath, (size_t)(pcSlash - pcPath));
+    pcDirectory[pcSlash - pcPath] = '\0';
+    if (pcDirectory[0] == '\0') strcpy(pcDirectory, "/");
+    iFd = open(pcDirectory, O_RDONLY);
+    free(pcDirectory);
+    if (iFd < 0) return 0;
+    iSuccessful = fsync(iFd) == 0;
+    close(iFd);
+    return iSuccessful;
+}
+
+/* Return a new string consisting of pcPath followed by pcSuffix, or NULL if
+ * insufficient memory is available. */
+static char *SymTable_path(const char *pcPath, const char *pcSuffix) {
+    char *pcResult = (char *)malloc(strlen(pcPath) + strlen(pcSuffix) + 1);
+    if (pcResult == NULL) return NULL;
+    strcpy(pcResult, pcPath);
+    strcat(pcResult, pcSuffix);
+    return pcResult;
+}
+
+int SymTableDurable_compact(SymTable_T oBase) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    struct SnapshotState sState;
+    uint64_t uCount;
+    long lSize;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableDurable_backend);
+
+    /* The log stays valid until the new snapshot is in place */
+    if (oSymTable->failed) return 0;
+    if (oSymTable->bufferLength > 0) {
+        if (!SymTable_writeAll(oSymTable->logFd, oSymTable->buffer,
+                               oSymTable->bufferLength)) {
+            oSymTable->failed = 1;
+            return 0;
+        }
+        oSymTable->logBytes += oSymTable->bufferLength;
+        oSymTable->bufferLength = 0;
+    }
+
+    sState.file = fopen(oSymTable->tempPath, "wb");
+    if (sState.file == NULL) return 0;
+    sState.record = NULL;
+    sState.capacity = 0;
+    sState.ok = 1;
+    uCount = (uint64_t)SymTable_getLength(oSymTable->table);
+    if (fwrite(acSnapshotMagic, 1, sizeof(acSnapshotMagic), sState.file) !=
+            sizeof(acSnapshotMagic) ||
+        fwrite(&uCount, 1, sizeof(uCount), sState.file) != sizeof(uCount))
+        sState.ok = 0;
+    SymTable_map(oSymTable->table, SymTable_writeBinding, &sState);
+    free(sState.record);
+    lSize = ftell(sState.file);
+    if (fflush(sState.file) != 0 || fsync(fileno(sState.file)) != 0 ||
+        lSize < 0)
+        sState.ok = 0;
+    if (fclose(sState.file) != 0) sState.ok = 0;
+    if (!sState.ok ||
+        rename(oSymTable->tempPath, oSymTable->snapshotPath) != 0 ||
+        !SymTable_syncDirectory(oSymTable->snapshotPath)) {
+        remove(oSymTable->tempPath);
+        return 0;
+    }
+    oSymTable->snapshotBytes = (size_t)lSize;
+
+    /* Replaying the old log over the new snapshot would be harmless, so a
+     * crash before the truncation is safe */
+    if (ftruncate(oSymTable->logFd, 0) != 0 || fsync(oSymTable->logFd) != 0) {
+        oSymTable->failed = 1;
+        return 0;
+    }
+    oSymTable->logBytes = 0;
+    return 1;
+}
+
+int SymTableDurable_sync(SymTable_T oBase) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableDurable_backend);
+    return SymTable_flush(oSymTable);
+}
+
+/* Free oSymTable, whose log may not be open, and its inner table. */
+static void SymTable_freeDurable(SymTableDurable_T oSymTable) {
+    if (oSymTable->logFd >= 0) close(oSymTable->logFd);
+    if (oSymTable->table != NULL) SymTable_free(oSymTable->table);
+    free(oSymTable->logPath);
+    free(oSymTable->snapshotPath);
+    free(oSymTable->tempPath);
+    free(oSymTable->buffer);
+    free(oSymTable);
+}
+
+SymTable_T SymTableDurable_open(const char *pcPath, const char *pcBackend) {
+    SymTableDurable_T symtable;
+    assert(pcPath != NULL);
+    assert(pcBackend != NULL);
+
+    symtable = (SymTableDurable_T)malloc(sizeof(struct SymTableDurable));
+    if (symtable == NULL) return NULL;
+    SymTable_initHeader(&symtable->base, &SymTableDurable_backend);
+    symtable->table = SymTable_newWithBackend(pcBackend);
+    symtable->logPath = SymTable_path(pcPath, ".log");
+    symtable->snapshotPath = SymTable_path(pcPath, ".snap");
+    symtable->tempPath = SymTable_path(pcPath, ".snap.tmp");
+    symtable->logFd = -1;
+    symtable->buffer = (char *)malloc(SYNC_BYTES);
+    symtable->bufferLength = 0;
+    symtable->bufferCapacity = SYNC_BYTES;
+    symtable->logBytes = 0;
+    symtable->snapshotBytes = 0;
+    symtable->failed = 0;
+    if (symtable->table == NULL || symtable->logPath == NULL ||
+        symtable->snapshotPath == NULL || symtable->tempPath == NULL ||
+        symtable->buffer == NULL) {
+        SymTable_freeDurable(symtable);
+        return NULL;
+    }
+
+    /* A leftover temporary snapshot is from a compaction that crashed */
+    remove(symtable->tempPath);
+    symtable->logFd = open(symtable->logPath, O_WRONLY | O_APPEND | O_CREAT,
+                           S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (symtable->logFd < 0 || !SymTable_recover(symtable)) {
+        SymTable_freeDurable(symtable);
+        return NULL;
+    }
+    return &symtable->base;
+}
+
+/* Durable tables are created only by SymTableDurable_open, so return
+ * NULL. */
+static SymTable_T SymTableDurable_new(void) { return NULL; }
+
+static void SymTableDurable_free(SymTable_T oBase) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    SymTable_flush(oSymTable);
+    SymTable_freeDurable(oSymTable);
+}
+
+static size_t SymTableDurable_getLength(SymTable_T oBase) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_getLength(oSymTable->table);
+}
+
+static int SymTableDurable_put(SymTable_T oBase, const char *pcKey,
+                               const void *pvValue) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!SymTable_reserveRecord(oSymTable,
+                                SymTable_recordSize(RECORD_SET, strlen(pcKey))))
+        return 0;
+    if (!SymTable_put(oSymTable->table, pcKey, pvValue)) return 0;
+    SymTable_logRecord(oSymTable, RECORD_SET, pcKey, pvValue);
+    return 1;
+}
+
+static void *SymTableDurable_replace(SymTable_T oBase, const char *pcKey,
+                                     const void *pvValue) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    void *oldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!SymTable_contains(oSymTable->table, pcKey) ||
+        !SymTable_reserveRecord(oSymTable,
+                                SymTable_recordSize(RECORD_SET, strlen(pcKey))))
+        return NULL;
+    oldValue = SymTable_replace(oSymTable->table, pcKey, pvValue);
+    SymTable_logRecord(oSymTable, RECORD_SET, pcKey, pvValue);
+    return oldValue;
+}
+
+static int SymTableDurable_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_contains(oSymTable->table, pcKey);
+}
+
+static void *SymTableDurable_get(SymTable_T oBase, const char *pcKey) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_get(oSymTable->table, pcKey);
+}
+
+static void *SymTableDurable_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    void *value;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!SymTable_contains(oSymTable->table, pcKey) ||
+        !SymTable_reserveRecord(oSymTable, SymTable_recordSize(RECORD_REMOVE,
+                                                               strlen(pcKey))))
+        return NULL;
+    value = SymTable_remove(oSymTable->table, pcKey);
+    SymTable_logRecord(oSymTable, RECORD_REMOVE, pcKey, NULL);
+    return value;
+}
+
+static void SymTableDurable_map(SymTable_T oBase,
+                                void (*pfApply)(const char *pcKey,
+                                                void *pvValue, void *pvExtra),
+                                const void *pvExtra) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    SymTable_map(oSymTable->table, pfApply, pvExtra);
+}
+
+static void SymTableDurable_getStats(SymTable_T oBase,
+                                     struct SymTableStats *psStats) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    if (oSymTable->table->backend->pfGetStats != NULL)
+        oSymTable->table->backend->pfGetStats(oSymTable->table, psStats);
+}
+
+static SymTable_T SymTableDurable_clone(SymTable_T oBase) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_clone(oSymTable->table);
+}
+
+static int SymTableDurable_reserve(SymTable_T oBase, size_t uCount) {
+    SymTableDurable_T oSymTable = (SymTableDurable_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_reserve(oSymTable->table, uCount);
+}
+
+/* The function table of durable tables, which is not registered because
+ * they need a path to be created */
+const struct SymTableBackend SymTableDurable_backend = {
+    "durable",
+    SymTableDurable_new,
+    SymTableDurable_free,
+    SymTableDurable_getLength,
+    SymTableDurable_put,
+    SymTableDurable_replace,
+    SymTableDurable_contains,
+    SymTableDurable_get,
+    SymTableDurable_remove,
+    SymTableDurable_map,
+    SymTableDurable_getStats,
+    SymTableDurable_clone,
+    SymTableDurable_reserve,
+    NULL};
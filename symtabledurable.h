@@ -0,0 +1,43 @@
+/*--------------------------------------------------------------------*/
+/* symtabledurable.h                                                  */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEDURABLE_H
+#define SYMTABLEDURABLE_H
+
+#include "symtable.h"
+
+/* A durable SymTable object keeps its bindings in an ordinary table of some
+ * backend and records every change made by SymTable_put, SymTable_replace,
+ * and SymTable_remove in a write-ahead log, the file pcPath.log. Records are
+ * buffered and written with one fsync per group, so a crash loses at most
+ * the changes made since the last SymTableDurable_sync, and never leaves a
+ * change half applied. When the log outgrows the snapshot, the file
+ * pcPath.snap, the table is written to a new snapshot and the log emptied.
+ *
+ * The table stores the bits of each value pointer, not what it points to,
+ * so values must keep their meaning from one run to the next: NULL, small
+ * integers cast to void *, offsets, and the like. */
+
+/* Return a durable SymTable object whose bindings are recovered from the
+ * files pcPath.snap and pcPath.log, which need not exist, and are kept in a
+ * table of the backend registered under the name pcBackend (such as "hash"
+ * or "hybrid"). Return NULL if there is no such backend, if the files cannot
+ * be read or the log cannot be created, or if insufficient memory is
+ * available. SymTable_free writes any buffered changes before it frees the
+ * table. SymTable_clone returns an ordinary table of the inner backend. */
+SymTable_T SymTableDurable_open(const char *pcPath, const char *pcBackend);
+
+/* Write the buffered changes of oSymTable to its log and wait until they are
+ * on disk. Return 1, or 0 if an I/O error has occurred, in which case
+ * oSymTable refuses every later change as if insufficient memory were
+ * available. oSymTable must be a durable SymTable. */
+int SymTableDurable_sync(SymTable_T oSymTable);
+
+/* Write the bindings of oSymTable to a new snapshot and empty its log.
+ * Return 1, or 0 if an I/O error has occurred or insufficient memory is
+ * available. oSymTable must be a durable SymTable. */
+int SymTableDurable_compact(SymTable_T oSymTable);
+
+#endif
@@ -0,0 +1,687 @@
+/*--------------------------------------------------------------------*/
+/* symtablehamt.c                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symtablebackend.h"
+#include "symtablehamt.h"
+
+/* Enum containing the number of hash bits consumed by each level of the
+ * trie, the shift at and beyond which a node holds keys whose hashes are
+ * equal, and the greatest number of nodes on a path from the root (13 levels
+ * of 5 bits cover the 64-bit hash, and a collision node comes last) */
+enum { BITS_PER_LEVEL = 5, COLLISION_SHIFT = 64, MAX_DEPTH = 14 };
+
+/* shortened form for struct Key */
+typedef struct Key Key;
+
+/* A Key object is a reference-counted copy of a key, shared by every node
+ * and every table that contains the binding. The characters of the key are
+ * stored in the same allocation right after it. */
+struct Key {
+    /* Number of node slots that refer to the key */
+    size_t refs;
+    /* Hash of the characters */
+    uint64_t hash;
+};
+
+/* shortened form for struct Node */
+typedef struct Node Node;
+
+/* A Node object is a reference-counted node of the trie, shared by all
+ * tables cloned from the table that created it. Its slots hold first its
+ * bindings, as Key and value pairs, then its children. In an ordinary node
+ * bit i of dataMap (or nodeMap) is set if the binding (or child) for hash
+ * fragment i is present, and the slots are ordered by fragment. A collision
+ * node, at COLLISION_SHIFT, holds dataMap bindings whose hashes are all
+ * equal, in no particular order, and no children. */
+struct Node {
+    /* Number of tables and parent nodes that refer to the node */
+    size_t refs;
+    /* Bitmap, or count in a collision node, of the bindings */
+    uint32_t dataMap;
+    /* Bitmap of the children */
+    uint32_t nodeMap;
+    /* The slots, exactly as many as the bitmaps call for */
+    void *slots[];
+};
+
+/* A SymTableHamt object consists of the root of a hash array mapped trie
+ * and the number of bindings in it. Nodes and keys may be shared with the
+ * tables it was cloned from or that were cloned from it: a table copies a
+ * shared node before changing it, so a clone costs constant time and each
+ * later change copies only the nodes on one path, which is what the
+ * versions of symtablehamt.h are built on. Reference counts are not
+ * atomic, so a table and its clones must be used by one thread at a time. */
+struct SymTableHamt {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* Root of the trie, never NULL */
+    struct Node *root;
+    /* Number of bindings in the table */
+    size_t numBindings;
+};
+
+/* shortened form for a pointer to struct SymTableHamt */
+typedef struct SymTableHamt *SymTableHamt_T;
+
+/* Return the characters of psKey. */
+static const char *SymTable_keyChars(const Key *psKey) {
+    return (const char *)(psKey + 1);
+}
+
+/* Return the number of bits set in uBits. */
+static size_t SymTable_bitCount(uint32_t uBits) {
+    uBits = uBits - ((uBits >> 1) & 0x55555555u);
+    uBits = (uBits & 0x33333333u) + ((uBits >> 2) & 0x33333333u);
+    return (size_t)((((uBits + (uBits >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >>
+                    24);
+}
+
+/* Return the bit of an ordinary node at iShift that stands for hash. */
+static uint32_t SymTable_bit(uint64_t hash, int iShift) {
+    return (uint32_t)1 << ((hash >> iShift) & ((1u << BITS_PER_LEVEL) - 1));
+}
+
+/* Return the number of bindings in psNode, which is at iShift. */
+static size_t SymTable_dataCount(const Node *psNode, int iShift) {
+    if (iShift >= COLLISION_SHIFT) return psNode->dataMap;
+    return SymTable_bitCount(psNode->dataMap);
+}
+
+/* Return the number of slots of psNode, which is at iShift. */
+static size_t SymTable_slotCount(const Node *psNode, int iShift) {
+    return 2 * SymTable_dataCount(psNode, iShift) +
+           SymTable_bitCount(psNode->nodeMap);
+}
+
+/* Return a new node with bitmaps uDataMap and uNodeMap and uSlotCount
+ * uninitialized slots, or NULL if insufficient memory is available. */
+static Node *SymTable_newNode(uint32_t uDataMap, uint32_t uNodeMap,
+                              size_t uSlotCount) {
+    Node *psNode =
+        (Node *)malloc(sizeof(Node) + uSlotCount * sizeof(void *));
+    if (psNode == NULL) return NULL;
+    psNode->refs = 1;
+    psNode->dataMap = uDataMap;
+    psNode->nodeMap = uNodeMap;
+    return psNode;
+}
+
+/* Drop one reference to psKey, freeing it when none remain. */
+static void SymTable_releaseKey(Key *psKey) {
+    if (--psKey->refs == 0) free(psKey);
+}
+
+/* Drop one reference to psNode, which is at iShift, freeing it and
+ * releasing its keys and children when none remain. */
+static void SymTable_releaseNode(Node *psNode, int iShift) {
+    size_t uDataCount, uSlotCount, i;
+    if (--psNode->refs > 0) return;
+    uDataCount = SymTable_dataCount(psNode, iShift);
+    uSlotCount = SymTable_slotCount(psNode, iShift);
+    for (i = 0; i < uDataCount; i++)
+        SymTable_releaseKey((Key *)psNode->slots[2 * i]);
+    for (i = 2 * uDataCount; i < uSlotCount; i++)
+        SymTable_releaseNode((Node *)psNode->slots[i],
+                             iShift + BITS_PER_LEVEL);
+    free(psNode);
+}
+
+/* Return a private copy of shared node psNode, which is at iShift, and drop
+ * the caller's reference to psNode, or return NULL and leave psNode as it is
+ * if insufficient memory is available. */
+static Node *SymTable_copyNode(Node *psNode, int iShift) {
+    size_t uDataCount = SymTable_dataCount(psNode, iShift);
+    size_t uSlotCount = SymTable_slotCount(psNode, iShift);
+    Node *psCopy =
+        SymTable_newNode(psNode->dataMap, psNode->nodeMap, uSlotCount);
+    size_t i;
+    if (psCopy == NULL) return NULL;
+    memcpy(psCopy->slots, psNode->slots, uSlotCount * sizeof(void *));
+    for (i = 0; i < uDataCount; i++) ((Key *)psCopy->slots[2 * i])->refs++;
+    for (i = 2 * uDataCount; i < uSlotCount; i++)
+        ((Node *)psCopy->slots[i])->refs++;
+    psNode->refs--;
+    return psCopy;
+}
+
+/* Change the number of slots of the node in *ppsNode to uSlotCount, moving
+ * it if necessary. Returns 1 on success, or 0 and leaves the node unchanged
+ * if insufficient memory is available. */
+static int SymTable_resizeNode(Node **ppsNode, size_t uSlotCount) {
+    Node *psNode =
+        (Node *)realloc(*ppsNode, sizeof(Node) + uSlotCount * sizeof(void *));
+    if (psNode == NULL) return 0;
+    *ppsNode = psNode;
+    return 1;
+}
+
+/* Return the index in the slots of psNode, which is at iShift, of the key of
+ * the binding whose key is pcKey and whose hash is hash, or the slot count
+ * if there is no such binding. psNode is the last node on the path of
+ * hash. */
+static size_t SymTable_findSlot(SymTableHamt_T oSymTable, const Node *psNode,
+                                int iShift, const char *pcKey,
+                                uint64_t hash) {
+    size_t uSlotCount = SymTable_slotCount(psNode, iShift);
+    size_t i;
+    if (iShift >= COLLISION_SHIFT) {
+        for (i = 0; i < uSlotCount; i += 2)
+            if (SYMTABLE_STRCMP(&oSymTable->base,
+                                SymTable_keyChars((Key *)psNode->slots[i]),
+                                pcKey) == 0)
+                return i;
+    } else {
+        uint32_t uBit = SymTable_bit(hash, iShift);
+        const Key *psKey;
+        if (!(psNode->dataMap & uBit)) return uSlotCount;
+        i = 2 * SymTable_bitCount(psNode->dataMap & (uBit - 1));
+        psKey = (const Key *)psNode->slots[i];
+        if (psKey->hash == hash &&
+            SYMTABLE_STRCMP(&oSymTable->base, SymTable_keyChars(psKey),
+                            pcKey) == 0)
+            return i;
+    }
+    return uSlotCount;
+}
+
+/* Return the last node on the path of hash in oSymTable and store its shift
+ * in *piShift. */
+static Node *SymTable_descend(SymTableHamt_T oSymTable, uint64_t hash,
+                              int *piShift) {
+    Node *psNode = oSymTable->root;
+    int iShift = 0;
+    while (iShift < COLLISION_SHIFT) {
+        uint32_t uBit = SymTable_bit(hash, iShift);
+        if (!(psNode->nodeMap & uBit)) break;
+        psNode = (Node *)psNode->slots[2 * SymTable_bitCount(psNode->dataMap) +
+                                       SymTable_bitCount(psNode->nodeMap &
+                                                         (uBit - 1))];
+        iShift += BITS_PER_LEVEL;
+    }
+    *piShift = iShift;
+    return psNode;
+}
+
+/* Copy every shared node on the path of hash in oSymTable, so that the
+ * path can be changed in place, and store in appsPath the address of the
+ * pointer to each node on it. Returns the number of nodes on the path, or 0
+ * if insufficient memory is available; oSymTable is unchanged in content
+ * either way. */
+static size_t SymTable_unsharePath(SymTableHamt_T oSymTable, uint64_t hash,
+                                   Node **appsPath[MAX_DEPTH]) {
+    Node **ppsNode = &oSymTable->root;
+    size_t uDepth = 0;
+    int iShift = 0;
+    for (;;) {
+        Node *psNode = *ppsNode;
+        uint32_t uBit;
+        if (psNode->refs > 1) {
+            psNode = SymTable_copyNode(psNode, iShift);
+            if (psNode == NULL) return 0;
+            *ppsNode = psNode;
+        }
+        appsPath[uDepth++] = ppsNode;
+        if (iShift >= COLLISION_SHIFT) break;
+        uBit = SymTable_bit(hash, iShift);
+        if (!(psNode->nodeMap & uBit)) break;
+        ppsNode = (Node **)&psNode->slots[2 * SymTable_bitCount(
+                                                 psNode->dataMap) +
+                                          SymTable_bitCount(psNode->nodeMap &
+                                                            (uBit - 1))];
+        iShift += BITS_PER_LEVEL;
+    }
+    return uDepth;
+}
+
+/* Return a new subtrie at iShift that holds the bindings of psKey1 and
+ * psKey2, whose hashes differ in no bit below iShift, or NULL if
+ * insufficient memory is available. */
+static Node *SymTable_mergeBindings(Key *psKey1, void *pvValue1, Key *psKey2,
+                                    void *pvValue2, int iShift) {
+    Node *psNode;
+    uint32_t uBit1, uBit2;
+    if (iShift >= COLLISION_SHIFT) {
+        psNode = SymTable_newNode(2, 0, 4);
+        if (psNode == NULL) return NULL;
+    } else {
+        uBit1 = SymTable_bit(psKey1->hash, iShift);
+        uBit2 = SymTable_bit(psKey2->hash, iShift);
+        if (uBit1 == uBit2) {
+            /* The hashes agree here too: push both one level down */
+            psNode = SymTable_newNode(0, uBit1, 1);
+            if (psNode == NULL) return NULL;
+            psNode->slots[0] = SymTable_mergeBindings(
+                psKey1, pvValue1, psKey2, pvValue2, iShift + BITS_PER_LEVEL);
+            if (psNode->slots[0] == NULL) {
+                free(psNode);
+                return NULL;
+            }
+            return psNode;
+        }
+        psNode = SymTable_newNode(uBit1 | uBit2, 0, 4);
+        if (psNode == NULL) return NULL;
+        if (uBit2 < uBit1) {
+            Key *psKey = psKey1;
+            void *pvValue = pvValue1;
+            psKey1 = psKey2;
+            pvValue1 = pvValue2;
+            psKey2 = psKey;
+            pvValue2 = pvValue;
+        }
+    }
+    psNode->slots[0] = psKey1;
+    psNode->slots[1] = pvValue1;
+    psNode->slots[2] = psKey2;
+    psNode->slots[3] = pvValue2;
+    return psNode;
+}
+
+/* Return a new HAMT SymTable object that contains no bindings, or NULL if
+ * insufficient memory is available. */
+static SymTable_T SymTableHamt_new(void) {
+    SymTableHamt_T symtable =
+        (SymTableHamt_T)malloc(sizeof(struct SymTableHamt));
+    if (symtable == NULL) return NULL;
+    symtable->root = SymTable_newNode(0, 0, 0);
+    if (symtable->root == NULL) {
+        free(symtable);
+        return NULL;
+    }
+    SymTable_initHeader(&symtable->base, &SymTableHamt_backend);
+    symtable->numBindings = 0;
+    return &symtable->base;
+}
+
+static SymTable_T SymTableHamt_clone(SymTable_T oBase) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    SymTableHamt_T symtable;
+    assert(oSymTable != NULL);
+    symtable = (SymTableHamt_T)malloc(sizeof(struct SymTableHamt));
+    if (symtable == NULL) return NULL;
+    SymTable_initHeader(&symtable->base, &SymTableHamt_backend);
+    symtable->root = oSymTable->root;
+    symtable->root->refs++;
+    symtable->numBindings = oSymTable->numBindings;
+    return &symtable->base;
+}
+
+static void SymTableHamt_free(SymTable_T oBase) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    assert(oSymTable != NULL);
+    SymTable_releaseNode(oSymTable->root, 0);
+    free(oSymTable);
+}
+
+static size_t SymTableHamt_getLength(SymTable_T oBase) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    assert(oSymTable != NULL);
+    return oSymTable->numBindings;
+}
+
+static int SymTableHamt_put(SymTable_T oBase, const char *pcKey,
+                            const void *pvValue) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    Node **appsPath[MAX_DEPTH];
+    Node **ppsNode;
+    Node *psNode;
+    Key *psKey;
+    uint64_t hash;
+    size_t uDepth, uSlotCount, keyLength;
+    int iShift;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_mixedHash(pcKey);
+    psNode = SymTable_descend(oSymTable, hash, &iShift);
+    if (SymTable_findSlot(oSymTable, psNode, iShift, pcKey, hash) !=
+        SymTable_slotCount(psNode, iShift))
+        return 0;
+
+    keyLength = strlen(pcKey) + 1;
+    psKey = (Key *)malloc(sizeof(Key) + keyLength);
+    if (psKey == NULL) return 0;
+    psKey->refs = 1;
+    psKey->hash = hash;
+    memcpy((char *)(psKey + 1), pcKey, keyLength);
+
+    uDepth = SymTable_unsharePath(oSymTable, hash, appsPath);
+    if (uDepth == 0) {
+        free(psKey);
+        return 0;
+    }
+    ppsNode = appsPath[uDepth - 1];
+    psNode = *ppsNode;
+    uSlotCount = SymTable_slotCount(psNode, iShift);
+
+    if (iShift >= COLLISION_SHIFT) {
+        /* Append the binding to the collision node */
+        if (!SymTable_resizeNode(ppsNode, uSlotCount + 2)) {
+            free(psKey);
+            return 0;
+        }
+        psNode = *ppsNode;
+        psNode->slots[uSlotCount] = psKey;
+        psNode->slots[uSlotCount + 1] = (void *)pvValue;
+        psNode->dataMap++;
+    } else {
+        uint32_t uBit = SymTable_bit(hash, iShift);
+        size_t uIndex = 2 * SymTable_bitCount(psNode->dataMap & (uBit - 1));
+        if (psNode->dataMap & uBit) {
+            /* Another binding has the slot: replace it by a child that
+             * holds both bindings, which shortens the slots by one */
+            size_t uChildIndex;
+            Node *psChild = SymTable_mergeBindings(
+                (Key *)psNode->slots[uIndex], psNode->slots[uIndex + 1], psKey,
+                (void *)pvValue, iShift + BITS_PER_LEVEL);
+            if (psChild == NULL) {
+                free(psKey);
+                return 0;
+            }
+            memmove(&psNode->slots[uIndex], &psNode->slots[uIndex + 2],
+                    (uSlotCount - uIndex - 2) * sizeof(void *));
+            psNode->dataMap &= ~uBit;
+            uChildIndex = 2 * SymTable_bitCount(psNode->dataMap) +
+                          SymTable_bitCount(psNode->nodeMap & (uBit - 1));
+            memmove(&psNode->slots[uChildIndex + 1],
+                    &psNode->slots[uChildIndex],
+                    (uSlotCount - 2 - uChildIndex) * sizeof(void *));
+            psNode->slots[uChildIndex] = psChild;
+            psNode->nodeMap |= uBit;
+        } else {
+            /* Insert the binding into its slot */
+            if (!SymTable_resizeNode(ppsNode, uSlotCount + 2)) {
+                free(psKey);
+                return 0;
+            }
+            psNode = *ppsNode;
+            memmove(&psNode->slots[uIndex + 2], &psNode->slots[uIndex],
+                    (uSlotCount - uIndex) * sizeof(void *));
+            psNode->slots[uIndex] = psKey;
+            psNode->slots[uIndex + 1] = (void *)pvValue;
+            psNode->dataMap |= uBit;
+        }
+    }
+    oSymTable->numBindings++;
+    return 1;
+}
+
+static void *SymTableHamt_replace(SymTable_T oBase, const char *pcKey,
+                                  const void *pvValue) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    Node **appsPath[MAX_DEPTH];
+    Node *psNode;
+    uint64_t hash;
+    size_t uDepth, uSlot;
+    void *oldValue;
+    int iShift;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_mixedHash(pcKey);
+    psNode = SymTable_descend(oSymTable, hash, &iShift);
+    uSlot = SymTable_findSlot(oSymTable, psNode, iShift, pcKey, hash);
+    if (uSlot == SymTable_slotCount(psNode, iShift)) return NULL;
+    /* A node is shared if any node above it is, whatever its own count */
+    uDepth = SymTable_unsharePath(oSymTable, hash, appsPath);
+    if (uDepth == 0) return NULL;
+    psNode = *appsPath[uDepth - 1];
+    oldValue = psNode->slots[uSlot + 1];
+    psNode->slots[uSlot + 1] = (void *)pvValue;
+    return oldValue;
+}
+
+static int SymTableHamt_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    uint64_t hash;
+    Node *psNode;
+    int iShift;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    hash = SymTable_mixedHash(pcKey);
+    psNode = SymTable_descend(oSymTable, hash, &iShift);
+    return SymTable_findSlot(oSymTable, psNode, iShift, pcKey, hash) !=
+           SymTable_slotCount(psNode, iShift);
+}
+
+static void *SymTableHamt_get(SymTable_T oBase, const char *pcKey) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    uint64_t hash;
+    Node *psNode;
+    size_t uSlot;
+    int iShift;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    hash = SymTable_mixedHash(pcKey);
+    psNode = SymTable_descend(oSymTable, hash, &iShift);
+    uSlot = SymTable_findSlot(oSymTable, psNode, iShift, pcKey, hash);
+    if (uSlot == SymTable_slotCount(psNode, iShift)) return NULL;
+    return psNode->slots[uSlot + 1];
+}
+
+/* Restore the invariants of the unshared path appsPath of uDepth nodes of
+ * hash after a binding was removed from its last node: a node other than the
+ * root that is left empty is removed, and one that is left with a single
+ * binding and no children is replaced in its parent by that binding. */
+static void SymTable_compactPath(Node **appsPath[MAX_DEPTH], size_t uDepth,
+                                 uint64_t hash) {
+    size_t uLevel;
+    for (uLevel = uDepth - 1; uLevel > 0; uLevel--) {
+        Node *psNode = *appsPath[uLevel];
+        Node **ppsParent = appsPath[uLevel - 1];
+        Node *psParent = *ppsParent;
+        int iShift = (int)uLevel * BITS_PER_LEVEL;
+        int iParentShift = iShift - BITS_PER_LEVEL;
+        size_t uDataCount = SymTable_dataCount(psNode, iShift);
+        size_t uParentSlots = SymTable_slotCount(psParent, iParentShift);
+        uint32_t uBit = SymTable_bit(hash, iParentShift);
+        size_t uChildIndex = 2 * SymTable_bitCount(psParent->dataMap) +
+                             SymTable_bitCount(psParent->nodeMap & (uBit - 1));
+
+        if (psNode->nodeMap != 0 || uDataCount > 1) break;
+        if (uDataCount == 0) {
+            /* Drop the empty child */
+            memmove(&psParent->slots[uChildIndex],
+                    &psParent->slots[uChildIndex + 1],
+                    (uParentSlots - uChildIndex - 1) * sizeof(void *));
+            psParent->nodeMap &= ~uBit;
+            free(psNode);
+            SymTable_resizeNode(ppsParent, uParentSlots - 1);
+        } else {
+            /* Pull the only binding up in place of the child */
+            size_t uIndex;
+            if (!SymTable_resizeNode(ppsParent, uParentSlots + 1)) break;
+            psParent = *ppsParent;
+            memmove(&psParent->slots[uChildIndex],
+                    &psParent->slots[uChildIndex + 1],
+                    (uParentSlots - uChildIndex - 1) * sizeof(void *));
+            psParent->nodeMap &= ~uBit;
+            uIndex = 2 * SymTable_bitCount(psParent->dataMap & (uBit - 1));
+            memmove(&psParent->slots[uIndex + 2], &psParent->slots[uIndex],
+                    (uParentSlots - 1 - uIndex) * sizeof(void *));
+            psParent->slots[uIndex] = psNode->slots[0];
+            psParent->slots[uIndex + 1] = psNode->slots[1];
+            psParent->dataMap |= uBit;
+            free(psNode);
+        }
+    }
+}
+
+static void *SymTableHamt_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    Node **appsPath[MAX_DEPTH];
+    Node *psNode;
+    Key *psKey;
+    uint64_t hash;
+    size_t uDepth, uSlot, uSlotCount;
+    void *value;
+    int iShift;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_mixedHash(pcKey);
+    psNode = SymTable_descend(oSymTable, hash, &iShift);
+    uSlot = SymTable_findSlot(oSymTable, psNode, iShift, pcKey, hash);
+    uSlotCount = SymTable_slotCount(psNode, iShift);
+    if (uSlot == uSlotCount) return NULL;
+    uDepth = SymTable_unsharePath(oSymTable, hash, appsPath);
+    if (uDepth == 0) return NULL;
+    psNode = *appsPath[uDepth - 1];
+
+    psKey = (Key *)psNode->slots[uSlot];
+    value = psNode->slots[uSlot + 1];
+    if (iShift >= COLLISION_SHIFT) {
+        /* Fill the hole with the last binding */
+        psNode->slots[uSlot] = psNode->slots[uSlotCount - 2];
+        psNode->slots[uSlot + 1] = psNode->slots[uSlotCount - 1];
+        psNode->dataMap--;
+    } else {
+        memmove(&psNode->slots[uSlot], &psNode->slots[uSlot + 2],
+                (uSlotCount - uSlot - 2) * sizeof(void *));
+        psNode->dataMap &= ~SymTable_bit(hash, iShift);
+    }
+    SymTable_resizeNode(appsPath[uDepth - 1], uSlotCount - 2);
+    SymTable_releaseKey(psKey);
+    SymTable_compactPath(appsPath, uDepth, hash);
+    oSymTable->numBindings--;
+    return value;
+}
+
+/* Apply pfApply to each binding in psNode, which is at iShift, and its
+ * descendants. */
+static void SymTable_mapNode(const Node *psNode, int iShift,
+                             void (*pfApply)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra) {
+    size_t uDataCount = SymTable_dataCount(psNode, iShift);
+    size_t uSlotCount = SymTable_slotCount(psNode, iShift);
+    size_t i;
+    for (i = 0; i < uDataCount; i++)
+        (*pfApply)(SymTable_keyChars((const Key *)psNode->slots[2 * i]),
+                   psNode->slots[2 * i + 1], (void *)pvExtra);
+    for (i = 2 * uDataCount; i < uSlotCount; i++)
+        SymTable_mapNode((const Node *)psNode->slots[i],
+                         iShift + BITS_PER_LEVEL, pfApply, pvExtra);
+}
+
+static void SymTableHamt_map(SymTable_T oBase,
+                             void (*pfApply)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    SymTable_mapNode(oSymTable->root, 0, pfApply, pvExtra);
+}
+
+SymTable_T SymTableHamt_putVersion(SymTable_T oVersion, const char *pcKey,
+                                   const void *pvValue) {
+    SymTable_T oSymTable;
+    assert(oVersion != NULL);
+    assert(oVersion->backend == &SymTableHamt_backend);
+    assert(pcKey != NULL);
+
+    if (SymTableHamt_contains(oVersion, pcKey)) return NULL;
+    oSymTable = SymTableHamt_clone(oVersion);
+    if (oSymTable == NULL) return NULL;
+    if (!SymTableHamt_put(oSymTable, pcKey, pvValue)) {
+        SymTableHamt_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+SymTable_T SymTableHamt_replaceVersion(SymTable_T oVersion, const char *pcKey,
+                                       const void *pvValue) {
+    SymTable_T oSymTable;
+    assert(oVersion != NULL);
+    assert(oVersion->backend == &SymTableHamt_backend);
+    assert(pcKey != NULL);
+
+    if (!SymTableHamt_contains(oVersion, pcKey)) return NULL;
+    oSymTable = SymTableHamt_clone(oVersion);
+    if (oSymTable == NULL) return NULL;
+    /* The old value may be NULL, so check the new one to detect failure */
+    SymTableHamt_replace(oSymTable, pcKey, pvValue);
+    if (SymTableHamt_get(oSymTable, pcKey) != pvValue) {
+        SymTableHamt_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+SymTable_T SymTableHamt_removeVersion(SymTable_T oVersion, const char *pcKey) {
+    SymTableHamt_T oSymTable;
+    assert(oVersion != NULL);
+    assert(oVersion->backend == &SymTableHamt_backend);
+    assert(pcKey != NULL);
+
+    if (!SymTableHamt_contains(oVersion, pcKey)) return NULL;
+    oSymTable = (SymTableHamt_T)SymTableHamt_clone(oVersion);
+    if (oSymTable == NULL) return NULL;
+    SymTableHamt_remove(&oSymTable->base, pcKey);
+    if (oSymTable->numBindings == ((SymTableHamt_T)oVersion)->numBindings) {
+        SymTableHamt_free(&oSymTable->base);
+        return NULL;
+    }
+    return &oSymTable->base;
+}
+
+/* Report the bindings of psNode, which is at iShift, and of each of its
+ * descendants to SymTable_addChain as one chain per node. In builds with
+ * SYMTABLE_STATS defined, also add the size of the nodes and keys to the
+ * bytes allocated, counting shared ones in every table that reaches them. */
+static void SymTable_addNodeChains(const Node *psNode, int iShift,
+                                   struct SymTableStats *psStats) {
+    size_t uDataCount = SymTable_dataCount(psNode, iShift);
+    size_t uSlotCount = SymTable_slotCount(psNode, iShift);
+    size_t i;
+    SymTable_addChain(psStats, uDataCount);
+#ifdef SYMTABLE_STATS
+    psStats->bytesAllocated += sizeof(Node) + uSlotCount * sizeof(void *);
+    for (i = 0; i < uDataCount; i++)
+        psStats->bytesAllocated +=
+            sizeof(Key) +
+            strlen(SymTable_keyChars((const Key *)psNode->slots[2 * i])) + 1;
+#endif
+    for (i = 2 * uDataCount; i < uSlotCount; i++)
+        SymTable_addNodeChains((const Node *)psNode->slots[i],
+                               iShift + BITS_PER_LEVEL, psStats);
+}
+
+static void SymTableHamt_getStats(SymTable_T oBase,
+                                  struct SymTableStats *psStats) {
+    SymTableHamt_T oSymTable = (SymTableHamt_T)oBase;
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+#ifdef SYMTABLE_STATS
+    psStats->bytesAllocated += sizeof(struct SymTableHamt);
+#endif
+    SymTable_addNodeChains(oSymTable->root, 0, psStats);
+}
+
+/* The function table of the HAMT backend */
+const struct SymTableBackend SymTableHamt_backend = {
+    "hamt",
+    SymTableHamt_new,
+    SymTableHamt_free,
+    SymTableHamt_getLength,
+    SymTableHamt_put,
+    SymTableHamt_replace,
+    SymTableHamt_contains,
+    SymTableHamt_get,
+    SymTableHamt_remove,
+    SymTableHamt_map,
+    SymTableHamt_getStats,
+    SymTableHamt_clone,
+    NULL,
+    NULL};
@@ -0,0 +1,35 @@
+/*--------------------------------------------------------------------*/
+/* symtablehamt.h                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEHAMT_H
+#define SYMTABLEHAMT_H
+
+#include "symtable.h"
+
+/* Persistent operations on "hamt" SymTable objects. Each one leaves
+ * oVersion unchanged and returns a new version of it that differs by one
+ * binding. The new version shares all but O(log n) of its memory with
+ * oVersion, and both remain valid SymTable objects that must each be freed
+ * with SymTable_free. Versions of one table must be used by one thread at a
+ * time. */
+
+/* Return a new version of oVersion with an added binding consisting of key
+ * pcKey and value pvValue, or NULL if oVersion already contains a binding
+ * with key pcKey or insufficient memory is available. */
+SymTable_T SymTableHamt_putVersion(SymTable_T oVersion, const char *pcKey,
+                                   const void *pvValue);
+
+/* Return a new version of oVersion in which the value of the binding with
+ * key pcKey is pvValue, or NULL if oVersion contains no binding with key
+ * pcKey or insufficient memory is available. */
+SymTable_T SymTableHamt_replaceVersion(SymTable_T oVersion, const char *pcKey,
+                                       const void *pvValue);
+
+/* Return a new version of oVersion without the binding with key pcKey, or
+ * NULL if oVersion contains no binding with key pcKey or insufficient memory
+ * is available. */
+SymTable_T SymTableHamt_removeVersion(SymTable_T oVersion, const char *pcKey);
+
+#endif
@@ -3,77 +3,665 @@
 /* Author: Ishaan Javali                                              */
 /*--------------------------------------------------------------------*/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 
-#include "symtable.h"
+#include "symtablebackend.h"
+#include "symtablehash.h"
 
-/* Enum containing the initial bucket count */
-enum { BUCKET_COUNT = 509 };
+/* Enum containing the number of bindings a hash table and a hybrid table
+ * hold inline before they allocate any buckets, and the larger of the two */
+enum { INLINE_COUNT = 4, HYBRID_INLINE_COUNT = 8, MAX_INLINE_COUNT = 8 };
+/* Enum containing the chain length above which a bucket is sorted, and the
+ * length at or below which a sorted bucket becomes a chain again */
+enum { SORT_THRESHOLD = 8, UNSORT_THRESHOLD = 4 };
+/* Enum containing the filter bits per key it is sized for, the number of
+ * bits each key sets in its block, and the 64-bit words per block, so that
+ * a block is one 64-byte cache line */
+enum { FILTER_BITS_PER_KEY = 10, FILTER_PROBES = 4, FILTER_BLOCK_WORDS = 8 };
 /* Static array containing bucket sizes hash table can expand to */
 static const size_t auBucketCounts[] = {509,  1021,  2039,  4093,
                                         8191, 16381, 32749, 65521};
+/* Static array containing bucket sizes a hybrid table can expand to, which
+ * start small because it allocates them as soon as its inline array
+ * fills */
+static const size_t auHybridBucketCounts[] = {
+    17,      37,      67,      131,      257,      509,      1021,
+    2039,    4093,    8191,    16381,    32749,    65521,    131071,
+    262139,  524287,  1048573, 2097143,  4194301,  8388593,  16777213};
+
+/* A HashSchedule object describes how a table grows: how many bindings it
+ * holds inline, and the bucket counts it allocates and expands through. */
+struct HashSchedule {
+    /* Number of inline entries, at most MAX_INLINE_COUNT */
+    size_t inlineCount;
+    /* Bucket counts in increasing order, the first being the count the
+     * buckets are allocated with */
+    const size_t *bucketCounts;
+    /* Number of entries in bucketCounts */
+    size_t length;
+};
+
+/* The schedule of the hash backends */
+static const struct HashSchedule sHashSchedule = {
+    INLINE_COUNT, auBucketCounts,
+    sizeof(auBucketCounts) / sizeof(auBucketCounts[0])};
+/* The schedule of the hybrid backend */
+static const struct HashSchedule sHybridSchedule = {
+    HYBRID_INLINE_COUNT, auHybridBucketCounts,
+    sizeof(auHybridBucketCounts) / sizeof(auHybridBucketCounts[0])};
 
 /* shortened form for struct Binding */
 typedef struct Binding Binding;
 
-/* A Binding object consists of a unique key and value pair, and a pointer to
- * the next binding in the list. */
+/* A Binding object consists of a unique key and value pair, the hash of the
+ * key, and a pointer to the next binding in the list. */
 struct Binding {
-    /* Key for the binding */
+    /* Key for the binding, or NULL in the header of a SortedBucket */
     const char *key;
     /* Value associated with the key */
     void *value;
+    /* Hash of the key before reduction modulo the bucket count, so that
+     * expansion never has to rehash keys and most mismatches are rejected
+     * without a strcmp */
+    size_t hash;
     /* The next key-value pair in the bucket */
     struct Binding *next;
 };
 
-/* A SymTable object consists of an array of buckets (where each bucket
- * stores a linked list of key-value bindings), the number of bindings, and
- * the number of buckets in the table. */
-struct SymTable {
-    /* array of buckets containig bindings (key-value pairs) */
+/* shortened form for struct SortedBucket */
+typedef struct SortedBucket SortedBucket;
+
+/* A SortedBucket object replaces the chain of a bucket that grew longer than
+ * SORT_THRESHOLD bindings, so that a bucket full of colliding keys is
+ * searched in logarithmic rather than linear time. It holds the bindings in
+ * an array sorted by hash and then by key, and the bucket points to its
+ * header. */
+struct SortedBucket {
+    /* Header whose NULL key distinguishes a SortedBucket from a chain */
+    struct Binding header;
+    /* Array of the bindings in the bucket */
+    struct Binding **bindings;
+    /* Number of bindings in the bucket */
+    size_t count;
+    /* Number of bindings the array has room for */
+    size_t capacity;
+};
+
+/* shortened form for struct Entry */
+typedef struct Entry Entry;
+
+/* An Entry object is a key-value pair stored inline in a SymTable that has
+ * not allocated its buckets yet. */
+struct Entry {
+    /* Key for the binding */
+    const char *key;
+    /* Value associated with the key */
+    void *value;
+};
+
+/* A SymTableHash object consists of an array of buckets (where each bucket
+ * stores a linked list or a SortedBucket of key-value bindings), the number
+ * of bindings, the number of buckets in the table, and how the table hashes
+ * its keys. Until it holds more bindings than its schedule keeps inline, a
+ * table has no buckets and keeps its bindings in an inline array, so small
+ * tables avoid the bucket array entirely. */
+struct SymTableHash {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* array of buckets containig bindings (key-value pairs), or NULL while
+     * the bindings fit in the inline array */
     struct Binding **buckets;
     /* Numer of bindings in symbol table */
     size_t numBindings;
     /* Number of buckets in symbol table */
     size_t size;
+    /* How the table grows */
+    const struct HashSchedule *schedule;
+    /* Bitwise or of the SymTableHash_new flags */
+    unsigned int flags;
+    /* SipHash key of a SYMTABLEHASH_KEYED table */
+    uint64_t seed[2];
+    /* Blocks of the Bloom filter of a SYMTABLEHASH_FILTERED table, aligned
+     * to 64 bytes, or NULL while it has no buckets or if the filter could
+     * not be allocated */
+    uint64_t *filter;
+    /* The allocation that holds filter */
+    void *filterMemory;
+    /* Number of blocks of the filter, a power of two */
+    size_t filterBlocks;
+    /* Number of keys the filter was sized for */
+    size_t filterCapacity;
+    /* Number of keys removed since the filter was built, whose bits are
+     * stale */
+    size_t filterRemovals;
+    /* Bindings of a table without buckets, in no particular order, with
+     * room for schedule->inlineCount of them */
+    struct Entry inlineEntries[];
 };
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount) {
+/* shortened form for a pointer to struct SymTableHash */
+typedef struct SymTableHash *SymTableHash_T;
+
+/* Return uValue rotated left by iBits bits. */
+static uint64_t SymTable_rotate(uint64_t uValue, int iBits) {
+    return (uValue << iBits) | (uValue >> (64 - iBits));
+}
+
+/* Apply one SipRound to the SipHash state auState. */
+static void SymTable_sipRound(uint64_t auState[4]) {
+    auState[0] += auState[1];
+    auState[1] = SymTable_rotate(auState[1], 13) ^ auState[0];
+    auState[0] = SymTable_rotate(auState[0], 32);
+    auState[2] += auState[3];
+    auState[3] = SymTable_rotate(auState[3], 16) ^ auState[2];
+    auState[0] += auState[3];
+    auState[3] = SymTable_rotate(auState[3], 21) ^ auState[0];
+    auState[2] += auState[1];
+    auState[1] = SymTable_rotate(auState[1], 17) ^ auState[2];
+    auState[2] = SymTable_rotate(auState[2], 32);
+}
+
+uint64_t SymTableHash_sipHash(const uint64_t auSeed[2], const char *pcKey) {
+    const unsigned char *pucKey = (const unsigned char *)pcKey;
+    size_t uLength = strlen(pcKey);
+    size_t uTail = uLength % 8;
+    uint64_t auState[4];
+    uint64_t uBlock;
+    size_t i;
+    int j;
+
+    auState[0] = auSeed[0] ^ 0x736f6d6570736575ULL;
+    auState[1] = auSeed[1] ^ 0x646f72616e646f6dULL;
+    auState[2] = auSeed[0] ^ 0x6c7967656e657261ULL;
+    auState[3] = auSeed[1] ^ 0x7465646279746573ULL;
+
+    /* Each full block of 8 characters, read little-endian */
+    for (i = 0; i + 8 <= uLength; i += 8) {
+        uBlock = 0;
+        for (j = 7; j >= 0; j--) uBlock = (uBlock << 8) | pucKey[i + j];
+        auState[3] ^= uBlock;
+        SymTable_sipRound(auState);
+        auState[0] ^= uBlock;
+    }
+    /* The remaining characters, with the length in the top byte */
+    uBlock = (uint64_t)uLength << 56;
+    for (j = (int)uTail - 1; j >= 0; j--)
+        uBlock |= (uint64_t)pucKey[i + (size_t)j] << (8 * j);
+    auState[3] ^= uBlock;
+    SymTable_sipRound(auState);
+    auState[0] ^= uBlock;
+
+    auState[2] ^= 0xff;
+    SymTable_sipRound(auState);
+    SymTable_sipRound(auState);
+    SymTable_sipRound(auState);
+    return auState[0] ^ auState[1] ^ auState[2] ^ auState[3];
+}
+
+/* Return the hash code for pcKey in oSymTable, not yet reduced to a bucket
+   index. */
+static size_t SymTable_hash(SymTableHash_T oSymTable, const char *pcKey) {
     const size_t HASH_MULTIPLIER = 65599;
     size_t u;
     size_t uHash = 0;
 
     assert(pcKey != NULL);
 
+    if (oSymTable->flags & SYMTABLEHASH_KEYED)
+        return (size_t)SymTableHash_sipHash(oSymTable->seed, pcKey);
+
     for (u = 0; pcKey[u] != '\0'; u++)
         uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
 
-    return uHash % uBucketCount;
+    return uHash;
+}
+
+/* 128 bits read from /dev/urandom once per process, from which the keys of
+ * keyed tables derive */
+static uint64_t auProcessKey[2];
+
+/* Guards the one initialization of auProcessKey */
+static pthread_once_t sProcessKeyOnce = PTHREAD_ONCE_INIT;
+
+/* Number of keys handed out so far, updated atomically */
+static uint64_t uSeedCounter = 0;
+
+/* Fill auProcessKey from /dev/urandom, or from the clock and the process ID
+ * where it cannot be read. */
+static void SymTable_initProcessKey(void) {
+    FILE *psFile = fopen("/dev/urandom", "rb");
+    if (psFile == NULL ||
+        fread(auProcessKey, sizeof(auProcessKey), 1, psFile) != 1) {
+        auProcessKey[0] = (uint64_t)time(NULL) ^ (uint64_t)clock();
+        auProcessKey[1] = (uint64_t)getpid();
+    }
+    if (psFile != NULL) fclose(psFile);
+}
+
+/* Fill auSeed with a fresh SipHash key for oSymTable. The keys derive from
+ * auProcessKey, the address of oSymTable and a counter, so that two tables
+ * rarely share a key and no table reads /dev/urandom itself. Threads may
+ * create keyed tables concurrently. */
+static void SymTable_newSeed(SymTableHash_T oSymTable, uint64_t auSeed[2]) {
+    uint64_t uCount;
+
+    pthread_once(&sProcessKeyOnce, SymTable_initProcessKey);
+    uCount = __atomic_add_fetch(&uSeedCounter, 1, __ATOMIC_RELAXED);
+    auSeed[0] = SymTable_mix(auProcessKey[0] + uCount);
+    auSeed[1] = SymTable_mix(auProcessKey[1] ^ (uint64_t)(uintptr_t)oSymTable);
+}
+
+/* Return the index in oSymTable->inlineEntries of the entry whose key is
+ * pcKey, or oSymTable->numBindings if there is no such entry. oSymTable must
+ * not have buckets. */
+static size_t SymTable_findInline(SymTableHash_T oSymTable, const char *pcKey) {
+    size_t i;
+    for (i = 0; i < oSymTable->numBindings; i++)
+        if (SYMTABLE_STRCMP(&oSymTable->base, oSymTable->inlineEntries[i].key,
+                            pcKey) == 0)
+            return i;
+    return oSymTable->numBindings;
+}
+
+/* Return nonzero if binding, the first binding of a bucket, is the header of
+ * a SortedBucket rather than the first binding of a chain. */
+static int SymTable_isSorted(const Binding *binding) {
+    return binding != NULL && binding->key == NULL;
+}
+
+/* Return the filter block of oSymTable, which has a filter, for a key whose
+ * hash is hash, and store in *puBits the bits that choose its positions in
+ * the block. */
+static uint64_t *SymTable_filterBlock(SymTableHash_T oSymTable, size_t hash,
+                                      uint64_t *puBits) {
+    uint64_t uMixed = SymTable_mix((uint64_t)hash);
+    *puBits = uMixed;
+    return oSymTable->filter + FILTER_BLOCK_WORDS *
+                                   ((size_t)(uMixed >> 40) &
+                                    (oSymTable->filterBlocks - 1));
+}
+
+/* Set the bits of a key whose hash is hash in the filter of oSymTable, if
+ * it has one. */
+static void SymTable_filterAdd(SymTableHash_T oSymTable, size_t hash) {
+    uint64_t *puBlock;
+    uint64_t uBits;
+    int i;
+    if (oSymTable->filter == NULL) return;
+    puBlock = SymTable_filterBlock(oSymTable, hash, &uBits);
+    /* Each probe takes 9 bits: 3 for the word and 6 for the bit */
+    for (i = 0; i < FILTER_PROBES; i++, uBits >>= 9)
+        puBlock[(uBits >> 6) & (FILTER_BLOCK_WORDS - 1)] |=
+            (uint64_t)1 << (uBits & 63);
+}
+
+/* Return 0 if the filter of oSymTable shows that it holds no key whose hash
+ * is hash, or 1 if it may hold one or the table has no filter. */
+static int SymTable_filterMayContain(SymTableHash_T oSymTable, size_t hash) {
+    const uint64_t *puBlock;
+    uint64_t uBits;
+    int i;
+    if (oSymTable->filter == NULL) return 1;
+    puBlock = SymTable_filterBlock(oSymTable, hash, &uBits);
+    for (i = 0; i < FILTER_PROBES; i++, uBits >>= 9)
+        if (!(puBlock[(uBits >> 6) & (FILTER_BLOCK_WORDS - 1)] &
+              ((uint64_t)1 << (uBits & 63))))
+            return 0;
+    return 1;
+}
+
+/* Free the filter of oSymTable, if it has one. */
+static void SymTable_freeFilter(SymTableHash_T oSymTable) {
+    if (oSymTable->filter == NULL) return;
+    SYMTABLE_STATS_SUB(&oSymTable->base, bytesAllocated,
+                       oSymTable->filterBlocks * FILTER_BLOCK_WORDS *
+                               sizeof(uint64_t) +
+                           63);
+    free(oSymTable->filterMemory);
+    oSymTable->filter = NULL;
+    oSymTable->filterMemory = NULL;
+}
+
+/* Build a new filter for oSymTable, a SYMTABLEHASH_FILTERED table with
+ * buckets, sized for twice its bindings or its bucket count, whichever is
+ * more, from the cached hashes of its bindings. If insufficient memory is
+ * available the table goes without a filter until the next rebuild. */
+static void SymTable_rebuildFilter(SymTableHash_T oSymTable) {
+    size_t uCapacity = 2 * oSymTable->numBindings;
+    size_t uBlocks = 1;
+    size_t i;
+
+    SymTable_freeFilter(oSymTable);
+    if (uCapacity < oSymTable->size) uCapacity = oSymTable->size;
+    while (uBlocks * FILTER_BLOCK_WORDS * 64 < uCapacity * FILTER_BITS_PER_KEY)
+        uBlocks *= 2;
+    /* malloc promises less than the 64-byte alignment of a cache line */
+    oSymTable->filterMemory =
+        calloc(uBlocks * FILTER_BLOCK_WORDS * sizeof(uint64_t) + 63, 1);
+    oSymTable->filterRemovals = 0;
+    if (oSymTable->filterMemory == NULL) return;
+    SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                       uBlocks * FILTER_BLOCK_WORDS * sizeof(uint64_t) + 63);
+    oSymTable->filter =
+        (uint64_t *)(((uintptr_t)oSymTable->filterMemory + 63) &
+                     ~(uintptr_t)63);
+    oSymTable->filterBlocks = uBlocks;
+    oSymTable->filterCapacity = uCapacity;
+
+    for (i = 0; i < oSymTable->size; i++) {
+        const Binding *binding = oSymTable->buckets[i];
+        if (SymTable_isSorted(binding)) {
+            const SortedBucket *sorted = (const SortedBucket *)binding;
+            size_t j;
+            for (j = 0; j < sorted->count; j++)
+                SymTable_filterAdd(oSymTable, sorted->bindings[j]->hash);
+            continue;
+        }
+        for (; binding != NULL; binding = binding->next)
+            SymTable_filterAdd(oSymTable, binding->hash);
+    }
+}
+
+/* Return the number of bindings in the bucket whose first binding is
+ * binding, counting at most uLimit + 1 bindings of a chain. */
+static size_t SymTable_bucketLength(const Binding *binding, size_t uLimit) {
+    size_t uLength = 0;
+    if (SymTable_isSorted(binding))
+        return ((const SortedBucket *)binding)->count;
+    for (; binding != NULL && uLength <= uLimit; binding = binding->next)
+        uLength++;
+    return uLength;
+}
+
+/* Return the index in sorted->bindings of the binding whose hash is hash and
+ * whose key is pcKey and set *piFound to 1, or return the index at which
+ * such a binding would be inserted and set *piFound to 0. */
+static size_t SymTable_search(SymTableHash_T oSymTable,
+                              const SortedBucket *sorted, size_t hash,
+                              const char *pcKey, int *piFound) {
+    size_t uLow = 0, uHigh = sorted->count;
+    while (uLow < uHigh) {
+        size_t uMiddle = uLow + (uHigh - uLow) / 2;
+        const Binding *binding = sorted->bindings[uMiddle];
+        int iComparison;
+        if (binding->hash != hash)
+            iComparison = binding->hash < hash ? -1 : 1;
+        else
+            iComparison =
+                SYMTABLE_STRCMP(&oSymTable->base, binding->key, pcKey);
+        if (iComparison == 0) {
+            *piFound = 1;
+            return uMiddle;
+        }
+        if (iComparison < 0)
+            uLow = uMiddle + 1;
+        else
+            uHigh = uMiddle;
+    }
+    *piFound = 0;
+    return uLow;
+}
+
+/* Return the binding of oSymTable, which has buckets, whose key is pcKey and
+ * whose hash is hash, or NULL if there is no such binding. */
+static Binding *SymTable_findBinding(SymTableHash_T oSymTable,
+                                     const char *pcKey, size_t hash) {
+    Binding *binding = oSymTable->buckets[hash % oSymTable->size];
+    if (SymTable_isSorted(binding)) {
+        SortedBucket *sorted = (SortedBucket *)binding;
+        int iFound;
+        size_t uIndex =
+            SymTable_search(oSymTable, sorted, hash, pcKey, &iFound);
+        return iFound ? sorted->bindings[uIndex] : NULL;
+    }
+    for (; binding != NULL; binding = binding->next)
+        if (binding->hash == hash &&
+            SYMTABLE_STRCMP(&oSymTable->base, binding->key, pcKey) == 0)
+            return binding;
+    return NULL;
 }
 
-SymTable_T SymTable_new() {
-    SymTable_T symtable = (struct SymTable *)malloc(sizeof(struct SymTable));
+/* Compare the bindings that pvFirst and pvSecond point to by hash, then by
+ * key, for qsort. */
+static int SymTable_compareBindings(const void *pvFirst, const void *pvSecond) {
+    const Binding *first = *(const Binding *const *)pvFirst;
+    const Binding *second = *(const Binding *const *)pvSecond;
+    if (first->hash != second->hash) return first->hash < second->hash ? -1 : 1;
+    return strcmp(first->key, second->key);
+}
+
+/* Convert the chain in bucket uBucket of oSymTable into a SortedBucket. If
+ * insufficient memory is available the bucket stays a chain. */
+static void SymTable_sortBucket(SymTableHash_T oSymTable, size_t uBucket) {
+    size_t uCount = SymTable_bucketLength(oSymTable->buckets[uBucket],
+                                          oSymTable->numBindings);
+    size_t uCapacity = 2 * uCount;
+    SortedBucket *sorted = (SortedBucket *)malloc(sizeof(SortedBucket));
+    Binding **bindings = (Binding **)malloc(uCapacity * sizeof(Binding *));
+    Binding *binding;
+    size_t i = 0;
+
+    if (sorted == NULL || bindings == NULL) {
+        free(sorted);
+        free(bindings);
+        return;
+    }
+    for (binding = oSymTable->buckets[uBucket]; binding != NULL;
+         binding = binding->next)
+        bindings[i++] = binding;
+    qsort(bindings, uCount, sizeof(Binding *), SymTable_compareBindings);
+
+    sorted->header.key = NULL;
+    sorted->header.value = NULL;
+    sorted->header.hash = 0;
+    sorted->header.next = NULL;
+    sorted->bindings = bindings;
+    sorted->count = uCount;
+    sorted->capacity = uCapacity;
+    oSymTable->buckets[uBucket] = &sorted->header;
+    SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                       sizeof(SortedBucket) + uCapacity * sizeof(Binding *));
+}
+
+/* Convert the SortedBucket in bucket uBucket of oSymTable back into a
+ * chain. */
+static void SymTable_unsortBucket(SymTableHash_T oSymTable, size_t uBucket) {
+    SortedBucket *sorted = (SortedBucket *)oSymTable->buckets[uBucket];
+    Binding *first = NULL;
+    size_t i = sorted->count;
+    while (i > 0) {
+        sorted->bindings[--i]->next = first;
+        first = sorted->bindings[i];
+    }
+    oSymTable->buckets[uBucket] = first;
+    SYMTABLE_STATS_SUB(&oSymTable->base, bytesAllocated,
+                       sizeof(SortedBucket) +
+                           sorted->capacity * sizeof(Binding *));
+    free(sorted->bindings);
+    free(sorted);
+}
+
+/* Allocate the first bucket count of the schedule of oSymTable, which has
+ * no buckets, and move its inline entries into bindings without copying
+ * their keys. Returns 1 on success, or 0 and leaves oSymTable unchanged if
+ * insufficient memory is available. */
+static int SymTable_allocateBuckets(SymTableHash_T oSymTable) {
+    size_t uBucketCount = oSymTable->schedule->bucketCounts[0];
+    Binding *aNew[MAX_INLINE_COUNT];
+    Binding **buckets;
+    size_t i;
+#ifdef SYMTABLE_STATS
+    double dStart = SymTable_now();
+#endif
+
+    buckets = (Binding **)calloc(uBucketCount, sizeof(Binding *));
+    if (buckets == NULL) return 0;
+    for (i = 0; i < oSymTable->numBindings; i++) {
+        aNew[i] = (Binding *)malloc(sizeof(Binding));
+        if (aNew[i] == NULL) {
+            while (i > 0) free(aNew[--i]);
+            free(buckets);
+            return 0;
+        }
+    }
+    for (i = 0; i < oSymTable->numBindings; i++) {
+        size_t hash = SymTable_hash(oSymTable, oSymTable->inlineEntries[i].key);
+        aNew[i]->key = oSymTable->inlineEntries[i].key;
+        aNew[i]->value = oSymTable->inlineEntries[i].value;
+        aNew[i]->hash = hash;
+        aNew[i]->next = buckets[hash % uBucketCount];
+        buckets[hash % uBucketCount] = aNew[i];
+    }
+    oSymTable->buckets = buckets;
+    oSymTable->size = uBucketCount;
+    SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                       uBucketCount * sizeof(Binding *) +
+                           oSymTable->numBindings * sizeof(Binding));
+    if (oSymTable->flags & SYMTABLEHASH_FILTERED)
+        SymTable_rebuildFilter(oSymTable);
+#ifdef SYMTABLE_STATS
+    oSymTable->base.counters.resizeCount++;
+    oSymTable->base.counters.resizeNs += SymTable_now() - dStart;
+#endif
+    return 1;
+}
+
+/* Expand oSymTable, which has buckets and fewer than the maximum number of
+ * them, to the next bucket count of its schedule. Bindings are relinked
+ * into the new buckets by their cached hashes rather than copied, and every
+ * new bucket that is still too long is sorted again. If an expansion attempt
+ * fails because of insufficient memory, the table simply keeps its
+ * buckets. */
+static void SymTable_expand(SymTableHash_T oSymTable) {
+    /* i is the index in the schedule of the current bucket count, j is a
+     * counter variable for the buckets */
+    const size_t *auCounts = oSymTable->schedule->bucketCounts;
+    size_t i = 0, j;
+    size_t newSize;
+    Binding **newBuckets;
+#ifdef SYMTABLE_STATS
+    double dStart = SymTable_now();
+#endif
+
+    while (auCounts[i] != oSymTable->size) i++;
+    newSize = auCounts[i + 1];
+    newBuckets = (Binding **)calloc(newSize, sizeof(Binding *));
+    if (newBuckets == NULL) return;
+
+    /* Move each binding in the original buckets to its new bucket */
+    for (j = 0; j < oSymTable->size; j++) {
+        Binding *binding;
+        if (SymTable_isSorted(oSymTable->buckets[j]))
+            SymTable_unsortBucket(oSymTable, j);
+        binding = oSymTable->buckets[j];
+        while (binding != NULL) {
+            Binding *next = binding->next;
+            binding->next = newBuckets[binding->hash % newSize];
+            newBuckets[binding->hash % newSize] = binding;
+            binding = next;
+        }
+    }
+    free(oSymTable->buckets);
+    SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                       (newSize - oSymTable->size) * sizeof(Binding *));
+    oSymTable->buckets = newBuckets;
+    oSymTable->size = newSize;
+    for (j = 0; j < newSize; j++)
+        if (SymTable_bucketLength(newBuckets[j], SORT_THRESHOLD) >
+            SORT_THRESHOLD)
+            SymTable_sortBucket(oSymTable, j);
+    if (oSymTable->flags & SYMTABLEHASH_FILTERED)
+        SymTable_rebuildFilter(oSymTable);
+#ifdef SYMTABLE_STATS
+    oSymTable->base.counters.resizeCount++;
+    oSymTable->base.counters.resizeNs += SymTable_now() - dStart;
+#endif
+}
+
+/* Return a new table of backend *psBackend that contains no bindings,
+ * behaves as uFlags requests, and grows as *psSchedule says, or NULL if
+ * insufficient memory is available. */
+static SymTable_T SymTable_newTable(unsigned int uFlags,
+                                    const struct HashSchedule *psSchedule,
+                                    const struct SymTableBackend *psBackend) {
+    size_t uBytes = sizeof(struct SymTableHash) +
+                    psSchedule->inlineCount * sizeof(struct Entry);
+    SymTableHash_T symtable = (SymTableHash_T)malloc(uBytes);
     if (symtable == NULL) return NULL;
-    symtable->buckets = (Binding **)calloc(BUCKET_COUNT, sizeof(Binding *));
-    symtable->size = BUCKET_COUNT;
+    SymTable_initHeader(&symtable->base, psBackend);
+    SYMTABLE_STATS_ADD(&symtable->base, bytesAllocated, uBytes);
+    symtable->buckets = NULL;
+    symtable->size = 0;
     symtable->numBindings = 0;
-    return symtable;
+    symtable->schedule = psSchedule;
+    symtable->flags = uFlags;
+    symtable->seed[0] = symtable->seed[1] = 0;
+    if (uFlags & SYMTABLEHASH_KEYED) SymTable_newSeed(symtable, symtable->seed);
+    symtable->filter = NULL;
+    symtable->filterMemory = NULL;
+    symtable->filterBlocks = 0;
+    symtable->filterCapacity = 0;
+    symtable->filterRemovals = 0;
+    return &symtable->base;
+}
+
+SymTable_T SymTableHash_new(unsigned int uFlags) {
+    return SymTable_newTable(uFlags, &sHashSchedule,
+                             (uFlags & SYMTABLEHASH_KEYED)
+                                 ? &SymTableHashKeyed_backend
+                             : (uFlags & SYMTABLEHASH_FILTERED)
+                                 ? &SymTableHashFiltered_backend
+                                 : &SymTableHash_backend);
+}
+
+/* Return a new hash SymTable object that contains no bindings, or NULL if
+ * insufficient memory is available. */
+static SymTable_T SymTableHash_newDefault(void) { return SymTableHash_new(0); }
+
+/* Return a new keyed hash SymTable object that contains no bindings, or NULL
+ * if insufficient memory is available. */
+static SymTable_T SymTableHash_newKeyed(void) {
+    return SymTableHash_new(SYMTABLEHASH_KEYED);
+}
+
+/* Return a new filtered hash SymTable object that contains no bindings, or
+ * NULL if insufficient memory is available. */
+static SymTable_T SymTableHash_newFiltered(void) {
+    return SymTableHash_new(SYMTABLEHASH_FILTERED);
+}
+
+/* Return a new hybrid SymTable object that contains no bindings, or NULL if
+ * insufficient memory is available. */
+static SymTable_T SymTableHash_newHybrid(void) {
+    return SymTable_newTable(0, &sHybridSchedule, &SymTableHybrid_backend);
 }
 
-void SymTable_free(SymTable_T oSymTable) {
+static void SymTableHash_free(SymTable_T oBase) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
     size_t i = 0;
+    assert(oSymTable != NULL);
+    if (oSymTable->buckets == NULL) {
+        for (; i < oSymTable->numBindings; i++)
+            free((char *)oSymTable->inlineEntries[i].key);
+        free(oSymTable);
+        return;
+    }
     for (; i < oSymTable->size; i++) {
-        Binding *binding = oSymTable->buckets[i];
+        Binding *binding;
         Binding *next;
+        if (SymTable_isSorted(oSymTable->buckets[i]))
+            SymTable_unsortBucket(oSymTable, i);
+        binding = oSymTable->buckets[i];
         while (binding != NULL) {
             next = binding->next;
             free((char *)binding->key);
@@ -82,143 +670,186 @@ void SymTable_free(SymTable_T oSymTable) {
         }
     }
     free(oSymTable->buckets);
+    free(oSymTable->filterMemory);
     free(oSymTable);
 }
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    /* i is a counter variable keeping track of the index in auBucketCounts for
-     * the new bucket size (if relevant). j is a counter variable used in
-     * various loops */
-    size_t i = 0, j = 0;
-    size_t hash;
-    size_t length = sizeof(auBucketCounts) / sizeof(auBucketCounts[0]);
+static int SymTableHash_put(SymTable_T oBase, const char *pcKey,
+                            const void *pvValue) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    size_t hash, index, length;
+    size_t uPosition = 0;
+    size_t uChainLength = 0;
+    SortedBucket *sorted = NULL;
     Binding *binding, *prev, *newBinding;
-    SymTable_T tempSymTable;
 
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
 
-    /* Create a new binding and insert it at the end of the bucket */
-    hash = SymTable_hash(pcKey, oSymTable->size);
-    binding = oSymTable->buckets[hash];
+    if (oSymTable->buckets == NULL) {
+        char *key;
+        if (SymTable_findInline(oSymTable, pcKey) != oSymTable->numBindings)
+            return 0;
+        if (oSymTable->numBindings == oSymTable->schedule->inlineCount) {
+            /* The inline array is full: switch to buckets */
+            if (!SymTable_allocateBuckets(oSymTable)) return 0;
+        } else {
+            key = (char *)malloc(strlen(pcKey) + 1);
+            if (key == NULL) return 0;
+            strcpy(key, pcKey);
+            SYMTABLE_STATS_ADD(oBase, bytesAllocated, strlen(pcKey) + 1);
+            oSymTable->inlineEntries[oSymTable->numBindings].key = key;
+            oSymTable->inlineEntries[oSymTable->numBindings].value =
+                (void *)pvValue;
+            oSymTable->numBindings++;
+            return 1;
+        }
+    }
+
+    hash = SymTable_hash(oSymTable, pcKey);
+    index = hash % oSymTable->size;
+    binding = oSymTable->buckets[index];
     prev = binding;
-    while (binding != NULL) {
-        if (strcmp(binding->key, pcKey) == 0) return 0;
-        prev = binding;
-        binding = binding->next;
+    if (SymTable_isSorted(binding)) {
+        /* Find the insertion point, and make room for one more binding */
+        int iFound;
+        sorted = (SortedBucket *)binding;
+        uPosition = SymTable_search(oSymTable, sorted, hash, pcKey, &iFound);
+        if (iFound) return 0;
+        if (sorted->count == sorted->capacity) {
+            Binding **bindings = (Binding **)realloc(
+                sorted->bindings, 2 * sorted->capacity * sizeof(Binding *));
+            if (bindings == NULL) return 0;
+            SYMTABLE_STATS_ADD(oBase, bytesAllocated,
+                               sorted->capacity * sizeof(Binding *));
+            sorted->bindings = bindings;
+            sorted->capacity *= 2;
+        }
+    } else {
+        while (binding != NULL) {
+            if (binding->hash == hash &&
+                SYMTABLE_STRCMP(oBase, binding->key, pcKey) == 0)
+                return 0;
+            prev = binding;
+            binding = binding->next;
+            uChainLength++;
+        }
     }
+
+    /* Create a new binding */
     newBinding = (Binding *)malloc(sizeof(Binding));
     if (newBinding == NULL) return 0;
 
     newBinding->key = (const char *)malloc(strlen(pcKey) + 1);
-    if (newBinding->key == NULL) return 0;
+    if (newBinding->key == NULL) {
+        free(newBinding);
+        return 0;
+    }
     strcpy((char *)newBinding->key, pcKey);
+    SYMTABLE_STATS_ADD(oBase, bytesAllocated,
+                       sizeof(Binding) + strlen(pcKey) + 1);
     newBinding->value = (void *)pvValue;
+    newBinding->hash = hash;
     newBinding->next = NULL;
-
     oSymTable->numBindings++;
-    if (prev == binding) { /* the bucket is empty */
-        oSymTable->buckets[hash] = newBinding;
+    SymTable_filterAdd(oSymTable, hash);
+
+    if (sorted != NULL) {
+        /* Insert it into the sorted bucket at its position */
+        memmove(&sorted->bindings[uPosition + 1], &sorted->bindings[uPosition],
+                (sorted->count - uPosition) * sizeof(Binding *));
+        sorted->bindings[uPosition] = newBinding;
+        sorted->count++;
     } else {
-        prev->next = newBinding;
+        /* Insert it at the end of the chain, and sort a chain that has
+         * become too long */
+        if (prev == binding) { /* the bucket is empty */
+            oSymTable->buckets[index] = newBinding;
+        } else {
+            prev->next = newBinding;
+        }
+        if (uChainLength + 1 > SORT_THRESHOLD)
+            SymTable_sortBucket(oSymTable, index);
     }
 
     /* Check if the hash table should and can be expanded. */
+    length = oSymTable->schedule->length;
     if (!(oSymTable->numBindings >= oSymTable->size &&
-          oSymTable->size != auBucketCounts[length - 1]))
+          oSymTable->size != oSymTable->schedule->bucketCounts[length - 1])) {
+        /* A table at its largest bucket count still outgrows its filter */
+        if (oSymTable->filter != NULL &&
+            oSymTable->numBindings > oSymTable->filterCapacity)
+            SymTable_rebuildFilter(oSymTable);
         return 1;
+    }
 
     /* Uncomment below to use non-expanding hash table implementation. */
     /* if(1) return 1; */
 
-    /* Expand hash table and increase the of buckets if we're not already at the
-     * maximum size and if the number of bindings equals the number of buckets.
-     */
-    /* Find how many buckets the expanded table should have */
-    for (; i < length - 1; i++)
-        if (oSymTable->numBindings == auBucketCounts[i]) break;
-
-    tempSymTable = (struct SymTable *)malloc(sizeof(struct SymTable));
-
-    /* If an expansion attempt fails because of insufficient memory,
-     * simply proceed with the execution of SymTable_put. */
-    if (tempSymTable == NULL) return 1;
-    tempSymTable->buckets =
-        (Binding **)calloc(auBucketCounts[i + 1], sizeof(Binding *));
-    tempSymTable->numBindings = 0;
-    tempSymTable->size = auBucketCounts[i + 1];
-
-    /* For each binding in the original hash table, recalculate the
-     * hashes for the keys using the larger bucket size, and add the
-     * binding to the new hash table */
-    for (j = 0; j < oSymTable->size; j++) {
-        Binding *binding = oSymTable->buckets[j];
-        while (binding != NULL) {
-            int res = SymTable_put(tempSymTable, binding->key, binding->value);
-            if (res == 0) return 1;
-            binding = binding->next;
-        }
-    }
-    /* Free the buckets and bindings from the original hash table. Point to the
-     * new array of expanded buckets */
-    j = 0;
-    for (; j < oSymTable->size; j++) {
-        Binding *binding = oSymTable->buckets[j];
-        Binding *next;
-        while (binding != NULL) {
-            next = binding->next;
-            free((char *)binding->key);
-            free(binding);
-            binding = next;
-        }
-    }
-    free(oSymTable->buckets);
-    oSymTable->buckets = tempSymTable->buckets;
-    free(tempSymTable);
-    oSymTable->size = auBucketCounts[i + 1];
+    SymTable_expand(oSymTable);
     return 1;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash = SymTable_hash(pcKey, oSymTable->size);
+static void *SymTableHash_get(SymTable_T oBase, const char *pcKey) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
     Binding *binding;
+    size_t hash;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    binding = oSymTable->buckets[hash];
-    while (binding != NULL) {
-        if (strcmp(binding->key, pcKey) == 0) return binding->value;
-        binding = binding->next;
+    if (oSymTable->buckets == NULL) {
+        size_t i = SymTable_findInline(oSymTable, pcKey);
+        if (i == oSymTable->numBindings) return NULL;
+        return oSymTable->inlineEntries[i].value;
     }
-    return NULL;
+    hash = SymTable_hash(oSymTable, pcKey);
+    if (!SymTable_filterMayContain(oSymTable, hash)) return NULL;
+    binding = SymTable_findBinding(oSymTable, pcKey, hash);
+    if (binding == NULL) return NULL;
+    return binding->value;
 }
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash = SymTable_hash(pcKey, oSymTable->size);
-    Binding *binding;
+static int SymTableHash_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    size_t hash;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    binding = oSymTable->buckets[hash];
-    while (binding != NULL) {
-        if (strcmp(binding->key, pcKey) == 0) return 1;
-        binding = binding->next;
-    }
-    return 0;
+    if (oSymTable->buckets == NULL)
+        return SymTable_findInline(oSymTable, pcKey) != oSymTable->numBindings;
+    hash = SymTable_hash(oSymTable, pcKey);
+    if (!SymTable_filterMayContain(oSymTable, hash)) return 0;
+    return SymTable_findBinding(oSymTable, pcKey, hash) != NULL;
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
+static size_t SymTableHash_getLength(SymTable_T oBase) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
     assert(oSymTable != NULL);
     return oSymTable->numBindings;
 }
 
-void SymTable_map(SymTable_T oSymTable,
-                  void (*pfApply)(const char *pcKey, void *pvValue,
-                                  void *pvExtra),
-                  const void *pvExtra) {
+static void SymTableHash_map(SymTable_T oBase,
+                             void (*pfApply)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
     size_t i = 0;
     assert(oSymTable != NULL);
     assert(pfApply != NULL);
+    if (oSymTable->buckets == NULL) {
+        for (; i < oSymTable->numBindings; i++)
+            (*pfApply)(oSymTable->inlineEntries[i].key,
+                       oSymTable->inlineEntries[i].value, (void *)pvExtra);
+        return;
+    }
     for (; i < oSymTable->size; i++) {
         Binding *binding = oSymTable->buckets[i];
+        if (SymTable_isSorted(binding)) {
+            SortedBucket *sorted = (SortedBucket *)binding;
+            size_t j;
+            for (j = 0; j < sorted->count; j++)
+                (*pfApply)(sorted->bindings[j]->key, sorted->bindings[j]->value,
+                           (void *)pvExtra);
+            continue;
+        }
         while (binding != NULL) {
             (*pfApply)(binding->key, binding->value, (void *)pvExtra);
             binding = binding->next;
@@ -226,50 +857,395 @@ void SymTable_map(SymTable_T oSymTable,
     }
 }
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
-                       const void *pvValue) {
-    size_t hash = SymTable_hash(pcKey, oSymTable->size);
+static void *SymTableHash_replace(SymTable_T oBase, const char *pcKey,
+                                  const void *pvValue) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
     Binding *binding;
+    void *oldValue;
+    size_t hash;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    binding = oSymTable->buckets[hash];
-    while (binding != NULL) {
-        if (strcmp(binding->key, pcKey) == 0) {
-            void *oldValue = binding->value;
-            binding->value = (void *)pvValue;
-            return oldValue;
-        }
-        binding = binding->next;
+    if (oSymTable->buckets == NULL) {
+        size_t i = SymTable_findInline(oSymTable, pcKey);
+        if (i == oSymTable->numBindings) return NULL;
+        oldValue = oSymTable->inlineEntries[i].value;
+        oSymTable->inlineEntries[i].value = (void *)pvValue;
+        return oldValue;
     }
-    return NULL;
+    hash = SymTable_hash(oSymTable, pcKey);
+    if (!SymTable_filterMayContain(oSymTable, hash)) return NULL;
+    binding = SymTable_findBinding(oSymTable, pcKey, hash);
+    if (binding == NULL) return NULL;
+    oldValue = binding->value;
+    binding->value = (void *)pvValue;
+    return oldValue;
+}
+
+/* Free binding, which has been unlinked from oSymTable, and return its
+ * value. */
+static void *SymTable_freeBinding(SymTableHash_T oSymTable, Binding *binding) {
+    void *value = binding->value;
+    oSymTable->numBindings--;
+    /* The bits of removed keys stay set until the filter is rebuilt */
+    if (oSymTable->filter != NULL &&
+        ++oSymTable->filterRemovals > oSymTable->filterCapacity / 2)
+        SymTable_rebuildFilter(oSymTable);
+    SYMTABLE_STATS_SUB(&oSymTable->base, bytesAllocated,
+                       sizeof(Binding) + strlen(binding->key) + 1);
+    free((char *)binding->key);
+    free(binding);
+    return value;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash = SymTable_hash(pcKey, oSymTable->size);
+static void *SymTableHash_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    size_t hash, index;
     Binding *binding, *prev;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    binding = oSymTable->buckets[hash];
+    if (oSymTable->buckets == NULL) {
+        size_t i = SymTable_findInline(oSymTable, pcKey);
+        void *value;
+        if (i == oSymTable->numBindings) return NULL;
+        value = oSymTable->inlineEntries[i].value;
+        SYMTABLE_STATS_SUB(oBase, bytesAllocated,
+                           strlen(oSymTable->inlineEntries[i].key) + 1);
+        free((char *)oSymTable->inlineEntries[i].key);
+        /* Fill the hole with the last entry */
+        oSymTable->numBindings--;
+        oSymTable->inlineEntries[i] =
+            oSymTable->inlineEntries[oSymTable->numBindings];
+        return value;
+    }
+    hash = SymTable_hash(oSymTable, pcKey);
+    if (!SymTable_filterMayContain(oSymTable, hash)) return NULL;
+    index = hash % oSymTable->size;
+    binding = oSymTable->buckets[index];
+    if (SymTable_isSorted(binding)) {
+        /* Close the gap, and turn a bucket that has become short back into
+         * a chain */
+        SortedBucket *sorted = (SortedBucket *)binding;
+        int iFound;
+        size_t uPosition =
+            SymTable_search(oSymTable, sorted, hash, pcKey, &iFound);
+        if (!iFound) return NULL;
+        binding = sorted->bindings[uPosition];
+        sorted->count--;
+        memmove(&sorted->bindings[uPosition], &sorted->bindings[uPosition + 1],
+                (sorted->count - uPosition) * sizeof(Binding *));
+        if (sorted->count <= UNSORT_THRESHOLD)
+            SymTable_unsortBucket(oSymTable, index);
+        return SymTable_freeBinding(oSymTable, binding);
+    }
     prev = binding;
     /* go through the bindings in the bucket with the corresponding hash. change
      * the pointer for the previous binding (if it exists) */
     while (binding != NULL) {
-        if (strcmp(binding->key, pcKey) == 0) {
-            Binding *next = binding->next;
-            void *value;
+        if (binding->hash == hash &&
+            SYMTABLE_STRCMP(oBase, binding->key, pcKey) == 0) {
             if (prev == binding) {
-                oSymTable->buckets[hash] = next;
+                oSymTable->buckets[index] = binding->next;
             } else {
-                prev->next = next;
+                prev->next = binding->next;
             }
-            value = binding->value;
-            oSymTable->numBindings--;
-            free((char *)binding->key);
-            free(binding);
-            return value;
+            return SymTable_freeBinding(oSymTable, binding);
         }
         prev = binding;
         binding = binding->next;
     }
     return NULL;
 }
+
+static void SymTableHash_getStats(SymTable_T oBase,
+                                  struct SymTableStats *psStats) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+    if (oSymTable->buckets == NULL) {
+        /* The inline array is a single chain */
+        SymTable_addChain(psStats, oSymTable->numBindings);
+        return;
+    }
+    for (i = 0; i < oSymTable->size; i++)
+        SymTable_addChain(psStats,
+                          SymTable_bucketLength(oSymTable->buckets[i],
+                                                oSymTable->numBindings));
+}
+
+static int SymTableHash_reserve(SymTable_T oBase, size_t uCount) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    size_t length;
+    size_t oldSize;
+    assert(oSymTable != NULL);
+    length = oSymTable->schedule->length;
+    if (oSymTable->buckets == NULL) {
+        if (uCount <= oSymTable->schedule->inlineCount) return 1;
+        if (!SymTable_allocateBuckets(oSymTable)) return 0;
+    }
+    /* put expands once the bindings outnumber the buckets */
+    while (oSymTable->size < uCount &&
+           oSymTable->size != oSymTable->schedule->bucketCounts[length - 1]) {
+        oldSize = oSymTable->size;
+        SymTable_expand(oSymTable);
+        if (oSymTable->size == oldSize) return 0;
+    }
+    return 1;
+}
+
+/* The state of a SymTableHash_clone */
+struct HashClone {
+    /* The clone */
+    SymTable_T clone;
+    /* 0 once a put into the clone has failed, 1 until then */
+    int ok;
+};
+
+/* Bind pcKey to pvValue in the clone of the HashClone pvExtra. */
+static void SymTable_putClone(const char *pcKey, void *pvValue,
+                              void *pvExtra) {
+    struct HashClone *psClone = (struct HashClone *)pvExtra;
+    if (psClone->ok && !SymTableHash_put(psClone->clone, pcKey, pvValue))
+        psClone->ok = 0;
+}
+
+/* Return a copy of oBase with the same flags and schedule, which the
+ * generic clone through pfNew would not keep for a keyed filtered table, or
+ * NULL if insufficient memory is available. */
+static SymTable_T SymTableHash_clone(SymTable_T oBase) {
+    SymTableHash_T oSymTable = (SymTableHash_T)oBase;
+    struct HashClone sClone;
+    assert(oSymTable != NULL);
+    sClone.clone = SymTable_newTable(oSymTable->flags, oSymTable->schedule,
+                                     oBase->backend);
+    if (sClone.clone == NULL) return NULL;
+    sClone.ok = SymTableHash_reserve(sClone.clone, oSymTable->numBindings);
+    if (sClone.ok) SymTableHash_map(oBase, SymTable_putClone, &sClone);
+    if (!sClone.ok) {
+        SymTableHash_free(sClone.clone);
+        return NULL;
+    }
+    return sClone.clone;
+}
+
+/* Link binding, whose key oSymTable does not contain and whose hash is its
+ * hash in oSymTable, into its bucket of oSymTable, which has buckets.
+ * Returns 1, or 0 and leaves oSymTable unchanged if insufficient memory is
+ * available. */
+static int SymTable_linkBinding(SymTableHash_T oSymTable, Binding *binding) {
+    size_t index = binding->hash % oSymTable->size;
+    Binding *first = oSymTable->buckets[index];
+    if (SymTable_isSorted(first)) {
+        SortedBucket *sorted = (SortedBucket *)first;
+        int iFound;
+        size_t uPosition = SymTable_search(oSymTable, sorted, binding->hash,
+                                           binding->key, &iFound);
+        assert(!iFound);
+        if (sorted->count == sorted->capacity) {
+            Binding **bindings = (Binding **)realloc(
+                sorted->bindings, 2 * sorted->capacity * sizeof(Binding *));
+            if (bindings == NULL) return 0;
+            SYMTABLE_STATS_ADD(&oSymTable->base, bytesAllocated,
+                               sorted->capacity * sizeof(Binding *));
+            sorted->bindings = bindings;
+            sorted->capacity *= 2;
+        }
+        memmove(&sorted->bindings[uPosition + 1], &sorted->bindings[uPosition],
+                (sorted->count - uPosition) * sizeof(Binding *));
+        sorted->bindings[uPosition] = binding;
+        sorted->count++;
+    } else {
+        binding->next = first;
+        oSymTable->buckets[index] = binding;
+        if (SymTable_bucketLength(binding, SORT_THRESHOLD) > SORT_THRESHOLD)
+            SymTable_sortBucket(oSymTable, index);
+    }
+    oSymTable->numBindings++;
+    SymTable_filterAdd(oSymTable, binding->hash);
+    return 1;
+}
+
+/* Move the inline entries of oSrc, which has no buckets, into oDst, which
+ * has buckets, as SymTableHash_merge does. Each moved entry gets a new
+ * binding, but its key is not copied. Returns 1, or 0 if insufficient
+ * memory was available to move every entry. */
+static int SymTable_mergeInline(SymTableHash_T oDst, SymTableHash_T oSrc,
+                                int iKeepSrc) {
+    int iSuccessful = 1;
+    size_t i = 0;
+    while (i < oSrc->numBindings) {
+        struct Entry *psEntry = &oSrc->inlineEntries[i];
+        size_t hash = SymTable_hash(oDst, psEntry->key);
+        Binding *found = SymTable_findBinding(oDst, psEntry->key, hash);
+        Binding *binding;
+        if (found != NULL) {
+            if (iKeepSrc) {
+                void *value = found->value;
+                found->value = psEntry->value;
+                psEntry->value = value;
+            }
+            i++;
+            continue;
+        }
+        binding = (Binding *)malloc(sizeof(Binding));
+        if (binding != NULL) {
+            binding->key = psEntry->key;
+            binding->value = psEntry->value;
+            binding->hash = hash;
+            binding->next = NULL;
+        }
+        if (binding == NULL || !SymTable_linkBinding(oDst, binding)) {
+            free(binding);
+            iSuccessful = 0;
+            i++;
+            continue;
+        }
+        SYMTABLE_STATS_ADD(&oDst->base, bytesAllocated,
+                           sizeof(Binding) + strlen(binding->key) + 1);
+        SYMTABLE_STATS_SUB(&oSrc->base, bytesAllocated,
+                           strlen(binding->key) + 1);
+        /* Fill the hole with the last entry */
+        oSrc->numBindings--;
+        *psEntry = oSrc->inlineEntries[oSrc->numBindings];
+    }
+    return iSuccessful;
+}
+
+/* Move the bindings of oSrcBase into oDstBase by relinking them, so that no
+ * key is copied, and no key is rehashed unless either table is keyed. */
+static int SymTableHash_merge(SymTable_T oDstBase, SymTable_T oSrcBase,
+                              int iKeepSrc) {
+    SymTableHash_T oDst = (SymTableHash_T)oDstBase;
+    SymTableHash_T oSrc = (SymTableHash_T)oSrcBase;
+    int iRehash = ((oDst->flags | oSrc->flags) & SYMTABLEHASH_KEYED) != 0;
+    int iSuccessful = 1;
+    size_t i;
+    assert(oDst != NULL);
+    assert(oSrc != NULL);
+
+    if (oSrc->numBindings == 0) return 1;
+    /* Expand once up front rather than along the way */
+    SymTableHash_reserve(oDstBase, oDst->numBindings + oSrc->numBindings);
+    if (oDst->buckets == NULL && !SymTable_allocateBuckets(oDst)) return 0;
+    if (oSrc->buckets == NULL)
+        return SymTable_mergeInline(oDst, oSrc, iKeepSrc);
+
+    for (i = 0; i < oSrc->size; i++) {
+        Binding *binding, *next;
+        /* The bindings that stay in the bucket */
+        Binding *kept = NULL;
+        size_t uKept = 0;
+        if (SymTable_isSorted(oSrc->buckets[i]))
+            SymTable_unsortBucket(oSrc, i);
+        for (binding = oSrc->buckets[i]; binding != NULL; binding = next) {
+            size_t hash =
+                iRehash ? SymTable_hash(oDst, binding->key) : binding->hash;
+            size_t srcHash = binding->hash;
+            Binding *found = NULL;
+            next = binding->next;
+            if (SymTable_filterMayContain(oDst, hash))
+                found = SymTable_findBinding(oDst, binding->key, hash);
+            if (found == NULL) {
+                binding->hash = hash;
+                if (SymTable_linkBinding(oDst, binding)) {
+                    SYMTABLE_STATS_ADD(oDstBase, bytesAllocated,
+                                       sizeof(Binding) +
+                                           strlen(binding->key) + 1);
+                    SYMTABLE_STATS_SUB(oSrcBase, bytesAllocated,
+                                       sizeof(Binding) +
+                                           strlen(binding->key) + 1);
+                    oSrc->numBindings--;
+                    continue;
+                }
+                binding->hash = srcHash;
+                iSuccessful = 0;
+            } else if (iKeepSrc) {
+                void *value = found->value;
+                found->value = binding->value;
+                binding->value = value;
+            }
+            binding->next = kept;
+            kept = binding;
+            uKept++;
+        }
+        oSrc->buckets[i] = kept;
+        if (uKept > SORT_THRESHOLD) SymTable_sortBucket(oSrc, i);
+    }
+
+    /* Clear the bits of the keys that left oSrc, and make room in the filter
+     * of oDst for the keys that arrived */
+    if (oSrc->flags & SYMTABLEHASH_FILTERED) SymTable_rebuildFilter(oSrc);
+    if (oDst->filter != NULL && oDst->numBindings > oDst->filterCapacity)
+        SymTable_rebuildFilter(oDst);
+    return iSuccessful;
+}
+
+/* The function table of the hash backend */
+const struct SymTableBackend SymTableHash_backend = {
+    "hash",
+    SymTableHash_newDefault,
+    SymTableHash_free,
+    SymTableHash_getLength,
+    SymTableHash_put,
+    SymTableHash_replace,
+    SymTableHash_contains,
+    SymTableHash_get,
+    SymTableHash_remove,
+    SymTableHash_map,
+    SymTableHash_getStats,
+    SymTableHash_clone,
+    SymTableHash_reserve,
+    SymTableHash_merge};
+
+/* The function table of the hash backend with keyed hashing */
+const struct SymTableBackend SymTableHashKeyed_backend = {
+    "hash-keyed",
+    SymTableHash_newKeyed,
+    SymTableHash_free,
+    SymTableHash_getLength,
+    SymTableHash_put,
+    SymTableHash_replace,
+    SymTableHash_contains,
+    SymTableHash_get,
+    SymTableHash_remove,
+    SymTableHash_map,
+    SymTableHash_getStats,
+    SymTableHash_clone,
+    SymTableHash_reserve,
+    SymTableHash_merge};
+
+/* The function table of the hash backend with a filter in front of the
+ * buckets */
+const struct SymTableBackend SymTableHashFiltered_backend = {
+    "hash-filtered",
+    SymTableHash_newFiltered,
+    SymTableHash_free,
+    SymTableHash_getLength,
+    SymTableHash_put,
+    SymTableHash_replace,
+    SymTableHash_contains,
+    SymTableHash_get,
+    SymTableHash_remove,
+    SymTableHash_map,
+    SymTableHash_getStats,
+    SymTableHash_clone,
+    SymTableHash_reserve,
+    SymTableHash_merge};
+
+/* The function table of the hybrid backend: a hash table that holds more
+ * bindings inline and starts with fewer buckets */
+const struct SymTableBackend SymTableHybrid_backend = {
+    "hybrid",
+    SymTableHash_newHybrid,
+    SymTableHash_free,
+    SymTableHash_getLength,
+    SymTableHash_put,
+    SymTableHash_replace,
+    SymTableHash_contains,
+    SymTableHash_get,
+    SymTableHash_remove,
+    SymTableHash_map,
+    SymTableHash_getStats,
+    SymTableHash_clone,
+    SymTableHash_reserve,
+    SymTableHash_merge};
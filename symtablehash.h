@@ -0,0 +1,40 @@
+/*--------------------------------------------------------------------*/
+/* symtablehash.h                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEHASH_H
+#define SYMTABLEHASH_H
+
+#include <stdint.h>
+
+#include "symtable.h"
+
+/* Flags for SymTableHash_new. SYMTABLEHASH_KEYED hashes keys with SipHash-1-3
+ * under a random per-table seed instead of the fixed 65599 polynomial, so
+ * that whoever chooses the keys cannot predict which of them collide.
+ * SYMTABLEHASH_FILTERED keeps a blocked Bloom filter of the keys beside the
+ * buckets and consults it before a bucket, so that most lookups of absent
+ * keys touch one cache line of the filter instead of walking a chain. The
+ * filter is rebuilt when the table expands, when it holds more keys than it
+ * was sized for, and after enough removals to leave many stale bits. */
+enum { SYMTABLEHASH_KEYED = 1, SYMTABLEHASH_FILTERED = 2 };
+
+/* Return a new hash SymTable object that contains no bindings and behaves as
+ * uFlags, a bitwise or of the flags above, requests, or NULL if insufficient
+ * memory is available. SymTable_newWithBackend("hash") is equivalent to
+ * SymTableHash_new(0), SymTable_newWithBackend("hash-keyed") to
+ * SymTableHash_new(SYMTABLEHASH_KEYED), and
+ * SymTable_newWithBackend("hash-filtered") to
+ * SymTableHash_new(SYMTABLEHASH_FILTERED). SymTable_newWithBackend("hybrid")
+ * returns a table of the same implementation that holds 8 rather than 4
+ * bindings before it allocates buckets, and allocates 17 rather than 509. */
+SymTable_T SymTableHash_new(unsigned int uFlags);
+
+/* Return the SipHash-1-3 of the characters of pcKey, without its null
+ * terminator, under the 128-bit key whose first 8 bytes are auSeed[0] and
+ * last 8 bytes auSeed[1], each read little-endian. SYMTABLEHASH_KEYED
+ * tables hash their keys with it. */
+uint64_t SymTableHash_sipHash(const uint64_t auSeed[2], const char *pcKey);
+
+#endif
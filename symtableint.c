@@ -0,0 +1,99 @@
+/*--------------------------------------------------------------------*/
+/* symtableint.c                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "symtableint.h"
+
+/* IntTable, the table that maps int64_t keys to void * values */
+#define SYMTABLE_TEMPLATE_NAME IntTable
+#define SYMTABLE_TEMPLATE_KEY int64_t
+#define SYMTABLE_TEMPLATE_VALUE void *
+#define SYMTABLE_TEMPLATE_HASH SymTableTemplate_hashInt
+#define SYMTABLE_TEMPLATE_EQUAL SymTableTemplate_equal
+#include "symtabletemplate.h"
+
+/* A SymTableInt object is an IntTable. */
+struct SymTableInt {
+    /* The bindings */
+    IntTable table;
+};
+
+SymTableInt_T SymTableInt_new(void) {
+    SymTableInt_T oSymTableInt =
+        (SymTableInt_T)malloc(sizeof(struct SymTableInt));
+    if (oSymTableInt == NULL) return NULL;
+    if (!IntTable_init(&oSymTableInt->table)) {
+        free(oSymTableInt);
+        return NULL;
+    }
+    return oSymTableInt;
+}
+
+void SymTableInt_free(SymTableInt_T oSymTableInt) {
+    assert(oSymTableInt != NULL);
+    IntTable_destroy(&oSymTableInt->table);
+    free(oSymTableInt);
+}
+
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt) {
+    assert(oSymTableInt != NULL);
+    return IntTable_getLength(&oSymTableInt->table);
+}
+
+int SymTableInt_reserve(SymTableInt_T oSymTableInt, size_t uCount) {
+    assert(oSymTableInt != NULL);
+    return IntTable_reserve(&oSymTableInt->table, uCount);
+}
+
+int SymTableInt_put(SymTableInt_T oSymTableInt, int64_t iKey,
+                    const void *pvValue) {
+    assert(oSymTableInt != NULL);
+    return IntTable_put(&oSymTableInt->table, iKey, (void *)pvValue);
+}
+
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, int64_t iKey,
+                          const void *pvValue) {
+    void *pvOldValue;
+    assert(oSymTableInt != NULL);
+    if (!IntTable_replace(&oSymTableInt->table, iKey, (void *)pvValue,
+                          &pvOldValue))
+        return NULL;
+    return pvOldValue;
+}
+
+int SymTableInt_contains(SymTableInt_T oSymTableInt, int64_t iKey) {
+    assert(oSymTableInt != NULL);
+    return IntTable_contains(&oSymTableInt->table, iKey);
+}
+
+void *SymTableInt_get(SymTableInt_T oSymTableInt, int64_t iKey) {
+    void *pvValue;
+    assert(oSymTableInt != NULL);
+    if (!IntTable_get(&oSymTableInt->table, iKey, &pvValue)) return NULL;
+    return pvValue;
+}
+
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, int64_t iKey) {
+    void *pvValue;
+    assert(oSymTableInt != NULL);
+    if (!IntTable_remove(&oSymTableInt->table, iKey, &pvValue)) return NULL;
+    return pvValue;
+}
+
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+                     void (*pfApply)(int64_t iKey, void *pvValue,
+                                     void *pvExtra),
+                     const void *pvExtra) {
+    size_t uCursor;
+    int64_t iKey;
+    void *pvValue;
+    assert(oSymTableInt != NULL);
+    assert(pfApply != NULL);
+    for (uCursor = 0;
+         IntTable_next(&oSymTableInt->table, &uCursor, &iKey, &pvValue);)
+        (*pfApply)(iKey, pvValue, (void *)pvExtra);
+}
@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------*/
+/* symtableint.h                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEINT_H
+#define SYMTABLEINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A SymTableInt_T stores a collection of bindings whose keys are unique
+ * 64-bit integers. It works like a SymTable_T, but stores the keys
+ * themselves rather than copies of strings, in an open-addressing hash
+ * table whose keys and values lie in flat arrays, so no operation
+ * allocates, formats, or compares a string. */
+typedef struct SymTableInt *SymTableInt_T;
+
+/* Return a new SymTableInt object that contains no bindings, or NULL if
+ * insufficient memory is available. */
+SymTableInt_T SymTableInt_new(void);
+
+/* Free all memory occupied by oSymTableInt. */
+void SymTableInt_free(SymTableInt_T oSymTableInt);
+
+/* Return the number of bindings in oSymTableInt. */
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt);
+
+/* Prepare oSymTableInt to hold uCount bindings without resizing. Return 1,
+ * or 0 if insufficient memory is available; oSymTableInt is usable either
+ * way. */
+int SymTableInt_reserve(SymTableInt_T oSymTableInt, size_t uCount);
+
+/* Return 1 and add a new binding to oSymTableInt consisting of key iKey
+ * and value pvValue if oSymTableInt does not contain a binding with key
+ * iKey and if sufficient memory is available, otherwise return 0. */
+int SymTableInt_put(SymTableInt_T oSymTableInt, int64_t iKey,
+                    const void *pvValue);
+
+/* If oSymTableInt contains a binding with key iKey, replace the binding's
+ * value with pvValue and return the old value, otherwise return NULL. */
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, int64_t iKey,
+                          const void *pvValue);
+
+/* Return 1 if oSymTableInt contains a binding whose key is iKey, and 0
+ * otherwise. */
+int SymTableInt_contains(SymTableInt_T oSymTableInt, int64_t iKey);
+
+/* Return the value of the binding within oSymTableInt whose key is iKey,
+ * or NULL if no such binding exists. */
+void *SymTableInt_get(SymTableInt_T oSymTableInt, int64_t iKey);
+
+/* Return the value of the binding with key iKey and remove the binding if
+ * oSymTableInt contains it, otherwise return NULL. */
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, int64_t iKey);
+
+/* Apply function *pfApply to each binding in oSymTableInt, passing pvExtra
+ * as an extra parameter. The bindings are visited in no particular order,
+ * and *pfApply must not add or remove bindings. */
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+                     void (*pfApply)(int64_t iKey, void *pvValue,
+                                     void *pvExtra),
+                     const void *pvExtra);
+
+#endif
@@ -11,7 +11,8 @@
 #include <time.h>
 #include <unistd.h>
 
-#include "symtable.h"
+#include "symtablebackend.h"
+#include "symtablelist.h"
 
 /* shortened form for struct Node */
 typedef struct Node Node;
@@ -19,7 +20,8 @@ typedef struct Node Node;
 /* A Node object consists of a unique key and value pair, and a pointer to the
  * next Node in the list. */
 struct Node {
-    /* Key for the binding */
+    /* Key for the binding, stored in the same allocation right after the
+     * node */
     const char *key;
     /* Value associated with the key */
     void *value;
@@ -27,61 +29,125 @@ struct Node {
     struct Node *next;
 };
 
-/* A SymTable object consists of the first node in the linked list and the
- * size of the list */
-struct SymTable {
+/* A SymTableList object consists of the first and last nodes in the linked
+ * list, the size of the list, and the policy used to reorder the list on
+ * lookups */
+struct SymTableList {
+    /* Common header identifying the backend */
+    struct SymTable base;
     /* The first node in the linked list */
     struct Node *first;
+    /* The last node in the linked list, after which new nodes are appended */
+    struct Node *last;
     /* Numer of nodes/bindings in symbol table */
     size_t numBindings;
+    /* How a node found by a lookup is repositioned */
+    enum SymTableListPolicy policy;
 };
 
-SymTable_T SymTable_new() {
-    SymTable_T symtable = (struct SymTable *)malloc(sizeof(SymTable_T));
+/* shortened form for a pointer to struct SymTableList */
+typedef struct SymTableList *SymTableList_T;
+
+SymTable_T SymTableList_new(enum SymTableListPolicy ePolicy) {
+    SymTableList_T symtable =
+        (SymTableList_T)malloc(sizeof(struct SymTableList));
     if (symtable == NULL) return NULL;
+    SymTable_initHeader(&symtable->base, &SymTableList_backend);
+    SYMTABLE_STATS_ADD(&symtable->base, bytesAllocated,
+                       sizeof(struct SymTableList));
     symtable->first = NULL;
+    symtable->last = NULL;
     symtable->numBindings = 0;
-    return symtable;
+    symtable->policy = ePolicy;
+    return &symtable->base;
+}
+
+/* Return a new list SymTable object with the static policy, or NULL if
+ * insufficient memory is available. */
+static SymTable_T SymTableList_newDefault(void) {
+    return SymTableList_new(SYMTABLE_LIST_STATIC);
 }
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+/* Return the node in oSymTable whose key is pcKey, or NULL if there is no
+ * such node. A node that is found is repositioned according to the policy of
+ * oSymTable, so that frequently accessed keys migrate towards the front. */
+static Node *SymTable_find(SymTableList_T oSymTable, const char *pcKey) {
     Node *head = oSymTable->first;
-    Node *prev;
+    Node *prev = NULL;
+    Node *prevPrev = NULL;
+    while (head != NULL) {
+        if (SYMTABLE_STRCMP(&oSymTable->base, head->key, pcKey) == 0) break;
+        prevPrev = prev;
+        prev = head;
+        head = head->next;
+    }
+    /* Not found, already at the front of the list, or not reorganizing */
+    if (head == NULL || prev == NULL ||
+        oSymTable->policy == SYMTABLE_LIST_STATIC)
+        return head;
+
+    if (head == oSymTable->last) oSymTable->last = prev;
+    if (oSymTable->policy == SYMTABLE_LIST_MOVE_TO_FRONT) {
+        prev->next = head->next;
+        head->next = oSymTable->first;
+        oSymTable->first = head;
+    } else if (oSymTable->policy == SYMTABLE_LIST_TRANSPOSE) {
+        prev->next = head->next;
+        head->next = prev;
+        if (prevPrev == NULL)
+            oSymTable->first = head;
+        else
+            prevPrev->next = head;
+    }
+    return head;
+}
+
+int SymTableList_putUnique(SymTable_T oBase, const char *pcKey,
+                           const void *pvValue) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     Node *toInsert;
+    size_t keyLength;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableList_backend);
     assert(pcKey != NULL);
 
-    /* Create the new node to be inserted */
-    toInsert = (Node *)malloc(sizeof(Node));
+    /* The key is stored in the same allocation, right after the node */
+    keyLength = strlen(pcKey) + 1;
+    toInsert = (Node *)malloc(sizeof(Node) + keyLength);
     if (toInsert == NULL) return 0;
-    toInsert->key = (const char *)malloc((strlen(pcKey) + 1));
-    if (toInsert->key == NULL) return 0;
-    strcpy((char *)toInsert->key, pcKey);
+    toInsert->key = (const char *)(toInsert + 1);
+    memcpy((char *)toInsert->key, pcKey, keyLength);
     toInsert->value = (void *)pvValue;
     toInsert->next = NULL;
+    SYMTABLE_STATS_ADD(oBase, bytesAllocated, sizeof(Node) + keyLength);
 
-    if (head == NULL) {
+    if (oSymTable->last == NULL)
         oSymTable->first = toInsert;
-        oSymTable->numBindings++;
-        return 1;
-    }
-    prev = head;
-    /* iterate through the linked list to get the last node, after which the new
-     * node will be inserted */
+    else
+        oSymTable->last->next = toInsert;
+    oSymTable->last = toInsert;
+    oSymTable->numBindings++;
+    return 1;
+}
+
+static int SymTableList_put(SymTable_T oBase, const char *pcKey,
+                            const void *pvValue) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
+    Node *head;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* Check for a duplicate before allocating anything */
+    head = oSymTable->first;
     while (head != NULL) {
-        if (strcmp(head->key, pcKey) == 0) {
-            free((char *)toInsert->key);
-            free(toInsert);
-            return 0;
-        }
-        prev = head;
+        if (SYMTABLE_STRCMP(oBase, head->key, pcKey) == 0) return 0;
         head = head->next;
     }
-    oSymTable->numBindings++;
-    prev->next = toInsert;
-    return 1;
+    return SymTableList_putUnique(oBase, pcKey, pvValue);
 }
 
-void SymTable_free(SymTable_T oSymTable) {
+static void SymTableList_free(SymTable_T oBase) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     Node *head;
     Node *temp;
     assert(oSymTable != NULL);
@@ -89,33 +155,29 @@ void SymTable_free(SymTable_T oSymTable) {
     while (head != NULL) {
         temp = head;
         head = head->next;
-        free((char *)temp->key);
         free(temp);
     }
     free(oSymTable);
 }
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-    Node *head;
+static int SymTableList_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    head = oSymTable->first;
-    while (head != NULL) {
-        if (strcmp(head->key, pcKey) == 0) return 1;
-        head = head->next;
-    }
-    return 0;
+    return SymTable_find(oSymTable, pcKey) != NULL;
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
+static size_t SymTableList_getLength(SymTable_T oBase) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     assert(oSymTable != NULL);
     return oSymTable->numBindings;
 }
 
-void SymTable_map(SymTable_T oSymTable,
-                  void (*pfApply)(const char *pcKey, void *pvValue,
-                                  void *pvExtra),
-                  const void *pvExtra) {
+static void SymTableList_map(SymTable_T oBase,
+                             void (*pfApply)(const char *pcKey, void *pvValue,
+                                             void *pvExtra),
+                             const void *pvExtra) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     Node *head;
     assert(oSymTable != NULL);
     assert(pfApply != NULL);
@@ -126,36 +188,32 @@ void SymTable_map(SymTable_T oSymTable,
     }
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-    Node *head;
+static void *SymTableList_get(SymTable_T oBase, const char *pcKey) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
+    Node *node;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    head = oSymTable->first;
-    while (head != NULL) {
-        if (strcmp(head->key, pcKey) == 0) return head->value;
-        head = head->next;
-    }
-    return NULL;
+    node = SymTable_find(oSymTable, pcKey);
+    if (node == NULL) return NULL;
+    return node->value;
 }
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
-                       const void *pvValue) {
-    Node *head;
+static void *SymTableList_replace(SymTable_T oBase, const char *pcKey,
+                                  const void *pvValue) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
+    Node *node;
+    void *original;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    head = oSymTable->first;
-    while (head != NULL) {
-        if (strcmp(head->key, pcKey) == 0) {
-            void *original = head->value;
-            head->value = (void *)pvValue;
-            return original;
-        }
-        head = head->next;
-    }
-    return NULL;
+    node = SymTable_find(oSymTable, pcKey);
+    if (node == NULL) return NULL;
+    original = node->value;
+    node->value = (void *)pvValue;
+    return original;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+static void *SymTableList_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
     Node *head;
     Node *prev;
     assert(oSymTable != NULL);
@@ -163,14 +221,17 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     head = oSymTable->first;
     prev = head;
     while (head != NULL) {
-        if (strcmp(head->key, pcKey) == 0) {
+        if (SYMTABLE_STRCMP(oBase, head->key, pcKey) == 0) {
             void *original = head->value;
             if (head == prev) {
                 oSymTable->first = head->next;
+                prev = NULL;
             } else {
                 prev->next = head->next;
             }
-            free((char *)head->key);
+            if (head == oSymTable->last) oSymTable->last = prev;
+            SYMTABLE_STATS_SUB(oBase, bytesAllocated,
+                               sizeof(Node) + strlen(head->key) + 1);
             free(head);
             oSymTable->numBindings--;
             return original;
@@ -180,3 +241,47 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
     }
     return NULL;
 }
+
+static void SymTableList_getStats(SymTable_T oBase,
+                                  struct SymTableStats *psStats) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+    /* The whole list is a single chain */
+    SymTable_addChain(psStats, oSymTable->numBindings);
+}
+
+/* Return a copy of oBase with the same policy and the bindings in the same
+ * order, or NULL if insufficient memory is available. Takes time linear in
+ * the number of bindings, which SymTable_put could not. */
+static SymTable_T SymTableList_clone(SymTable_T oBase) {
+    SymTableList_T oSymTable = (SymTableList_T)oBase;
+    SymTable_T oClone;
+    Node *head;
+    assert(oSymTable != NULL);
+    oClone = SymTableList_new(oSymTable->policy);
+    if (oClone == NULL) return NULL;
+    for (head = oSymTable->first; head != NULL; head = head->next)
+        if (!SymTableList_putUnique(oClone, head->key, head->value)) {
+            SymTableList_free(oClone);
+            return NULL;
+        }
+    return oClone;
+}
+
+/* The function table of the list backend */
+const struct SymTableBackend SymTableList_backend = {
+    "list",
+    SymTableList_newDefault,
+    SymTableList_free,
+    SymTableList_getLength,
+    SymTableList_put,
+    SymTableList_replace,
+    SymTableList_contains,
+    SymTableList_get,
+    SymTableList_remove,
+    SymTableList_map,
+    SymTableList_getStats,
+    SymTableList_clone,
+    NULL,
+    NULL};
@@ -0,0 +1,36 @@
+/*--------------------------------------------------------------------*/
+/* symtablelist.h                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLELIST_H
+#define SYMTABLELIST_H
+
+#include "symtable.h"
+
+/* Self-organizing policies for the linked list implementation. The policy
+ * decides what happens to a binding that is found by SymTable_get,
+ * SymTable_contains, or SymTable_replace: SYMTABLE_LIST_STATIC leaves it where
+ * it is, SYMTABLE_LIST_MOVE_TO_FRONT moves it to the front of the list, and
+ * SYMTABLE_LIST_TRANSPOSE swaps it with its predecessor. */
+enum SymTableListPolicy {
+    SYMTABLE_LIST_STATIC,
+    SYMTABLE_LIST_MOVE_TO_FRONT,
+    SYMTABLE_LIST_TRANSPOSE
+};
+
+/* Return a new SymTable object that contains no bindings and reorganizes
+ * itself on lookup hits according to ePolicy, or NULL if insufficient memory
+ * is available. SymTable_newWithBackend("list") is equivalent to
+ * SymTableList_new(SYMTABLE_LIST_STATIC). */
+SymTable_T SymTableList_new(enum SymTableListPolicy ePolicy);
+
+/* Like SymTable_put, but skips the duplicate check: the caller guarantees that
+ * oSymTable does not already contain a binding with key pcKey. Returns 1 and
+ * appends the binding in constant time if sufficient memory is available,
+ * otherwise returns 0. Breaking the guarantee leaves oSymTable with two
+ * bindings for pcKey. oSymTable must be a list SymTable. */
+int SymTableList_putUnique(SymTable_T oSymTable, const char *pcKey,
+                           const void *pvValue);
+
+#endif
@@ -0,0 +1,130 @@
+/*--------------------------------------------------------------------*/
+/* symtablemerge.c                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "symtable.h"
+#include "symtablemerge.h"
+
+/* A MergePool object is the state shared by the threads of one
+ * SymTableMerge_reduce. Threads claim the pairs of the current round one
+ * at a time, and whichever finishes the last pair starts the next
+ * round. */
+struct MergePool {
+    /* Lock that protects the remaining fields */
+    pthread_mutex_t lock;
+    /* Signalled when a round starts */
+    pthread_cond_t roundStarted;
+    /* The tables being merged */
+    SymTable_T *tables;
+    /* Number of tables */
+    size_t count;
+    /* How keys bound in both tables of a pair are resolved */
+    enum SymTableConflict conflict;
+    /* Distance between the two tables of a pair in the current round, or
+     * at least count once every round is done */
+    size_t stride;
+    /* Number of pairs in the current round */
+    size_t pairCount;
+    /* Number of pairs of the current round claimed */
+    size_t pairsClaimed;
+    /* Number of pairs of the current round merged */
+    size_t pairsMerged;
+    /* 0 once a merge has failed */
+    int ok;
+};
+
+/* Start the round of psPool with stride uStride. psPool->lock must be
+ * held. */
+static void SymTableMerge_startRound(struct MergePool *psPool,
+                                     size_t uStride) {
+    psPool->stride = uStride;
+    psPool->pairsClaimed = 0;
+    psPool->pairsMerged = 0;
+    /* Pair k merges table 2 * uStride * k + uStride into table
+     * 2 * uStride * k */
+    psPool->pairCount = uStride < psPool->count
+                            ? (psPool->count - uStride + 2 * uStride - 1) /
+                                  (2 * uStride)
+                            : 0;
+    pthread_cond_broadcast(&psPool->roundStarted);
+}
+
+/* Merge pairs of tables of the MergePool pvPool until every round is
+ * done. */
+static void *SymTableMerge_work(void *pvPool) {
+    struct MergePool *psPool = (struct MergePool *)pvPool;
+    pthread_mutex_lock(&psPool->lock);
+    while (psPool->stride < psPool->count) {
+        size_t uStride = psPool->stride;
+        size_t uDst;
+        int iSuccessful;
+        if (psPool->pairsClaimed == psPool->pairCount) {
+            pthread_cond_wait(&psPool->roundStarted, &psPool->lock);
+            continue;
+        }
+        uDst = 2 * uStride * psPool->pairsClaimed++;
+        pthread_mutex_unlock(&psPool->lock);
+
+        iSuccessful = SymTable_merge(psPool->tables[uDst],
+                                     psPool->tables[uDst + uStride],
+                                     psPool->conflict);
+
+        pthread_mutex_lock(&psPool->lock);
+        if (!iSuccessful) psPool->ok = 0;
+        if (++psPool->pairsMerged == psPool->pairCount)
+            SymTableMerge_startRound(psPool, 2 * uStride);
+    }
+    pthread_mutex_unlock(&psPool->lock);
+    return NULL;
+}
+
+int SymTableMerge_reduce(SymTable_T *aoTables, size_t uCount,
+                         enum SymTableConflict eConflict,
+                         size_t uThreadCount) {
+    struct MergePool sPool;
+    pthread_t *aThreads;
+    size_t uStarted = 0;
+    size_t i;
+
+    assert(aoTables != NULL);
+    assert(uCount > 0);
+    assert(uThreadCount > 0);
+
+    if (pthread_mutex_init(&sPool.lock, NULL) != 0) return 0;
+    if (pthread_cond_init(&sPool.roundStarted, NULL) != 0) {
+        pthread_mutex_destroy(&sPool.lock);
+        return 0;
+    }
+    sPool.tables = aoTables;
+    sPool.count = uCount;
+    sPool.conflict = eConflict;
+    sPool.ok = 1;
+    SymTableMerge_startRound(&sPool, 1);
+
+    /* No round has more than uCount / 2 pairs. Threads that cannot be
+     * started are not needed: the calling thread alone finishes the
+     * work. */
+    if (uThreadCount > uCount / 2) uThreadCount = uCount / 2;
+    aThreads = NULL;
+    if (uThreadCount > 1)
+        aThreads = (pthread_t *)malloc((uThreadCount - 1) * sizeof(pthread_t));
+    if (aThreads != NULL)
+        for (; uStarted + 1 < uThreadCount; uStarted++)
+            if (pthread_create(&aThreads[uStarted], NULL, SymTableMerge_work,
+                               &sPool) != 0)
+                break;
+    SymTableMerge_work(&sPool);
+    for (i = 0; i < uStarted; i++) pthread_join(aThreads[i], NULL);
+
+    free(aThreads);
+    pthread_cond_destroy(&sPool.roundStarted);
+    pthread_mutex_destroy(&sPool.lock);
+    return sPool.ok;
+}
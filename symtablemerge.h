@@ -0,0 +1,29 @@
+/*--------------------------------------------------------------------*/
+/* symtablemerge.h                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEMERGE_H
+#define SYMTABLEMERGE_H
+
+#include <stddef.h>
+
+#include "symtable.h"
+
+/* Merge the uCount tables aoTables[0..uCount-1] into aoTables[0] with
+ * SymTable_merge, using uThreadCount threads including the calling one.
+ * The tables are merged pairwise in rounds, as a tree: in the round with
+ * stride s, table i + s is merged into table i for every i that is a
+ * multiple of 2s, and the pairs of a round are merged in parallel. A key
+ * bound in several tables keeps the value of the first of them if
+ * eConflict is SYMTABLE_KEEP_DST, or of the last if it is
+ * SYMTABLE_KEEP_SRC, whatever the number of threads, and each losing
+ * binding is left in one of aoTables[1..uCount-1]. No other thread may use
+ * the tables meanwhile. Return 1, or 0 if insufficient memory was available
+ * to move every binding, in which case the bindings not moved are still in
+ * the other tables. */
+int SymTableMerge_reduce(SymTable_T *aoTables, size_t uCount,
+                         enum SymTableConflict eConflict,
+                         size_t uThreadCount);
+
+#endif
@@ -0,0 +1,169 @@
+/*--------------------------------------------------------------------*/
+/* symtablescope.c                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symtable.h"
+#include "symtablescope.h"
+
+/* shortened form for struct Definition */
+typedef struct Definition Definition;
+
+/* A Definition object is one binding of a key in one scope. The table maps
+ * each key to its innermost Definition, which links to the Definition it
+ * shadows, and all Definitions are also linked in the order they were made,
+ * so that those of the innermost scope come first. */
+struct Definition {
+    /* Key for the binding, stored in the same allocation right after the
+     * definition */
+    const char *key;
+    /* Value associated with the key */
+    void *value;
+    /* Depth of the scope that contains the binding */
+    size_t depth;
+    /* The definition of the same key in an enclosing scope that this one
+     * shadows, or NULL */
+    struct Definition *shadowed;
+    /* The definition made before this one */
+    struct Definition *older;
+};
+
+/* A SymTableScope object consists of a SymTable that maps every visible key
+ * to its innermost definition, the most recent definition, and the depth of
+ * the innermost scope. */
+struct SymTableScope {
+    /* Innermost definition of each visible key */
+    SymTable_T table;
+    /* The most recent definition, or NULL */
+    struct Definition *newest;
+    /* Depth of the innermost scope */
+    size_t depth;
+};
+
+SymTableScope_T SymTableScope_new(void) {
+    SymTableScope_T oScope =
+        (SymTableScope_T)malloc(sizeof(struct SymTableScope));
+    if (oScope == NULL) return NULL;
+    oScope->table = SymTable_new();
+    if (oScope->table == NULL) {
+        free(oScope);
+        return NULL;
+    }
+    oScope->newest = NULL;
+    oScope->depth = 0;
+    return oScope;
+}
+
+void SymTableScope_free(SymTableScope_T oScope) {
+    Definition *definition;
+    assert(oScope != NULL);
+    definition = oScope->newest;
+    while (definition != NULL) {
+        Definition *older = definition->older;
+        free(definition);
+        definition = older;
+    }
+    SymTable_free(oScope->table);
+    free(oScope);
+}
+
+void SymTableScope_pushScope(SymTableScope_T oScope) {
+    assert(oScope != NULL);
+    oScope->depth++;
+}
+
+void SymTableScope_popScope(SymTableScope_T oScope) {
+    Definition *definition;
+    assert(oScope != NULL);
+    assert(oScope->depth > 0);
+    definition = oScope->newest;
+    while (definition != NULL && definition->depth == oScope->depth) {
+        Definition *older = definition->older;
+        /* Uncover the shadowed definition, if any, in place of this one */
+        if (definition->shadowed != NULL)
+            SymTable_replace(oScope->table, definition->key,
+                             definition->shadowed);
+        else
+            SymTable_remove(oScope->table, definition->key);
+        free(definition);
+        definition = older;
+    }
+    oScope->newest = definition;
+    oScope->depth--;
+}
+
+size_t SymTableScope_getDepth(SymTableScope_T oScope) {
+    assert(oScope != NULL);
+    return oScope->depth;
+}
+
+size_t SymTableScope_getLength(SymTableScope_T oScope) {
+    assert(oScope != NULL);
+    return SymTable_getLength(oScope->table);
+}
+
+int SymTableScope_put(SymTableScope_T oScope, const char *pcKey,
+                      const void *pvValue) {
+    Definition *shadowed, *definition;
+    size_t keyLength;
+    assert(oScope != NULL);
+    assert(pcKey != NULL);
+
+    shadowed = (Definition *)SymTable_get(oScope->table, pcKey);
+    if (shadowed != NULL && shadowed->depth == oScope->depth) return 0;
+
+    /* The key is stored in the same allocation, right after the
+     * definition */
+    keyLength = strlen(pcKey) + 1;
+    definition = (Definition *)malloc(sizeof(Definition) + keyLength);
+    if (definition == NULL) return 0;
+    definition->key = (const char *)(definition + 1);
+    memcpy((char *)definition->key, pcKey, keyLength);
+    definition->value = (void *)pvValue;
+    definition->depth = oScope->depth;
+    definition->shadowed = shadowed;
+
+    if (shadowed != NULL) {
+        SymTable_replace(oScope->table, pcKey, definition);
+    } else if (!SymTable_put(oScope->table, pcKey, definition)) {
+        free(definition);
+        return 0;
+    }
+    definition->older = oScope->newest;
+    oScope->newest = definition;
+    return 1;
+}
+
+void *SymTableScope_replace(SymTableScope_T oScope, const char *pcKey,
+                            const void *pvValue) {
+    Definition *definition;
+    void *oldValue;
+    assert(oScope != NULL);
+    assert(pcKey != NULL);
+    definition = (Definition *)SymTable_get(oScope->table, pcKey);
+    if (definition == NULL) return NULL;
+    oldValue = definition->value;
+    definition->value = (void *)pvValue;
+    return oldValue;
+}
+
+int SymTableScope_contains(SymTableScope_T oScope, const char *pcKey) {
+    assert(oScope != NULL);
+    assert(pcKey != NULL);
+    return SymTable_contains(oScope->table, pcKey);
+}
+
+void *SymTableScope_get(SymTableScope_T oScope, const char *pcKey,
+                        size_t *puDepth) {
+    Definition *definition;
+    assert(oScope != NULL);
+    assert(pcKey != NULL);
+    definition = (Definition *)SymTable_get(oScope->table, pcKey);
+    if (definition == NULL) return NULL;
+    if (puDepth != NULL) *puDepth = definition->depth;
+    return definition->value;
+}
@@ -0,0 +1,66 @@
+/*--------------------------------------------------------------------*/
+/* symtablescope.h                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESCOPE_H
+#define SYMTABLESCOPE_H
+
+#include <stddef.h>
+
+/* A SymTableScope_T stores key-value bindings in a stack of nested scopes.
+ * Keys are unique within a scope, and a binding in an inner scope shadows
+ * the bindings with the same key in the scopes that enclose it. Lookups see
+ * only the innermost binding of each key and cost one hash table probe
+ * regardless of the depth of that binding. */
+typedef struct SymTableScope *SymTableScope_T;
+
+/* Return a new SymTableScope object that has only its outermost scope,
+ * which contains no bindings, or NULL if insufficient memory is
+ * available. */
+SymTableScope_T SymTableScope_new(void);
+
+/* Frees all memory occupied by oScope. */
+void SymTableScope_free(SymTableScope_T oScope);
+
+/* Opens a new innermost scope in oScope that contains no bindings. */
+void SymTableScope_pushScope(SymTableScope_T oScope);
+
+/* Closes the innermost scope of oScope, which must not be the outermost
+ * scope, removing its bindings and making the bindings they shadowed
+ * visible again. Takes time proportional to the number of bindings in the
+ * closed scope. */
+void SymTableScope_popScope(SymTableScope_T oScope);
+
+/* Returns the number of scopes of oScope that enclose its innermost scope,
+ * which is 0 when only the outermost scope is open. */
+size_t SymTableScope_getDepth(SymTableScope_T oScope);
+
+/* Returns the number of visible bindings in oScope, that is, the number of
+ * distinct keys bound in any open scope. */
+size_t SymTableScope_getLength(SymTableScope_T oScope);
+
+/* Returns 1 and adds a new binding to the innermost scope of oScope
+ * consisting of key pcKey and value pvValue if that scope does not contain a
+ * binding with key pcKey and if sufficient memory is available, otherwise
+ * returns 0. */
+int SymTableScope_put(SymTableScope_T oScope, const char *pcKey,
+                      const void *pvValue);
+
+/* If a binding with key pcKey is visible in oScope, replaces the binding's
+ * value with pvValue and returns the old value, otherwise returns NULL. */
+void *SymTableScope_replace(SymTableScope_T oScope, const char *pcKey,
+                            const void *pvValue);
+
+/* Returns 1 if a binding whose key is pcKey is visible in oScope, and 0
+ * otherwise. */
+int SymTableScope_contains(SymTableScope_T oScope, const char *pcKey);
+
+/* Returns the value of the binding whose key is pcKey that is visible in
+ * oScope, or NULL if no such binding exists. If puDepth is not NULL and the
+ * binding exists, stores the depth of the scope that contains it in
+ * *puDepth. */
+void *SymTableScope_get(SymTableScope_T oScope, const char *pcKey,
+                        size_t *puDepth);
+
+#endif
@@ -0,0 +1,325 @@
+/*--------------------------------------------------------------------*/
+/* symtableshard.c                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "symtable.h"
+#include "symtablebackend.h"
+#include "symtableshard.h"
+
+/* Enum containing the size of a cache line. Each shard starts on a cache
+ * line of its own, so that the locks of neighbouring shards do not
+ * share one. */
+enum { CACHE_LINE = 64 };
+
+/* A Shard object is one partition of a SymTableShard. */
+struct Shard {
+    /* Lock held throughout every operation on the table */
+    pthread_mutex_t lock;
+    /* Table holding the bindings of the shard */
+    SymTable_T table;
+    /* NUMA node on which the shard is placed */
+    int node;
+};
+
+/* A SymTableShard object is an array of shards, each holding the bindings
+ * whose keys hash to its index. */
+struct SymTableShard {
+    /* Array of shards, each allocated separately on its node */
+    struct Shard **shards;
+    /* Number of shards */
+    size_t shardCount;
+    /* 1 if the shards are placed on NUMA nodes, which requires libnuma and
+     * a system that supports it, or 0 otherwise */
+    int placed;
+};
+
+/* Return the index of the shard of oSymTableShard that holds pcKey. The
+ * table of the shard hashes pcKey again with its own function, since
+ * backends take no precomputed hash; this pass happens before the lock is
+ * taken. The index is the high half of the hash scaled to the number of
+ * shards: tables that share the hash take buckets and slots from its low
+ * bits, which must not be the same for every key of a shard. */
+static size_t SymTable_shardIndex(SymTableShard_T oSymTableShard,
+                                  const char *pcKey) {
+    return (size_t)((SymTable_mixedHash(pcKey) >> 32) *
+                    oSymTableShard->shardCount >> 32);
+}
+
+/* Return the shard of oSymTableShard that holds pcKey. */
+static struct Shard *SymTable_findShard(SymTableShard_T oSymTableShard,
+                                        const char *pcKey) {
+    return oSymTableShard->shards[SymTable_shardIndex(oSymTableShard, pcKey)];
+}
+
+/* Return the size of a Shard, rounded up to whole cache lines. */
+static size_t SymTable_shardSize(void) {
+    return (sizeof(struct Shard) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+/* Return uninitialized memory for a shard, on node iNode if iPlaced is
+ * nonzero, or NULL if insufficient memory is available. */
+static struct Shard *SymTable_allocShard(int iPlaced, int iNode) {
+    void *pvShard;
+#ifdef HAVE_LIBNUMA
+    if (iPlaced)
+        return (struct Shard *)numa_alloc_onnode(SymTable_shardSize(), iNode);
+#else
+    (void)iPlaced;
+    (void)iNode;
+#endif
+    if (posix_memalign(&pvShard, CACHE_LINE, SymTable_shardSize()) != 0)
+        return NULL;
+    return (struct Shard *)pvShard;
+}
+
+/* Free the memory of psShard, which SymTable_allocShard returned with the
+ * same iPlaced. */
+static void SymTable_freeShard(int iPlaced, struct Shard *psShard) {
+#ifdef HAVE_LIBNUMA
+    if (iPlaced) {
+        numa_free(psShard, SymTable_shardSize());
+        return;
+    }
+#else
+    (void)iPlaced;
+#endif
+    free(psShard);
+}
+
+/* Free the first uCount shards of oSymTableShard, then oSymTableShard. */
+static void SymTable_freeShards(SymTableShard_T oSymTableShard,
+                                size_t uCount) {
+    size_t i;
+    for (i = 0; i < uCount; i++) {
+        struct Shard *psShard = oSymTableShard->shards[i];
+        pthread_mutex_destroy(&psShard->lock);
+        SymTable_free(psShard->table);
+        SymTable_freeShard(oSymTableShard->placed, psShard);
+    }
+    free(oSymTableShard->shards);
+    free(oSymTableShard);
+}
+
+#ifdef HAVE_LIBNUMA
+/* Return the number of nodes on which shards can be placed, and write to
+ * *piNode the node of index iIndex among them, in increasing order, if
+ * there is one. These are the nodes whose memory and CPUs the calling
+ * thread may use: node numbers may be sparse, and a node without memory
+ * or without CPUs is skipped. */
+static int SymTable_scanNodes(int iIndex, int *piNode) {
+    struct bitmask *psMems = numa_get_mems_allowed();
+    struct bitmask *psCpus = numa_get_run_node_mask();
+    int iCount = 0;
+    int iNode;
+    if (psMems != NULL && psCpus != NULL) {
+        for (iNode = 0; iNode <= numa_max_node(); iNode++) {
+            if (!numa_bitmask_isbitset(psMems, iNode) ||
+                !numa_bitmask_isbitset(psCpus, iNode))
+                continue;
+            if (iCount++ == iIndex) *piNode = iNode;
+        }
+    }
+    if (psMems != NULL) numa_bitmask_free(psMems);
+    if (psCpus != NULL) numa_bitmask_free(psCpus);
+    return iCount;
+}
+
+/* Return 1 if shards can be placed on NUMA nodes, or 0 otherwise. */
+static int SymTable_canPlace(void) {
+    return numa_available() >= 0 && SymTable_scanNodes(-1, NULL) > 0;
+}
+#endif
+
+int SymTableShard_getNodeCount(void) {
+#ifdef HAVE_LIBNUMA
+    if (SymTable_canPlace()) return SymTable_scanNodes(-1, NULL);
+#endif
+    return 1;
+}
+
+int SymTableShard_getNodeId(int iIndex) {
+    int iNode = 0;
+    assert(iIndex >= 0 && iIndex < SymTableShard_getNodeCount());
+#ifdef HAVE_LIBNUMA
+    if (SymTable_canPlace()) SymTable_scanNodes(iIndex, &iNode);
+#endif
+    return iNode;
+}
+
+SymTableShard_T SymTableShard_new(size_t uShardCount, const char *pcBackend,
+                                  const int *piNodes) {
+    SymTableShard_T oSymTableShard;
+    int iNodeCount = SymTableShard_getNodeCount();
+    size_t i;
+
+    if (uShardCount == 0 || (uint64_t)uShardCount > UINT32_MAX) return NULL;
+    if (pcBackend == NULL) pcBackend = "hash";
+
+    oSymTableShard = (SymTableShard_T)malloc(sizeof(struct SymTableShard));
+    if (oSymTableShard == NULL) return NULL;
+    oSymTableShard->shards =
+        (struct Shard **)malloc(uShardCount * sizeof(struct Shard *));
+    if (oSymTableShard->shards == NULL) {
+        free(oSymTableShard);
+        return NULL;
+    }
+    oSymTableShard->shardCount = uShardCount;
+#ifdef HAVE_LIBNUMA
+    oSymTableShard->placed = SymTable_canPlace();
+#else
+    oSymTableShard->placed = 0;
+#endif
+
+    for (i = 0; i < uShardCount; i++) {
+        int iNode = piNodes != NULL
+                        ? piNodes[i]
+                        : SymTableShard_getNodeId((int)(i % iNodeCount));
+        struct Shard *psShard;
+        assert(iNode >= 0 && (oSymTableShard->placed || iNode == 0));
+
+        psShard = SymTable_allocShard(oSymTableShard->placed, iNode);
+        if (psShard == NULL) {
+            SymTable_freeShards(oSymTableShard, i);
+            return NULL;
+        }
+        psShard->node = iNode;
+        psShard->table = SymTable_newWithBackend(pcBackend);
+        if (psShard->table == NULL) {
+            SymTable_freeShard(oSymTableShard->placed, psShard);
+            SymTable_freeShards(oSymTableShard, i);
+            return NULL;
+        }
+        if (pthread_mutex_init(&psShard->lock, NULL) != 0) {
+            SymTable_free(psShard->table);
+            SymTable_freeShard(oSymTableShard->placed, psShard);
+            SymTable_freeShards(oSymTableShard, i);
+            return NULL;
+        }
+        oSymTableShard->shards[i] = psShard;
+    }
+    return oSymTableShard;
+}
+
+void SymTableShard_free(SymTableShard_T oSymTableShard) {
+    assert(oSymTableShard != NULL);
+    SymTable_freeShards(oSymTableShard, oSymTableShard->shardCount);
+}
+
+size_t SymTableShard_getShardCount(SymTableShard_T oSymTableShard) {
+    assert(oSymTableShard != NULL);
+    return oSymTableShard->shardCount;
+}
+
+size_t SymTableShard_getShard(SymTableShard_T oSymTableShard,
+                              const char *pcKey) {
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    return SymTable_shardIndex(oSymTableShard, pcKey);
+}
+
+int SymTableShard_getNode(SymTableShard_T oSymTableShard, size_t uShard) {
+    assert(oSymTableShard != NULL);
+    assert(uShard < oSymTableShard->shardCount);
+    return oSymTableShard->shards[uShard]->node;
+}
+
+size_t SymTableShard_getLength(SymTableShard_T oSymTableShard) {
+    size_t uLength = 0;
+    size_t i;
+    assert(oSymTableShard != NULL);
+    for (i = 0; i < oSymTableShard->shardCount; i++) {
+        struct Shard *psShard = oSymTableShard->shards[i];
+        pthread_mutex_lock(&psShard->lock);
+        uLength += SymTable_getLength(psShard->table);
+        pthread_mutex_unlock(&psShard->lock);
+    }
+    return uLength;
+}
+
+int SymTableShard_put(SymTableShard_T oSymTableShard, const char *pcKey,
+                      const void *pvValue) {
+    struct Shard *psShard;
+    int iSuccessful;
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    psShard = SymTable_findShard(oSymTableShard, pcKey);
+    pthread_mutex_lock(&psShard->lock);
+    iSuccessful = SymTable_put(psShard->table, pcKey, pvValue);
+    pthread_mutex_unlock(&psShard->lock);
+    return iSuccessful;
+}
+
+void *SymTableShard_replace(SymTableShard_T oSymTableShard, const char *pcKey,
+                            const void *pvValue) {
+    struct Shard *psShard;
+    void *pvOldValue;
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    psShard = SymTable_findShard(oSymTableShard, pcKey);
+    pthread_mutex_lock(&psShard->lock);
+    pvOldValue = SymTable_replace(psShard->table, pcKey, pvValue);
+    pthread_mutex_unlock(&psShard->lock);
+    return pvOldValue;
+}
+
+int SymTableShard_contains(SymTableShard_T oSymTableShard, const char *pcKey) {
+    struct Shard *psShard;
+    int iFound;
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    psShard = SymTable_findShard(oSymTableShard, pcKey);
+    pthread_mutex_lock(&psShard->lock);
+    iFound = SymTable_contains(psShard->table, pcKey);
+    pthread_mutex_unlock(&psShard->lock);
+    return iFound;
+}
+
+void *SymTableShard_get(SymTableShard_T oSymTableShard, const char *pcKey) {
+    struct Shard *psShard;
+    void *pvValue;
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    psShard = SymTable_findShard(oSymTableShard, pcKey);
+    pthread_mutex_lock(&psShard->lock);
+    pvValue = SymTable_get(psShard->table, pcKey);
+    pthread_mutex_unlock(&psShard->lock);
+    return pvValue;
+}
+
+void *SymTableShard_remove(SymTableShard_T oSymTableShard, const char *pcKey) {
+    struct Shard *psShard;
+    void *pvValue;
+    assert(oSymTableShard != NULL);
+    assert(pcKey != NULL);
+    psShard = SymTable_findShard(oSymTableShard, pcKey);
+    pthread_mutex_lock(&psShard->lock);
+    pvValue = SymTable_remove(psShard->table, pcKey);
+    pthread_mutex_unlock(&psShard->lock);
+    return pvValue;
+}
+
+void SymTableShard_map(SymTableShard_T oSymTableShard,
+                       void (*pfApply)(const char *pcKey, void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra) {
+    size_t i;
+    assert(oSymTableShard != NULL);
+    assert(pfApply != NULL);
+    for (i = 0; i < oSymTableShard->shardCount; i++) {
+        struct Shard *psShard = oSymTableShard->shards[i];
+        pthread_mutex_lock(&psShard->lock);
+        SymTable_map(psShard->table, pfApply, pvExtra);
+        pthread_mutex_unlock(&psShard->lock);
+    }
+}
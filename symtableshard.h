@@ -0,0 +1,101 @@
+/*--------------------------------------------------------------------*/
+/* symtableshard.h                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESHARD_H
+#define SYMTABLESHARD_H
+
+#include <stddef.h>
+
+/* A SymTableShard_T stores a collection of bindings with unique string keys,
+ * like a SymTable_T, partitioned by the hash of the key among a fixed number
+ * of shards. Each shard is an independent SymTable with its own lock, so
+ * threads may use one SymTableShard concurrently, and threads that work on
+ * different shards do not contend. When built with HAVE_LIBNUMA defined and
+ * linked with -lnuma, each shard is assigned a NUMA node and its header,
+ * which holds its lock, is placed there once, when it is created. Its
+ * table allocates with malloc under the memory policy of the calling
+ * thread, which is left unchanged, so the bindings of a shard are on its
+ * node only if the shard is filled from threads that run there. Without
+ * libnuma, or when the system does not support NUMA, there is one node and
+ * shards are not placed. */
+typedef struct SymTableShard *SymTableShard_T;
+
+/* Return the number of NUMA nodes on which shards can be placed, which is 1
+ * unless the program was built with HAVE_LIBNUMA on a NUMA system. These
+ * are the nodes whose memory and CPUs the calling thread may use. */
+int SymTableShard_getNodeCount(void);
+
+/* Return the NUMA node of index iIndex, in increasing order, among those on
+ * which shards can be placed, where iIndex is below
+ * SymTableShard_getNodeCount(). Node numbers may be sparse, so this is not
+ * iIndex in general; without NUMA, it is 0. */
+int SymTableShard_getNodeId(int iIndex);
+
+/* Return a new SymTableShard object that contains no bindings and has
+ * uShardCount shards, each a table of the backend registered under the
+ * name pcBackend, or of the hash backend if pcBackend is NULL. Shard i is
+ * placed on node piNodes[i], which must be one that SymTableShard_getNodeId
+ * returns, or if piNodes is NULL on node
+ * SymTableShard_getNodeId(i % SymTableShard_getNodeCount()). Return NULL if
+ * uShardCount is 0 or above 2^32 - 1, there is no such backend, or
+ * insufficient memory is available. */
+SymTableShard_T SymTableShard_new(size_t uShardCount, const char *pcBackend,
+                                  const int *piNodes);
+
+/* Free all memory occupied by oSymTableShard, which no other thread may be
+ * using. */
+void SymTableShard_free(SymTableShard_T oSymTableShard);
+
+/* Return the number of shards of oSymTableShard. */
+size_t SymTableShard_getShardCount(SymTableShard_T oSymTableShard);
+
+/* Return the index of the shard of oSymTableShard that holds the binding
+ * whose key is pcKey, if there is one. */
+size_t SymTableShard_getShard(SymTableShard_T oSymTableShard,
+                              const char *pcKey);
+
+/* Return the NUMA node on which shard uShard of oSymTableShard is placed. */
+int SymTableShard_getNode(SymTableShard_T oSymTableShard, size_t uShard);
+
+/* Return the number of bindings in oSymTableShard. The shards are counted
+ * one at a time, so the count may be stale if other threads change the
+ * table meanwhile. */
+size_t SymTableShard_getLength(SymTableShard_T oSymTableShard);
+
+/* Return 1 and add a new binding to oSymTableShard consisting of a copy of
+ * key pcKey and value pvValue if oSymTableShard does not contain a binding
+ * with key pcKey and if sufficient memory is available, otherwise return
+ * 0. */
+int SymTableShard_put(SymTableShard_T oSymTableShard, const char *pcKey,
+                      const void *pvValue);
+
+/* If oSymTableShard contains a binding with key pcKey, replace the
+ * binding's value with pvValue and return the old value, otherwise return
+ * NULL. */
+void *SymTableShard_replace(SymTableShard_T oSymTableShard, const char *pcKey,
+                            const void *pvValue);
+
+/* Return 1 if oSymTableShard contains a binding whose key is pcKey, and 0
+ * otherwise. */
+int SymTableShard_contains(SymTableShard_T oSymTableShard, const char *pcKey);
+
+/* Return the value of the binding within oSymTableShard whose key is pcKey,
+ * or NULL if no such binding exists. */
+void *SymTableShard_get(SymTableShard_T oSymTableShard, const char *pcKey);
+
+/* Return the value of the binding with key pcKey and remove the binding if
+ * oSymTableShard contains it, otherwise return NULL. */
+void *SymTableShard_remove(SymTableShard_T oSymTableShard, const char *pcKey);
+
+/* Apply function *pfApply to each binding in oSymTableShard, passing
+ * pvExtra as an extra parameter, one shard at a time and while holding the
+ * lock of the shard, so *pfApply must not call a function of
+ * oSymTableShard. */
+void SymTableShard_map(SymTableShard_T oSymTableShard,
+                       void (*pfApply)(const char *pcKey, void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra);
+
+#endif
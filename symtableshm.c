@@ -0,0 +1,656 @@
+/*--------------------------------------------------------------------*/
+/* symtableshm.c                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "symtablebackend.h"
+#include "symtableshm.h"
+
+/* Magic number that begins an initialized object: "SYMSHM" and a version */
+static const uint64_t SHM_MAGIC = 0x53594d53484d0001ULL;
+
+/* Enum containing the bytes of the object per bucket, the alignment of
+ * every node, and the number of free lists. Free list i holds the free
+ * nodes with room for keys of 8 * i + 1 to 8 * (i + 1) bytes, counting the
+ * '\0', except that the last also holds every larger node. */
+enum { BYTES_PER_BUCKET = 64, ALIGNMENT = 8, FREE_LISTS = 32 };
+
+/* A ShmHeader object begins the shared memory object. It is followed by
+ * the bucket array, which holds the offset of the first node of each
+ * bucket, and then by the nodes. An offset of 0 links to no node. */
+struct ShmHeader {
+    /* SHM_MAGIC once the table has been initialized */
+    uint64_t magic;
+    /* Size of the object in bytes */
+    uint64_t size;
+    /* Even while no writer is changing the table, and odd while one is */
+    uint64_t sequence;
+    /* Number of bindings */
+    uint64_t numBindings;
+    /* Number of buckets, a power of 2 */
+    uint64_t bucketCount;
+    /* Offset of the first byte that has never been allocated */
+    uint64_t top;
+    /* Offset of the first node of each free list, or 0 */
+    uint64_t freeLists[FREE_LISTS];
+    /* Lock held by writers, shared between processes and robust, so that
+     * the next writer recovers the table if its holder dies */
+    pthread_mutex_t lock;
+};
+
+/* A ShmNode object is a binding, or a free block of the object. The key
+ * is stored right after it. */
+struct ShmNode {
+    /* Offset of the next node of the same bucket or free list, or 0 */
+    uint64_t next;
+    /* Hash of the key */
+    uint64_t hash;
+    /* Bits of the value pointer */
+    uint64_t value;
+    /* Size of the node in bytes, including the room for its key */
+    uint64_t size;
+    /* Length of the key, excluding the '\0' */
+    uint64_t keyLength;
+};
+
+/* A SymTableShm object is one process's mapping of a shared table. */
+struct SymTableShm {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* Start of the mapping */
+    struct ShmHeader *header;
+    /* Size of the mapping */
+    size_t size;
+};
+
+/* shortened form for a pointer to struct SymTableShm */
+typedef struct SymTableShm *SymTableShm_T;
+
+/* A CloneState object is the state of a clone being built by
+ * SymTable_map. */
+struct CloneState {
+    /* The table being built */
+    SymTable_T clone;
+    /* 0 once a put has failed */
+    int ok;
+};
+
+/* Return uSize rounded up to a multiple of ALIGNMENT. */
+static uint64_t SymTable_align(uint64_t uSize) {
+    return (uSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/* Return the offset of the bucket array. */
+static uint64_t SymTable_bucketsOffset(void) {
+    return SymTable_align(sizeof(struct ShmHeader));
+}
+
+/* Return the offset of the first node of an object with uBucketCount
+ * buckets. */
+static uint64_t SymTable_nodesOffset(uint64_t uBucketCount) {
+    return SymTable_bucketsOffset() + uBucketCount * sizeof(uint64_t);
+}
+
+/* Return the size of a node whose key is uKeyLength bytes long. */
+static uint64_t SymTable_nodeSize(uint64_t uKeyLength) {
+    return sizeof(struct ShmNode) + SymTable_align(uKeyLength + 1);
+}
+
+/* Return the index of the free list for nodes of uSize bytes. */
+static size_t SymTable_freeList(uint64_t uSize) {
+    uint64_t uIndex = (uSize - sizeof(struct ShmNode)) / ALIGNMENT - 1;
+    return uIndex < FREE_LISTS - 1 ? (size_t)uIndex : FREE_LISTS - 1;
+}
+
+/* Return the word *puWord, which another process may be writing. */
+static uint64_t SymTable_load(const uint64_t *puWord) {
+    return __atomic_load_n(puWord, __ATOMIC_RELAXED);
+}
+
+/* Set the word *puWord, which another process may be reading, to
+ * uValue. */
+static void SymTable_store(uint64_t *puWord, uint64_t uValue) {
+    __atomic_store_n(puWord, uValue, __ATOMIC_RELAXED);
+}
+
+/* Return the node of oSymTable at offset uOffset. */
+static struct ShmNode *SymTable_node(SymTableShm_T oSymTable,
+                                     uint64_t uOffset) {
+    return (struct ShmNode *)((char *)oSymTable->header + uOffset);
+}
+
+/* Return the key of psNode. */
+static char *SymTable_nodeKey(struct ShmNode *psNode) {
+    return (char *)(psNode + 1);
+}
+
+/* Return the bucket of oSymTable for keys whose hash is uHash. */
+static uint64_t *SymTable_bucket(SymTableShm_T oSymTable, uint64_t uHash) {
+    uint64_t *puBuckets = (uint64_t *)((char *)oSymTable->header +
+                                       SymTable_bucketsOffset());
+    return &puBuckets[uHash & (oSymTable->header->bucketCount - 1)];
+}
+
+/* Return the hash code for pcKey and store its length in *puLength. The
+ * hash depends on nothing but the key, so every process computes the
+ * same. */
+static uint64_t SymTable_hash(const char *pcKey, size_t *puLength) {
+    *puLength = strlen(pcKey);
+    return SymTable_mixedHash(pcKey);
+}
+
+/* Return the offset of the node of oSymTable whose key is pcKey, which is
+ * uLength bytes long and hashes to uHash, or 0 if there is none. The table
+ * may be changing meanwhile, so every offset is checked before it is
+ * followed and the walk is bounded, and the result means nothing unless
+ * the sequence number is the same afterwards. */
+static uint64_t SymTable_search(SymTableShm_T oSymTable, const char *pcKey,
+                                size_t uLength, uint64_t uHash) {
+    uint64_t uSize = oSymTable->size;
+    uint64_t uFirst = SymTable_nodesOffset(oSymTable->header->bucketCount);
+    uint64_t uSteps = uSize / sizeof(struct ShmNode);
+    uint64_t uOffset = SymTable_load(SymTable_bucket(oSymTable, uHash));
+
+    while (uOffset != 0 && uSteps-- > 0) {
+        struct ShmNode *psNode;
+        if (uOffset < uFirst || uOffset % ALIGNMENT != 0 ||
+            uOffset > uSize - sizeof(struct ShmNode))
+            return 0;
+        psNode = SymTable_node(oSymTable, uOffset);
+        if (SymTable_load(&psNode->hash) == uHash &&
+            SymTable_load(&psNode->keyLength) == uLength &&
+            uLength < uSize - uOffset - sizeof(struct ShmNode)) {
+            SYMTABLE_STATS_ADD(&oSymTable->base, keyComparisons, 1);
+            if (memcmp(SymTable_nodeKey(psNode), pcKey, uLength) == 0)
+                return uOffset;
+        }
+        uOffset = SymTable_load(&psNode->next);
+    }
+    return 0;
+}
+
+/* Restore the table of oSymTable after a writer died while holding its
+ * lock: end the change it was making, and count the bindings again. A
+ * writer links a node into its bucket with a single store, so the buckets
+ * are intact, and at worst a node it was allocating or freeing is lost. */
+static void SymTable_recover(SymTableShm_T oSymTable) {
+    struct ShmHeader *psHeader = oSymTable->header;
+    uint64_t uCount = 0;
+    uint64_t u;
+
+    for (u = 0; u < psHeader->bucketCount; u++) {
+        uint64_t uOffset = *SymTable_bucket(oSymTable, u);
+        for (; uOffset != 0; uOffset = SymTable_node(oSymTable, uOffset)->next)
+            uCount++;
+    }
+    SymTable_store(&psHeader->numBindings, uCount);
+    if (psHeader->sequence % 2 != 0)
+        __atomic_store_n(&psHeader->sequence, psHeader->sequence + 1,
+                         __ATOMIC_RELEASE);
+    pthread_mutex_consistent(&psHeader->lock);
+}
+
+/* Acquire the writers' lock of oSymTable, recovering the table first if
+ * its last holder died. */
+static void SymTable_lock(SymTableShm_T oSymTable) {
+    if (pthread_mutex_lock(&oSymTable->header->lock) == EOWNERDEAD)
+        SymTable_recover(oSymTable);
+}
+
+/* Release the writers' lock of oSymTable. */
+static void SymTable_unlock(SymTableShm_T oSymTable) {
+    pthread_mutex_unlock(&oSymTable->header->lock);
+}
+
+/* Wait for the writer that is changing oSymTable, or recover the table if
+ * that writer has died. */
+static void SymTable_waitWriter(SymTableShm_T oSymTable) {
+    int iStatus = pthread_mutex_trylock(&oSymTable->header->lock);
+    if (iStatus == EOWNERDEAD) SymTable_recover(oSymTable);
+    if (iStatus == 0 || iStatus == EOWNERDEAD)
+        SymTable_unlock(oSymTable);
+    else
+        sched_yield();
+}
+
+/* Make the sequence number of oSymTable odd before a writer changes the
+ * table, which it must hold the lock of. */
+static void SymTable_beginWrite(SymTableShm_T oSymTable) {
+    struct ShmHeader *psHeader = oSymTable->header;
+    SymTable_store(&psHeader->sequence, psHeader->sequence + 1);
+    /* Readers must see the odd number before any of the changes */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* Make the sequence number of oSymTable even again after a writer has
+ * changed the table. */
+static void SymTable_endWrite(SymTableShm_T oSymTable) {
+    struct ShmHeader *psHeader = oSymTable->header;
+    __atomic_store_n(&psHeader->sequence, psHeader->sequence + 1,
+                     __ATOMIC_RELEASE);
+}
+
+/* Look up pcKey in oSymTable without taking the lock. Return 1 and store
+ * the value of its binding in *puValue if there is one, or return 0. */
+static int SymTable_read(SymTableShm_T oSymTable, const char *pcKey,
+                         uint64_t *puValue) {
+    struct ShmHeader *psHeader = oSymTable->header;
+    size_t uLength;
+    uint64_t uHash = SymTable_hash(pcKey, &uLength);
+
+    for (;;) {
+        uint64_t uSequence =
+            __atomic_load_n(&psHeader->sequence, __ATOMIC_ACQUIRE);
+        uint64_t uOffset;
+        if (uSequence % 2 != 0) {
+            SymTable_waitWriter(oSymTable);
+            continue;
+        }
+        uOffset = SymTable_search(oSymTable, pcKey, uLength, uHash);
+        if (uOffset != 0)
+            *puValue = SymTable_load(&SymTable_node(oSymTable, uOffset)->value);
+        /* The reads above must be complete before the number is checked */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (SymTable_load(&psHeader->sequence) == uSequence)
+            return uOffset != 0;
+    }
+}
+
+/* Return the offset of a node of oSymTable with room for a key of
+ * uKeyLength bytes, taken from a free list or from the unallocated end of
+ * the object, or 0 if there is none. The caller holds the lock. */
+static uint64_t SymTable_allocNode(SymTableShm_T oSymTable,
+                                   uint64_t uKeyLength) {
+    struct ShmHeader *psHeader = oSymTable->header;
+    uint64_t uSize = SymTable_nodeSize(uKeyLength);
+    size_t uList = SymTable_freeList(uSize);
+    uint64_t *puLink = &psHeader->freeLists[uList];
+    uint64_t uOffset;
+
+    /* Every node of the other lists has the size wanted; the last is
+     * searched for the first node that is large enough */
+    while (*puLink != 0) {
+        struct ShmNode *psNode = SymTable_node(oSymTable, *puLink);
+        if (psNode->size >= uSize) {
+            uOffset = *puLink;
+            *puLink = psNode->next;
+            return uOffset;
+        }
+        puLink = &psNode->next;
+    }
+    if (psHeader->size - psHeader->top < uSize) return 0;
+    uOffset = psHeader->top;
+    psHeader->top += uSize;
+    SymTable_node(oSymTable, uOffset)->size = uSize;
+    return uOffset;
+}
+
+/* Put the node of oSymTable at offset uOffset, which is in no bucket, on
+ * its free list. The caller holds the lock. */
+static void SymTable_freeNode(SymTableShm_T oSymTable, uint64_t uOffset) {
+    struct ShmNode *psNode = SymTable_node(oSymTable, uOffset);
+    uint64_t *puHead =
+        &oSymTable->header->freeLists[SymTable_freeList(psNode->size)];
+    SymTable_store(&psNode->next, *puHead);
+    *puHead = uOffset;
+}
+
+/* Return a new SymTableShm object for the uBytes-byte shared memory object
+ * open on iFd, or NULL if it cannot be mapped or insufficient memory is
+ * available. */
+static SymTableShm_T SymTable_mapObject(int iFd, size_t uBytes) {
+    SymTableShm_T oSymTable;
+    void *pvMapping;
+
+    oSymTable = (SymTableShm_T)malloc(sizeof(struct SymTableShm));
+    if (oSymTable == NULL) return NULL;
+    pvMapping =
+        mmap(NULL, uBytes, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+    if (pvMapping == MAP_FAILED) {
+        free(oSymTable);
+        return NULL;
+    }
+    SymTable_initHeader(&oSymTable->base, &SymTableShm_backend);
+    oSymTable->header = (struct ShmHeader *)pvMapping;
+    oSymTable->size = uBytes;
+    return oSymTable;
+}
+
+/* Unmap the object of oSymTable and free oSymTable. */
+static void SymTable_unmapObject(SymTableShm_T oSymTable) {
+    munmap(oSymTable->header, oSymTable->size);
+    free(oSymTable);
+}
+
+/* Initialize the writers' lock of the new object of oSymTable. Return 1,
+ * or 0 if it cannot be initialized. */
+static int SymTable_initLock(SymTableShm_T oSymTable) {
+    pthread_mutexattr_t sAttributes;
+    int iSuccessful;
+
+    if (pthread_mutexattr_init(&sAttributes) != 0) return 0;
+    iSuccessful =
+        pthread_mutexattr_setpshared(&sAttributes, PTHREAD_PROCESS_SHARED) ==
+            0 &&
+        pthread_mutexattr_setrobust(&sAttributes, PTHREAD_MUTEX_ROBUST) == 0 &&
+        pthread_mutex_init(&oSymTable->header->lock, &sAttributes) == 0;
+    pthread_mutexattr_destroy(&sAttributes);
+    return iSuccessful;
+}
+
+SymTable_T SymTableShm_create(const char *pcName, size_t uBytes) {
+    SymTableShm_T oSymTable;
+    struct ShmHeader *psHeader;
+    uint64_t uBucketCount = 1;
+    int iFd;
+
+    assert(pcName != NULL);
+
+    while (uBucketCount * 2 <= uBytes / BYTES_PER_BUCKET) uBucketCount *= 2;
+    if (uBytes > (size_t)INT64_MAX ||
+        uBytes < SymTable_nodesOffset(uBucketCount) + SymTable_nodeSize(0))
+        return NULL;
+
+    iFd = shm_open(pcName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (iFd < 0) return NULL;
+    if (ftruncate(iFd, (off_t)uBytes) != 0) {
+        close(iFd);
+        shm_unlink(pcName);
+        return NULL;
+    }
+    oSymTable = SymTable_mapObject(iFd, uBytes);
+    close(iFd);
+    if (oSymTable == NULL) {
+        shm_unlink(pcName);
+        return NULL;
+    }
+
+    /* ftruncate filled the object with zeros, which empty the buckets and
+     * the free lists */
+    psHeader = oSymTable->header;
+    psHeader->size = uBytes;
+    psHeader->bucketCount = uBucketCount;
+    psHeader->top = SymTable_nodesOffset(uBucketCount);
+    if (!SymTable_initLock(oSymTable)) {
+        SymTable_unmapObject(oSymTable);
+        shm_unlink(pcName);
+        return NULL;
+    }
+    /* A process that attaches sees the rest of the header before this */
+    __atomic_store_n(&psHeader->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    return &oSymTable->base;
+}
+
+SymTable_T SymTableShm_attach(const char *pcName) {
+    SymTableShm_T oSymTable;
+    struct ShmHeader *psHeader;
+    struct stat sStat;
+    size_t uBytes;
+    int iFd;
+
+    assert(pcName != NULL);
+
+    iFd = shm_open(pcName, O_RDWR, 0);
+    if (iFd < 0) return NULL;
+    if (fstat(iFd, &sStat) != 0 ||
+        (size_t)sStat.st_size < sizeof(struct ShmHeader)) {
+        close(iFd);
+        return NULL;
+    }
+    uBytes = (size_t)sStat.st_size;
+    oSymTable = SymTable_mapObject(iFd, uBytes);
+    close(iFd);
+    if (oSymTable == NULL) return NULL;
+
+    psHeader = oSymTable->header;
+    if (__atomic_load_n(&psHeader->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC ||
+        psHeader->size != uBytes || psHeader->bucketCount == 0 ||
+        (psHeader->bucketCount & (psHeader->bucketCount - 1)) != 0 ||
+        psHeader->bucketCount > uBytes / sizeof(uint64_t) ||
+        SymTable_nodesOffset(psHeader->bucketCount) > uBytes) {
+        SymTable_unmapObject(oSymTable);
+        return NULL;
+    }
+    return &oSymTable->base;
+}
+
+int SymTableShm_unlink(const char *pcName) {
+    assert(pcName != NULL);
+    return shm_unlink(pcName) == 0;
+}
+
+/* Shared tables are created only by SymTableShm_create and
+ * SymTableShm_attach, so return NULL. */
+static SymTable_T SymTableShm_new(void) { return NULL; }
+
+static void SymTableShm_free(SymTable_T oBase) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    assert(oSymTable != NULL);
+    SymTable_unmapObject(oSymTable);
+}
+
+static size_t SymTableShm_getLength(SymTable_T oBase) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    assert(oSymTable != NULL);
+    return (size_t)SymTable_load(&oSymTable->header->numBindings);
+}
+
+static int SymTableShm_put(SymTable_T oBase, const char *pcKey,
+                           const void *pvValue) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    struct ShmNode *psNode;
+    uint64_t *puBucket;
+    uint64_t uHash, uOffset;
+    size_t uLength;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey, &uLength);
+    puBucket = SymTable_bucket(oSymTable, uHash);
+    SymTable_lock(oSymTable);
+    if (SymTable_search(oSymTable, pcKey, uLength, uHash) != 0 ||
+        (uOffset = SymTable_allocNode(oSymTable, uLength)) == 0) {
+        SymTable_unlock(oSymTable);
+        return 0;
+    }
+
+    SymTable_beginWrite(oSymTable);
+    psNode = SymTable_node(oSymTable, uOffset);
+    SymTable_store(&psNode->next, *puBucket);
+    SymTable_store(&psNode->hash, uHash);
+    SymTable_store(&psNode->value, (uint64_t)(uintptr_t)pvValue);
+    SymTable_store(&psNode->keyLength, uLength);
+    memcpy(SymTable_nodeKey(psNode), pcKey, uLength + 1);
+    SymTable_store(puBucket, uOffset);
+    SymTable_store(&oSymTable->header->numBindings,
+                   oSymTable->header->numBindings + 1);
+    SymTable_endWrite(oSymTable);
+    SymTable_unlock(oSymTable);
+    return 1;
+}
+
+static void *SymTableShm_replace(SymTable_T oBase, const char *pcKey,
+                                 const void *pvValue) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    struct ShmNode *psNode;
+    uint64_t uHash, uOffset, uOldValue;
+    size_t uLength;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey, &uLength);
+    SymTable_lock(oSymTable);
+    uOffset = SymTable_search(oSymTable, pcKey, uLength, uHash);
+    if (uOffset == 0) {
+        SymTable_unlock(oSymTable);
+        return NULL;
+    }
+    psNode = SymTable_node(oSymTable, uOffset);
+    uOldValue = psNode->value;
+    SymTable_beginWrite(oSymTable);
+    SymTable_store(&psNode->value, (uint64_t)(uintptr_t)pvValue);
+    SymTable_endWrite(oSymTable);
+    SymTable_unlock(oSymTable);
+    return (void *)(uintptr_t)uOldValue;
+}
+
+static int SymTableShm_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    uint64_t uValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_read(oSymTable, pcKey, &uValue);
+}
+
+static void *SymTableShm_get(SymTable_T oBase, const char *pcKey) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    uint64_t uValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!SymTable_read(oSymTable, pcKey, &uValue)) return NULL;
+    return (void *)(uintptr_t)uValue;
+}
+
+static void *SymTableShm_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    struct ShmNode *psNode = NULL;
+    uint64_t *puLink;
+    uint64_t uHash, uOffset, uValue;
+    size_t uLength;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey, &uLength);
+    SymTable_lock(oSymTable);
+    for (puLink = SymTable_bucket(oSymTable, uHash); *puLink != 0;
+         puLink = &psNode->next) {
+        psNode = SymTable_node(oSymTable, *puLink);
+        if (psNode->hash == uHash && psNode->keyLength == uLength &&
+            SYMTABLE_STRCMP(&oSymTable->base, SymTable_nodeKey(psNode),
+                            pcKey) == 0)
+            break;
+    }
+    if (*puLink == 0) {
+        SymTable_unlock(oSymTable);
+        return NULL;
+    }
+
+    uOffset = *puLink;
+    uValue = psNode->value;
+    SymTable_beginWrite(oSymTable);
+    SymTable_store(puLink, psNode->next);
+    SymTable_freeNode(oSymTable, uOffset);
+    SymTable_store(&oSymTable->header->numBindings,
+                   oSymTable->header->numBindings - 1);
+    SymTable_endWrite(oSymTable);
+    SymTable_unlock(oSymTable);
+    return (void *)(uintptr_t)uValue;
+}
+
+static void SymTableShm_map(SymTable_T oBase,
+                            void (*pfApply)(const char *pcKey, void *pvValue,
+                                            void *pvExtra),
+                            const void *pvExtra) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    uint64_t u;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    SymTable_lock(oSymTable);
+    for (u = 0; u < oSymTable->header->bucketCount; u++) {
+        uint64_t uOffset = *SymTable_bucket(oSymTable, u);
+        while (uOffset != 0) {
+            struct ShmNode *psNode = SymTable_node(oSymTable, uOffset);
+            (*pfApply)(SymTable_nodeKey(psNode),
+                       (void *)(uintptr_t)psNode->value, (void *)pvExtra);
+            uOffset = psNode->next;
+        }
+    }
+    SymTable_unlock(oSymTable);
+}
+
+static void SymTableShm_getStats(SymTable_T oBase,
+                                 struct SymTableStats *psStats) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    uint64_t u;
+
+    assert(oSymTable != NULL);
+    assert(psStats != NULL);
+
+    SymTable_lock(oSymTable);
+    for (u = 0; u < oSymTable->header->bucketCount; u++) {
+        uint64_t uOffset = *SymTable_bucket(oSymTable, u);
+        size_t uLength = 0;
+        for (; uOffset != 0; uOffset = SymTable_node(oSymTable, uOffset)->next)
+            uLength++;
+        SymTable_addChain(psStats, uLength);
+    }
+#ifdef SYMTABLE_STATS
+    /* The object is shared, so its bytes in use are counted here rather
+     * than by any one process */
+    psStats->bytesAllocated += (size_t)oSymTable->header->top;
+#endif
+    SymTable_unlock(oSymTable);
+}
+
+/* Put the binding of pcKey and pvValue into the clone of the CloneState
+ * pvState. */
+static void SymTable_putClone(const char *pcKey, void *pvValue,
+                              void *pvState) {
+    struct CloneState *psState = (struct CloneState *)pvState;
+    if (psState->ok && !SymTable_put(psState->clone, pcKey, pvValue))
+        psState->ok = 0;
+}
+
+static SymTable_T SymTableShm_clone(SymTable_T oBase) {
+    SymTableShm_T oSymTable = (SymTableShm_T)oBase;
+    struct CloneState sState;
+    assert(oSymTable != NULL);
+    sState.clone = SymTable_newWithBackend("hash");
+    if (sState.clone == NULL) return NULL;
+    sState.ok = 1;
+    /* A failed reservation only costs rehashing */
+    (void)SymTable_reserve(sState.clone, SymTableShm_getLength(oBase));
+    SymTableShm_map(oBase, SymTable_putClone, &sState);
+    if (!sState.ok) {
+        SymTable_free(sState.clone);
+        return NULL;
+    }
+    return sState.clone;
+}
+
+/* The function table of shared tables, which is not registered because
+ * they need a shared memory object to be created */
+const struct SymTableBackend SymTableShm_backend = {
+    "shm",
+    SymTableShm_new,
+    SymTableShm_free,
+    SymTableShm_getLength,
+    SymTableShm_put,
+    SymTableShm_replace,
+    SymTableShm_contains,
+    SymTableShm_get,
+    SymTableShm_remove,
+    SymTableShm_map,
+    SymTableShm_getStats,
+    SymTableShm_clone,
+    NULL,
+    NULL};
@@ -0,0 +1,55 @@
+/*--------------------------------------------------------------------*/
+/* symtableshm.h                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESHM_H
+#define SYMTABLESHM_H
+
+#include <stddef.h>
+
+#include "symtable.h"
+
+/* A shared SymTable object keeps its buckets, bindings, and keys in a POSIX
+ * shared memory object, linked by offsets from its start rather than by
+ * pointers, so that one process can build the table and any number of
+ * others can attach to it and use it concurrently, each at whatever
+ * address it maps the object. Writers take a process-shared lock and
+ * bump a sequence number around each change; SymTable_get and
+ * SymTable_contains take no lock but read optimistically and retry if the
+ * sequence number shows a change overlapped them, so readers never block
+ * one another. The table never grows: SymTable_put fails as if
+ * insufficient memory were available once the object is full, and the
+ * space of removed bindings is reused by later ones. SymTable_map holds the
+ * lock throughout, so its function must not change the table. Like any
+ * SymTable object, each one is used by one thread at a time: threads of one
+ * process that share a table each attach to it.
+ *
+ * The table stores the bits of each value pointer, not what it points to,
+ * so values must mean the same in every process: NULL, small integers cast
+ * to void *, offsets into shared memory, and the like. */
+
+/* Return a shared SymTable object that contains no bindings, in a new
+ * shared memory object named pcName (a name such as "/symbols" as
+ * shm_open expects) of uBytes bytes, whose buckets are sized for about
+ * one binding with a short key per 64 bytes. Return NULL if an object
+ * named pcName already exists, if uBytes is too small to hold any binding,
+ * or if the object cannot be created or insufficient memory is available.
+ * The object outlives the table and the process; remove it with
+ * SymTableShm_unlink. */
+SymTable_T SymTableShm_create(const char *pcName, size_t uBytes);
+
+/* Return a shared SymTable object for the table that SymTableShm_create
+ * built in the shared memory object named pcName, or NULL if there is no
+ * such object, it does not hold such a table, or insufficient memory is
+ * available. SymTable_free unmaps the object from the calling process and
+ * leaves the table to the other processes. SymTable_clone returns an
+ * ordinary "hash" table of the same bindings. */
+SymTable_T SymTableShm_attach(const char *pcName);
+
+/* Remove the name pcName of a shared memory object, which is destroyed
+ * once every process has freed its tables in it. Return 1, or 0 if there
+ * is no such object. */
+int SymTableShm_unlink(const char *pcName);
+
+#endif
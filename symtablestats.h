@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------*/
+/* symtablestats.h                                                    */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESTATS_H
+#define SYMTABLESTATS_H
+
+#include "symtable.h"
+
+/* Enum containing the number of entries in the chain length histogram and in
+ * each operation latency histogram */
+enum { SYMTABLE_CHAIN_HISTOGRAM_SIZE = 16, SYMTABLE_LATENCY_BUCKETS = 32 };
+
+/* The SymTable operations whose latency is recorded */
+enum SymTableOperation {
+    SYMTABLE_OP_PUT,
+    SYMTABLE_OP_REPLACE,
+    SYMTABLE_OP_CONTAINS,
+    SYMTABLE_OP_GET,
+    SYMTABLE_OP_REMOVE,
+    SYMTABLE_OP_MAP,
+    SYMTABLE_OP_COUNT
+};
+
+/* A SymTableStats object describes the shape of a SymTable and the work it
+ * has done. A chain is a bucket of a hash table, or the whole list or inline
+ * array of a backend that has no buckets. */
+struct SymTableStats {
+    /* Number of bindings */
+    size_t numBindings;
+    /* Number of chains */
+    size_t numChains;
+    /* Bindings per chain */
+    double loadFactor;
+    /* Length of the longest chain */
+    size_t maxChainLength;
+    /* Mean length of the non-empty chains */
+    double meanChainLength;
+    /* chainHistogram[i] is the number of chains of length i; the last entry
+     * also counts all longer chains */
+    size_t chainHistogram[SYMTABLE_CHAIN_HISTOGRAM_SIZE];
+
+    /* The remaining fields are zero unless the table was built with
+     * SYMTABLE_STATS defined. */
+
+    /* Number of times the table resized itself */
+    size_t resizeCount;
+    /* Total wall-clock time spent resizing, in nanoseconds */
+    double resizeNs;
+    /* Number of key comparisons (strcmp calls) performed */
+    size_t keyComparisons;
+    /* Bytes currently allocated by the table, including its keys */
+    size_t bytesAllocated;
+
+    /* latencyHistogram[op][i] is the number of operations op that took
+     * between 2^i and 2^(i+1) - 1 nanoseconds. Zero unless the table was built
+     * with SYMTABLE_LATENCY defined as well. */
+    size_t latencyHistogram[SYMTABLE_OP_COUNT][SYMTABLE_LATENCY_BUCKETS];
+};
+
+/* Fills *psStats with the statistics of oSymTable. The shape is computed by
+ * walking the table, so this takes time proportional to its size. Returns 1
+ * if the counters are maintained by this build, or 0 if they are all zero. */
+int SymTable_getStats(SymTable_T oSymTable, struct SymTableStats *psStats);
+
+#endif
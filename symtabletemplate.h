@@ -0,0 +1,381 @@
+/*--------------------------------------------------------------------*/
+/* symtabletemplate.h                                                 */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+/* This header is a template for hash tables specialized to a key type and
+ * a value type. Keys and values are stored unboxed in flat arrays of an
+ * open-addressing table with linear probing, and the hash and equality
+ * functions are named at compile time, so the compiler can inline them.
+ * To instantiate a table, define these macros and include this header:
+ *
+ *   SYMTABLE_TEMPLATE_NAME   the name of the table type, which prefixes
+ *                            the names of its functions
+ *   SYMTABLE_TEMPLATE_KEY    the key type
+ *   SYMTABLE_TEMPLATE_VALUE  the value type
+ *   SYMTABLE_TEMPLATE_HASH   a function or macro that maps a key to a
+ *                            uint64_t whose low bits are well mixed, such
+ *                            as SymTableTemplate_hashInt
+ *   SYMTABLE_TEMPLATE_EQUAL  a function or macro that returns nonzero if
+ *                            two keys are equal, such as
+ *                            SymTableTemplate_equal
+ *
+ * The header undefines them, so it can be included again for another
+ * table. For example,
+ *
+ *   #define SYMTABLE_TEMPLATE_NAME PointTable
+ *   #define SYMTABLE_TEMPLATE_KEY uint32_t
+ *   #define SYMTABLE_TEMPLATE_VALUE struct Point
+ *   #define SYMTABLE_TEMPLATE_HASH SymTableTemplate_hashInt
+ *   #define SYMTABLE_TEMPLATE_EQUAL SymTableTemplate_equal
+ *   #include "symtabletemplate.h"
+ *
+ * defines the type PointTable and static functions such as PointTable_put.
+ * The table stores keys as they are, so a key that points to memory, such
+ * as a string, must outlive its binding. */
+
+#ifndef SYMTABLETEMPLATE_H
+#define SYMTABLETEMPLATE_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Return a 64-bit value that depends on every bit of the integer uKey (the
+ * splitmix64 finalizer). */
+static inline uint64_t SymTableTemplate_hashInt(uint64_t uKey) {
+    uKey = (uKey ^ (uKey >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    uKey = (uKey ^ (uKey >> 27)) * 0x94d049bb133111ebULL;
+    return uKey ^ (uKey >> 31);
+}
+
+/* Return the hash of the string pcKey (FNV-1a, mixed by the splitmix64
+ * finalizer). */
+static inline uint64_t SymTableTemplate_hashString(const char *pcKey) {
+    uint64_t uHash = 0xcbf29ce484222325ULL;
+    for (; *pcKey != '\0'; pcKey++)
+        uHash = (uHash ^ (unsigned char)*pcKey) * 0x100000001b3ULL;
+    return SymTableTemplate_hashInt(uHash);
+}
+
+/* Whether the keys xKey1 and xKey2, of a type that == compares, are
+ * equal */
+#define SymTableTemplate_equal(xKey1, xKey2) ((xKey1) == (xKey2))
+
+/* The name of the function xSuffix of an instantiation. The suffix is
+ * pasted before it can be expanded, so suffixes such as free stay intact
+ * even where a memory checker defines them as macros. */
+#define SYMTABLE_TEMPLATE_PASTE2(xName, xSuffix) xName##xSuffix
+#define SYMTABLE_TEMPLATE_PASTE(xName, xSuffix) \
+    SYMTABLE_TEMPLATE_PASTE2(xName, xSuffix)
+#define SYMTABLE_TEMPLATE_FN(xSuffix) \
+    SYMTABLE_TEMPLATE_PASTE(SYMTABLE_TEMPLATE_NAME, _##xSuffix)
+
+/* Enum containing the initial number of slots of an instantiated table, a
+ * power of two, and the load factor, as a fraction, above which it doubles
+ * its slots */
+enum {
+    SYMTABLE_TEMPLATE_INITIAL_CAPACITY = 16,
+    SYMTABLE_TEMPLATE_MAX_LOAD_NUMERATOR = 3,
+    SYMTABLE_TEMPLATE_MAX_LOAD_DENOMINATOR = 4
+};
+
+#endif
+
+#if !defined(SYMTABLE_TEMPLATE_NAME) || !defined(SYMTABLE_TEMPLATE_KEY) || \
+    !defined(SYMTABLE_TEMPLATE_VALUE) || !defined(SYMTABLE_TEMPLATE_HASH) || \
+    !defined(SYMTABLE_TEMPLATE_EQUAL)
+#error "symtabletemplate.h needs all of its SYMTABLE_TEMPLATE_ macros"
+#endif
+
+/* A table is an open-addressing hash table with linear probing. Slot i
+ * holds the key keys[i] and the value values[i] if used[i] is nonzero.
+ * Removal shifts the bindings that follow back into the freed slot, so
+ * there are no tombstones and a search stops at the first unused slot. */
+typedef struct SYMTABLE_TEMPLATE_NAME {
+    /* Key of each slot */
+    SYMTABLE_TEMPLATE_KEY *keys;
+    /* Value of each slot */
+    SYMTABLE_TEMPLATE_VALUE *values;
+    /* Whether each slot holds a binding */
+    unsigned char *used;
+    /* Number of slots, a power of two */
+    size_t capacity;
+    /* Number of bindings */
+    size_t numBindings;
+} SYMTABLE_TEMPLATE_NAME;
+
+/* Return the slot of poTable at which the search for xKey starts. */
+static inline size_t SYMTABLE_TEMPLATE_FN(home)(
+    const SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey) {
+    return (size_t)SYMTABLE_TEMPLATE_HASH(xKey) & (poTable->capacity - 1);
+}
+
+/* Return the slot of poTable that holds xKey, or the unused slot at which
+ * the search for it ended. */
+static inline size_t SYMTABLE_TEMPLATE_FN(find)(
+    const SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey) {
+    size_t uMask = poTable->capacity - 1;
+    size_t uSlot = SYMTABLE_TEMPLATE_FN(home)(poTable, xKey);
+    while (poTable->used[uSlot] &&
+           !SYMTABLE_TEMPLATE_EQUAL(poTable->keys[uSlot], xKey))
+        uSlot = (uSlot + 1) & uMask;
+    return uSlot;
+}
+
+/* Make *poTable use new arrays of uCapacity slots, which must be a power
+ * of two, and free the old ones, or free them all if uCapacity is 0.
+ * Return 1, or 0 if insufficient memory is available, in which case
+ * *poTable is unchanged. Bindings are not moved. */
+static inline int SYMTABLE_TEMPLATE_FN(setArrays)(
+    SYMTABLE_TEMPLATE_NAME *poTable, size_t uCapacity) {
+    SYMTABLE_TEMPLATE_KEY *axKeys = NULL;
+    SYMTABLE_TEMPLATE_VALUE *axValues = NULL;
+    unsigned char *aucUsed = NULL;
+    if (uCapacity != 0) {
+        axKeys = (SYMTABLE_TEMPLATE_KEY *)malloc(
+            uCapacity * sizeof(SYMTABLE_TEMPLATE_KEY));
+        axValues = (SYMTABLE_TEMPLATE_VALUE *)malloc(
+            uCapacity * sizeof(SYMTABLE_TEMPLATE_VALUE));
+        aucUsed = (unsigned char *)calloc(uCapacity, 1);
+        if (axKeys == NULL || axValues == NULL || aucUsed == NULL) {
+            free(axKeys);
+            free(axValues);
+            free(aucUsed);
+            return 0;
+        }
+    }
+    free(poTable->keys);
+    free(poTable->values);
+    free(poTable->used);
+    poTable->keys = axKeys;
+    poTable->values = axValues;
+    poTable->used = aucUsed;
+    poTable->capacity = uCapacity;
+    return 1;
+}
+
+/* Initialize *poTable as a table that contains no bindings. Return 1, or 0
+ * if insufficient memory is available. */
+static inline int SYMTABLE_TEMPLATE_FN(init)(
+    SYMTABLE_TEMPLATE_NAME *poTable) {
+    assert(poTable != NULL);
+    poTable->keys = NULL;
+    poTable->values = NULL;
+    poTable->used = NULL;
+    poTable->capacity = 0;
+    poTable->numBindings = 0;
+    return SYMTABLE_TEMPLATE_FN(setArrays)(
+        poTable, SYMTABLE_TEMPLATE_INITIAL_CAPACITY);
+}
+
+/* Free the memory occupied by the bindings of *poTable, which init
+ * initialized. */
+static inline void SYMTABLE_TEMPLATE_FN(destroy)(
+    SYMTABLE_TEMPLATE_NAME *poTable) {
+    assert(poTable != NULL);
+    SYMTABLE_TEMPLATE_FN(setArrays)(poTable, 0);
+    poTable->numBindings = 0;
+}
+
+/* Return a new table that contains no bindings, or NULL if insufficient
+ * memory is available. */
+static inline SYMTABLE_TEMPLATE_NAME *SYMTABLE_TEMPLATE_FN(new)(void) {
+    SYMTABLE_TEMPLATE_NAME *poTable =
+        (SYMTABLE_TEMPLATE_NAME *)malloc(sizeof(SYMTABLE_TEMPLATE_NAME));
+    if (poTable == NULL) return NULL;
+    if (!SYMTABLE_TEMPLATE_FN(init)(poTable)) {
+        free(poTable);
+        return NULL;
+    }
+    return poTable;
+}
+
+/* Free all memory occupied by poTable, which new returned. */
+static inline void SYMTABLE_TEMPLATE_FN(free)(
+    SYMTABLE_TEMPLATE_NAME *poTable) {
+    SYMTABLE_TEMPLATE_FN(destroy)(poTable);
+    free(poTable);
+}
+
+/* Return the number of bindings in poTable. */
+static inline size_t SYMTABLE_TEMPLATE_FN(getLength)(
+    const SYMTABLE_TEMPLATE_NAME *poTable) {
+    assert(poTable != NULL);
+    return poTable->numBindings;
+}
+
+/* Prepare poTable to hold uCount bindings without resizing. Return 1, or 0
+ * if insufficient memory is available; poTable is usable either way. */
+static inline int SYMTABLE_TEMPLATE_FN(reserve)(
+    SYMTABLE_TEMPLATE_NAME *poTable, size_t uCount) {
+    SYMTABLE_TEMPLATE_NAME oNew;
+    size_t uCapacity;
+    size_t i;
+    assert(poTable != NULL);
+
+    uCapacity = poTable->capacity;
+    while (uCount > uCapacity / SYMTABLE_TEMPLATE_MAX_LOAD_DENOMINATOR *
+                        SYMTABLE_TEMPLATE_MAX_LOAD_NUMERATOR) {
+        if (uCapacity > (size_t)-1 / 2 / sizeof(SYMTABLE_TEMPLATE_VALUE) ||
+            uCapacity > (size_t)-1 / 2 / sizeof(SYMTABLE_TEMPLATE_KEY))
+            return 0;
+        uCapacity *= 2;
+    }
+    if (uCapacity == poTable->capacity) return 1;
+
+    oNew.keys = NULL;
+    oNew.values = NULL;
+    oNew.used = NULL;
+    if (!SYMTABLE_TEMPLATE_FN(setArrays)(&oNew, uCapacity)) return 0;
+    for (i = 0; i < poTable->capacity; i++)
+        if (poTable->used[i]) {
+            size_t uSlot = SYMTABLE_TEMPLATE_FN(find)(&oNew, poTable->keys[i]);
+            oNew.keys[uSlot] = poTable->keys[i];
+            oNew.values[uSlot] = poTable->values[i];
+            oNew.used[uSlot] = 1;
+        }
+    oNew.numBindings = poTable->numBindings;
+    SYMTABLE_TEMPLATE_FN(destroy)(poTable);
+    *poTable = oNew;
+    return 1;
+}
+
+/* Return 1 and add a new binding to poTable consisting of key xKey and
+ * value xValue if poTable does not contain a binding with key xKey and if
+ * sufficient memory is available, otherwise return 0. */
+static inline int SYMTABLE_TEMPLATE_FN(put)(SYMTABLE_TEMPLATE_NAME *poTable,
+                                            SYMTABLE_TEMPLATE_KEY xKey,
+                                            SYMTABLE_TEMPLATE_VALUE xValue) {
+    size_t uSlot;
+    assert(poTable != NULL);
+
+    uSlot = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    if (poTable->used[uSlot]) return 0;
+    if (poTable->numBindings + 1 >
+        poTable->capacity / SYMTABLE_TEMPLATE_MAX_LOAD_DENOMINATOR *
+            SYMTABLE_TEMPLATE_MAX_LOAD_NUMERATOR) {
+        if (!SYMTABLE_TEMPLATE_FN(reserve)(poTable, poTable->numBindings + 1))
+            return 0;
+        uSlot = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    }
+    poTable->keys[uSlot] = xKey;
+    poTable->values[uSlot] = xValue;
+    poTable->used[uSlot] = 1;
+    poTable->numBindings++;
+    return 1;
+}
+
+/* Return a pointer to the value of the binding within poTable whose key is
+ * xKey, or NULL if no such binding exists. The pointer is valid until the
+ * next put or remove. */
+static inline SYMTABLE_TEMPLATE_VALUE *SYMTABLE_TEMPLATE_FN(lookup)(
+    SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey) {
+    size_t uSlot;
+    assert(poTable != NULL);
+    uSlot = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    return poTable->used[uSlot] ? &poTable->values[uSlot] : NULL;
+}
+
+/* Return 1 if poTable contains a binding whose key is xKey, and 0
+ * otherwise. */
+static inline int SYMTABLE_TEMPLATE_FN(contains)(
+    const SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey) {
+    assert(poTable != NULL);
+    return poTable->used[SYMTABLE_TEMPLATE_FN(find)(poTable, xKey)];
+}
+
+/* If poTable contains a binding whose key is xKey, store its value in
+ * *pxValue and return 1, otherwise return 0. */
+static inline int SYMTABLE_TEMPLATE_FN(get)(
+    const SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey,
+    SYMTABLE_TEMPLATE_VALUE *pxValue) {
+    size_t uSlot;
+    assert(poTable != NULL);
+    assert(pxValue != NULL);
+    uSlot = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    if (!poTable->used[uSlot]) return 0;
+    *pxValue = poTable->values[uSlot];
+    return 1;
+}
+
+/* If poTable contains a binding whose key is xKey, replace its value with
+ * xValue, store the old value in *pxOldValue unless pxOldValue is NULL, and
+ * return 1, otherwise return 0. */
+static inline int SYMTABLE_TEMPLATE_FN(replace)(
+    SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey,
+    SYMTABLE_TEMPLATE_VALUE xValue, SYMTABLE_TEMPLATE_VALUE *pxOldValue) {
+    size_t uSlot;
+    assert(poTable != NULL);
+    uSlot = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    if (!poTable->used[uSlot]) return 0;
+    if (pxOldValue != NULL) *pxOldValue = poTable->values[uSlot];
+    poTable->values[uSlot] = xValue;
+    return 1;
+}
+
+/* If poTable contains a binding whose key is xKey, store its value in
+ * *pxValue unless pxValue is NULL, remove the binding, and return 1,
+ * otherwise return 0. */
+static inline int SYMTABLE_TEMPLATE_FN(remove)(
+    SYMTABLE_TEMPLATE_NAME *poTable, SYMTABLE_TEMPLATE_KEY xKey,
+    SYMTABLE_TEMPLATE_VALUE *pxValue) {
+    size_t uMask;
+    size_t uHole;
+    size_t uSlot;
+    assert(poTable != NULL);
+
+    uHole = SYMTABLE_TEMPLATE_FN(find)(poTable, xKey);
+    if (!poTable->used[uHole]) return 0;
+    if (pxValue != NULL) *pxValue = poTable->values[uHole];
+    poTable->numBindings--;
+
+    /* Move each following binding of the run whose search passes the hole
+     * back into it, so that no search stops early */
+    uMask = poTable->capacity - 1;
+    for (uSlot = (uHole + 1) & uMask; poTable->used[uSlot];
+         uSlot = (uSlot + 1) & uMask) {
+        size_t uHome =
+            SYMTABLE_TEMPLATE_FN(home)(poTable, poTable->keys[uSlot]);
+        if (((uSlot - uHome) & uMask) >= ((uSlot - uHole) & uMask)) {
+            poTable->keys[uHole] = poTable->keys[uSlot];
+            poTable->values[uHole] = poTable->values[uSlot];
+            uHole = uSlot;
+        }
+    }
+    poTable->used[uHole] = 0;
+    return 1;
+}
+
+/* Store the key and value of the next binding of poTable at or after the
+ * position *puCursor in *pxKey and *pxValue, either of which may be NULL,
+ * advance *puCursor past it, and return 1, or return 0 if there is none.
+ * Starting with *puCursor 0 visits every binding once, in no particular
+ * order, as long as no binding is added or removed meanwhile:
+ *
+ *   for (uCursor = 0; Name_next(poTable, &uCursor, &xKey, &xValue); )
+ *       ...
+ */
+static inline int SYMTABLE_TEMPLATE_FN(next)(
+    const SYMTABLE_TEMPLATE_NAME *poTable, size_t *puCursor,
+    SYMTABLE_TEMPLATE_KEY *pxKey, SYMTABLE_TEMPLATE_VALUE *pxValue) {
+    size_t i;
+    assert(poTable != NULL);
+    assert(puCursor != NULL);
+    for (i = *puCursor; i < poTable->capacity; i++)
+        if (poTable->used[i]) {
+            if (pxKey != NULL) *pxKey = poTable->keys[i];
+            if (pxValue != NULL) *pxValue = poTable->values[i];
+            *puCursor = i + 1;
+            return 1;
+        }
+    *puCursor = poTable->capacity;
+    return 0;
+}
+
+#undef SYMTABLE_TEMPLATE_NAME
+#undef SYMTABLE_TEMPLATE_KEY
+#undef SYMTABLE_TEMPLATE_VALUE
+#undef SYMTABLE_TEMPLATE_HASH
+#undef SYMTABLE_TEMPLATE_EQUAL
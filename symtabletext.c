@@ -0,0 +1,185 @@
+/*--------------------------------------------------------------------*/
+/* symtabletext.c                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "symtabletext.h"
+
+/* Enum containing the size of the stdio buffer used for exporting */
+enum { EXPORT_BUFFER_SIZE = 1024 * 1024 };
+
+/* A SymTableText object is the contents of an imported file, with each
+ * key and value terminated in place. */
+struct SymTableText {
+    /* The contents, with room for one more '\0' at the end */
+    char *contents;
+};
+
+/* An ExportState object is the state of an export being written by
+ * SymTable_map. */
+struct ExportState {
+    /* The file being written */
+    FILE *file;
+    /* 0 once a binding could not be written */
+    int ok;
+};
+
+/* Read the whole file pcPath into a new buffer with room for one more byte,
+ * store its length in *puLength, and return it, or return NULL if an I/O
+ * error occurs or insufficient memory is available. */
+static char *SymTable_readText(const char *pcPath, size_t *puLength) {
+    struct stat sStat;
+    char *pcContents;
+    size_t uRead = 0;
+    int iFd = open(pcPath, O_RDONLY);
+    if (iFd < 0) return NULL;
+    if (fstat(iFd, &sStat) != 0) {
+        close(iFd);
+        return NULL;
+    }
+    pcContents = (char *)malloc((size_t)sStat.st_size + 1);
+    if (pcContents == NULL) {
+        close(iFd);
+        return NULL;
+    }
+    while (uRead < (size_t)sStat.st_size) {
+        ssize_t iCount =
+            read(iFd, pcContents + uRead, (size_t)sStat.st_size - uRead);
+        if (iCount < 0 && errno == EINTR) continue;
+        if (iCount <= 0) {
+            close(iFd);
+            free(pcContents);
+            return NULL;
+        }
+        uRead += (size_t)iCount;
+    }
+    close(iFd);
+    *puLength = uRead;
+    return pcContents;
+}
+
+/* Return the number of lines in the uLength bytes at pcText, counting a
+ * last line that lacks its newline. */
+static size_t SymTable_countLines(const char *pcText, size_t uLength) {
+    const char *pcEnd = pcText + uLength;
+    size_t uCount = 0;
+    while (pcText < pcEnd) {
+        const char *pcNewline =
+            (const char *)memchr(pcText, '\n', (size_t)(pcEnd - pcText));
+        uCount++;
+        if (pcNewline == NULL) break;
+        pcText = pcNewline + 1;
+    }
+    return uCount;
+}
+
+/* Bind pcKey to pvValue in oSymTable, whether or not pcKey is bound
+ * already. Return 1, or 0 if insufficient memory is available. */
+static int SymTable_set(SymTable_T oSymTable, const char *pcKey,
+                        void *pvValue) {
+    if (SymTable_put(oSymTable, pcKey, pvValue)) return 1;
+    if (!SymTable_contains(oSymTable, pcKey)) return 0;
+    SymTable_replace(oSymTable, pcKey, pvValue);
+    return SymTable_get(oSymTable, pcKey) == pvValue;
+}
+
+SymTable_T SymTableText_import(const char *pcPath, const char *pcBackend,
+                               SymTableText_T *poText) {
+    SymTableText_T oText;
+    SymTable_T oSymTable;
+    char *pcLine, *pcEnd;
+    size_t uLength;
+    assert(pcPath != NULL);
+    assert(pcBackend != NULL);
+    assert(poText != NULL);
+
+    oText = (SymTableText_T)malloc(sizeof(struct SymTableText));
+    if (oText == NULL) return NULL;
+    oText->contents = SymTable_readText(pcPath, &uLength);
+    if (oText->contents == NULL) {
+        free(oText);
+        return NULL;
+    }
+    oSymTable = SymTable_newWithBackend(pcBackend);
+    if (oSymTable == NULL) {
+        SymTableText_free(oText);
+        return NULL;
+    }
+    /* Reserving is only an optimization, so its failure is not fatal */
+    SymTable_reserve(oSymTable, SymTable_countLines(oText->contents, uLength));
+
+    /* Terminate each key and value in place, so that no line is copied */
+    pcLine = oText->contents;
+    pcEnd = pcLine + uLength;
+    while (pcLine < pcEnd) {
+        char *pcNewline =
+            (char *)memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        char *pcTab, *pcValue = NULL;
+        if (pcNewline == NULL) pcNewline = pcEnd;
+        *pcNewline = '\0';
+        pcTab = (char *)memchr(pcLine, '\t', (size_t)(pcNewline - pcLine));
+        if (pcTab != NULL) {
+            *pcTab = '\0';
+            pcValue = pcTab + 1;
+        }
+        if (!SymTable_set(oSymTable, pcLine, pcValue)) {
+            SymTable_free(oSymTable);
+            SymTableText_free(oText);
+            return NULL;
+        }
+        pcLine = pcNewline + 1;
+    }
+    *poText = oText;
+    return oSymTable;
+}
+
+void SymTableText_free(SymTableText_T oText) {
+    assert(oText != NULL);
+    free(oText->contents);
+    free(oText);
+}
+
+/* Write the binding of pcKey and pvValue, a string or NULL, as a line to
+ * the file that *pvExtra, a struct ExportState, is writing. */
+static void SymTable_writeLine(const char *pcKey, void *pvValue,
+                               void *pvExtra) {
+    struct ExportState *psState = (struct ExportState *)pvExtra;
+    const char *pcValue = (const char *)pvValue;
+    if (!psState->ok) return;
+    if (strpbrk(pcKey, "\t\n") != NULL ||
+        (pcValue != NULL && strchr(pcValue, '\n') != NULL)) {
+        psState->ok = 0;
+        return;
+    }
+    fputs(pcKey, psState->file);
+    if (pcValue != NULL) {
+        putc('\t', psState->file);
+        fputs(pcValue, psState->file);
+    }
+    if (putc('\n', psState->file) == EOF) psState->ok = 0;
+}
+
+int SymTableText_export(SymTable_T oSymTable, const char *pcPath) {
+    struct ExportState sState;
+    assert(oSymTable != NULL);
+    assert(pcPath != NULL);
+
+    sState.file = fopen(pcPath, "w");
+    if (sState.file == NULL) return 0;
+    sState.ok = setvbuf(sState.file, NULL, _IOFBF, EXPORT_BUFFER_SIZE) == 0;
+    if (sState.ok) SymTable_map(oSymTable, SymTable_writeLine, &sState);
+    if (ferror(sState.file)) sState.ok = 0;
+    if (fclose(sState.file) != 0) sState.ok = 0;
+    return sState.ok;
+}
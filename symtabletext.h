@@ -0,0 +1,38 @@
+/*--------------------------------------------------------------------*/
+/* symtabletext.h                                                     */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLETEXT_H
+#define SYMTABLETEXT_H
+
+#include "symtable.h"
+
+/* Text files of bindings hold one binding per line: the key, a tab, and the
+ * value, a string, followed by a newline. A line without a tab binds its
+ * key to NULL. Keys therefore cannot contain tabs or newlines, and values
+ * cannot contain newlines. */
+
+/* A SymTableText_T owns the contents of an imported file, which the values
+ * of the imported bindings point into. */
+typedef struct SymTableText *SymTableText_T;
+
+/* Return a new SymTable object of the backend registered under the name
+ * pcBackend, sized for and holding the bindings in the file pcPath, and
+ * store in *poText the text of the file, which the values of the bindings
+ * point into and which must outlive every use of them. The file is read
+ * with one large read and parsed in place. A key that appears more than
+ * once is bound to its last value. Return NULL if there is no such backend,
+ * the file cannot be read, or insufficient memory is available. */
+SymTable_T SymTableText_import(const char *pcPath, const char *pcBackend,
+                               SymTableText_T *poText);
+
+/* Free oText, leaving the values that point into it dangling. */
+void SymTableText_free(SymTableText_T oText);
+
+/* Write the bindings of oSymTable, whose values must be strings or NULL, to
+ * the file pcPath through a large buffer. Return 1, or 0 if a key or value
+ * cannot be represented or an I/O error occurs. */
+int SymTableText_export(SymTable_T oSymTable, const char *pcPath);
+
+#endif
@@ -0,0 +1,539 @@
+/*--------------------------------------------------------------------*/
+/* symtablettl.c                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "symtablebackend.h"
+#include "symtablettl.h"
+
+/* The timer wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots. A slot of
+ * level 0 spans one millisecond, and a slot of each further level spans a
+ * whole turn of the level below it, so the wheel reaches 2^24 ms, about
+ * 4.7 hours, ahead; a binding expiring later waits in the last slot of the
+ * top level and is put back in the wheel when that slot comes round. */
+enum {WHEEL_BITS = 6, WHEEL_SLOTS = 1 << WHEEL_BITS, WHEEL_LEVELS = 4};
+
+/* The number of expired bindings each SymTable_put reaps */
+enum {PUT_REAP_LIMIT = 4};
+
+/* shortened form for struct TtlEntry */
+typedef struct TtlEntry TtlEntry;
+
+/* A TtlEntry object is a binding of a TTL table, linked into a slot of its
+ * timer wheel if it expires. The key is stored in the same allocation,
+ * right after it. */
+struct TtlEntry {
+    /* The next entry of the same slot, or NULL if it is the last */
+    struct TtlEntry *next;
+    /* The link that points to this entry: the next field of the previous
+     * entry of the slot, or the head of the slot */
+    struct TtlEntry **prevLink;
+    /* Value associated with the key */
+    void *value;
+    /* Time at which the binding expires, or 0 if it never does */
+    uint64_t expiry;
+    /* Index of the slot in the wheel, or -1 if the entry is in none */
+    int slot;
+};
+
+/* A SymTableTtl object is a table that maps each key to its TtlEntry, and
+ * the timer wheel whose slots list the entries that expire. */
+struct SymTableTtl {
+    /* Common header identifying the backend */
+    struct SymTable base;
+    /* The table that maps each key to its TtlEntry */
+    SymTable_T table;
+    /* The slots of the wheel, level after level */
+    struct TtlEntry *slots[WHEEL_LEVELS * WHEEL_SLOTS];
+    /* Bit i of occupied[l] is set if slot i of level l is not empty */
+    uint64_t occupied[WHEEL_LEVELS];
+    /* The first millisecond whose slot of level 0 has not been reaped */
+    uint64_t current;
+    /* Bytes allocated for entries */
+    size_t bytes;
+    /* The clock */
+    uint64_t (*now)(void);
+    /* Function called with each expired binding, or NULL */
+    void (*expire)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* Last argument of expire */
+    void *extra;
+};
+
+/* shortened form for a pointer to struct SymTableTtl */
+typedef struct SymTableTtl *SymTableTtl_T;
+
+/* Return the monotonic clock in milliseconds. */
+static uint64_t SymTable_monotonicNow(void) {
+    struct timespec sNow;
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (uint64_t)sNow.tv_sec * 1000 + (uint64_t)sNow.tv_nsec / 1000000;
+}
+
+/* Return the key of psEntry. */
+static const char *SymTable_entryKey(const TtlEntry *psEntry) {
+    return (const char *)(psEntry + 1);
+}
+
+/* Return 1 if psEntry has expired at time uNow, or 0 otherwise. */
+static int SymTable_isExpired(const TtlEntry *psEntry, uint64_t uNow) {
+    return psEntry->expiry != 0 && psEntry->expiry <= uNow;
+}
+
+/* Link psEntry, which expires and is in no slot, into the slot of the
+ * wheel of oSymTable that will be reaped or cascaded first at or after its
+ * expiry time, or into the slot reaped next if it has expired by time
+ * uNow, so that an entry the wheel has fallen far behind on is not
+ * cascaded again and again. */
+static void SymTable_schedule(SymTableTtl_T oSymTable, TtlEntry *psEntry,
+                              uint64_t uNow) {
+    uint64_t uTime = psEntry->expiry;
+    uint64_t uDelta;
+    int iLevel;
+    int iSlot;
+
+    if (uTime <= uNow || uTime < oSymTable->current)
+        uTime = oSymTable->current;
+    uDelta = uTime - oSymTable->current;
+    for (iLevel = 0; iLevel < WHEEL_LEVELS - 1; iLevel++)
+        if (uDelta < (uint64_t)1 << (WHEEL_BITS * (iLevel + 1))) break;
+    if (uDelta >= (uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+        uTime = oSymTable->current +
+                ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+    iSlot = (int)((uTime >> (WHEEL_BITS * iLevel)) & (WHEEL_SLOTS - 1));
+
+    psEntry->slot = iLevel * WHEEL_SLOTS + iSlot;
+    psEntry->next = oSymTable->slots[psEntry->slot];
+    if (psEntry->next != NULL) psEntry->next->prevLink = &psEntry->next;
+    psEntry->prevLink = &oSymTable->slots[psEntry->slot];
+    oSymTable->slots[psEntry->slot] = psEntry;
+    oSymTable->occupied[iLevel] |= (uint64_t)1 << iSlot;
+}
+
+/* Unlink psEntry from its slot of the wheel of oSymTable, if it is in
+ * one. */
+static void SymTable_unschedule(SymTableTtl_T oSymTable, TtlEntry *psEntry) {
+    if (psEntry->slot < 0) return;
+    *psEntry->prevLink = psEntry->next;
+    if (psEntry->next != NULL) psEntry->next->prevLink = psEntry->prevLink;
+    if (oSymTable->slots[psEntry->slot] == NULL)
+        oSymTable->occupied[psEntry->slot / WHEEL_SLOTS] &=
+            ~((uint64_t)1 << (psEntry->slot % WHEEL_SLOTS));
+    psEntry->slot = -1;
+}
+
+/* Remove psEntry, which has expired, from oSymTable, pass it to the expiry
+ * callback, and free it. */
+static void SymTable_expire(SymTableTtl_T oSymTable, TtlEntry *psEntry) {
+    SymTable_unschedule(oSymTable, psEntry);
+    SymTable_remove(oSymTable->table, SymTable_entryKey(psEntry));
+    oSymTable->bytes -= sizeof(TtlEntry) + strlen(SymTable_entryKey(psEntry))
+                        + 1;
+    if (oSymTable->expire != NULL)
+        (*oSymTable->expire)(SymTable_entryKey(psEntry), psEntry->value,
+                             oSymTable->extra);
+    free(psEntry);
+}
+
+/* Return the entry of oSymTable whose key is pcKey, or NULL if there is
+ * none. An entry that has expired is expired and NULL returned. */
+static TtlEntry *SymTable_lookup(SymTableTtl_T oSymTable, const char *pcKey) {
+    TtlEntry *psEntry = (TtlEntry *)SymTable_get(oSymTable->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    if (psEntry->expiry != 0 &&
+        SymTable_isExpired(psEntry, (*oSymTable->now)())) {
+        SymTable_expire(oSymTable, psEntry);
+        return NULL;
+    }
+    return psEntry;
+}
+
+/* Move up to uLimit entries of slot iSlot of level iLevel of the wheel of
+ * oSymTable to the slots of the levels below, now that the wheel has
+ * reached the start of the span of the slot, and return how many were
+ * moved. uNow is the current time. */
+static size_t SymTable_cascade(SymTableTtl_T oSymTable, int iLevel,
+                               int iSlot, size_t uLimit, uint64_t uNow) {
+    TtlEntry *psEntry;
+    size_t uMoved = 0;
+    while (uMoved < uLimit &&
+           (psEntry = oSymTable->slots[iLevel * WHEEL_SLOTS + iSlot])
+           != NULL) {
+        SymTable_unschedule(oSymTable, psEntry);
+        SymTable_schedule(oSymTable, psEntry, uNow);
+        uMoved++;
+    }
+    return uMoved;
+}
+
+/* Return the first time at or after uTime at which slot iSlot of level
+ * iLevel, other than 0, of a wheel is cascaded. */
+static uint64_t SymTable_cascadeTime(uint64_t uTime, int iLevel, int iSlot) {
+    int iShift = WHEEL_BITS * iLevel;
+    uint64_t uTurn = (uint64_t)1 << (iShift + WHEEL_BITS);
+    uint64_t uStart = (uTime & ~(uTurn - 1)) + ((uint64_t)iSlot << iShift);
+    return uStart >= uTime ? uStart : uStart + uTurn;
+}
+
+/* Return the first time after oSymTable->current, whose slot of level 0
+ * must be empty, at which the wheel of oSymTable has work to do: a slot of
+ * level 0 to reap or a slot of a level above to cascade. Return
+ * UINT64_MAX if the wheel is empty. */
+static uint64_t SymTable_nextWork(SymTableTtl_T oSymTable) {
+    uint64_t uCurrent = oSymTable->current;
+    uint64_t uNext = UINT64_MAX;
+    uint64_t uBits;
+    uint64_t uTime;
+    int iLevel;
+
+    /* Level 0 holds the rest of this turn above the slot of current and
+     * the start of the next turn below it */
+    uBits = oSymTable->occupied[0] >> (uCurrent & (WHEEL_SLOTS - 1)) >> 1;
+    if (uBits != 0) return uCurrent + 1 + (uint64_t)__builtin_ctzll(uBits);
+    if (oSymTable->occupied[0] != 0)
+        uNext = (uCurrent | (WHEEL_SLOTS - 1)) + 1 +
+                (uint64_t)__builtin_ctzll(oSymTable->occupied[0]);
+
+    for (iLevel = 1; iLevel < WHEEL_LEVELS; iLevel++)
+        for (uBits = oSymTable->occupied[iLevel]; uBits != 0;
+             uBits &= uBits - 1) {
+            uTime = SymTable_cascadeTime(uCurrent + 1, iLevel,
+                                         __builtin_ctzll(uBits));
+            if (uTime < uNext) uNext = uTime;
+        }
+    return uNext;
+}
+
+/* Return a new TTL table that contains no bindings and keeps them in
+ * oTable, which is empty, with the clock and callback of SymTableTtl_new,
+ * or NULL if insufficient memory is available. oTable is freed either
+ * way. */
+static SymTable_T SymTable_newTtl(SymTable_T oTable, uint64_t (*pfNow)(void),
+                                  void (*pfExpire)(const char *pcKey,
+                                                   void *pvValue,
+                                                   void *pvExtra),
+                                  const void *pvExtra) {
+    SymTableTtl_T symtable = (SymTableTtl_T)malloc(sizeof(struct SymTableTtl));
+    if (symtable == NULL) {
+        SymTable_free(oTable);
+        return NULL;
+    }
+    SymTable_initHeader(&symtable->base, &SymTableTtl_backend);
+    symtable->table = oTable;
+    memset(symtable->slots, 0, sizeof(symtable->slots));
+    memset(symtable->occupied, 0, sizeof(symtable->occupied));
+    symtable->now = pfNow != NULL ? pfNow : SymTable_monotonicNow;
+    symtable->current = (*symtable->now)();
+    symtable->bytes = 0;
+    symtable->expire = pfExpire;
+    symtable->extra = (void *)pvExtra;
+    return &symtable->base;
+}
+
+SymTable_T SymTableTtl_new(const char *pcBackend, uint64_t (*pfNow)(void),
+                           void (*pfExpire)(const char *pcKey, void *pvValue,
+                                            void *pvExtra),
+                           const void *pvExtra) {
+    SymTable_T oTable;
+    assert(pcBackend != NULL);
+    oTable = SymTable_newWithBackend(pcBackend);
+    if (oTable == NULL) return NULL;
+    return SymTable_newTtl(oTable, pfNow, pfExpire, pvExtra);
+}
+
+uint64_t SymTableTtl_now(SymTable_T oBase) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableTtl_backend);
+    return (*oSymTable->now)();
+}
+
+int SymTableTtl_setExpiry(SymTable_T oBase, const char *pcKey,
+                          uint64_t uExpiry) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableTtl_backend);
+    assert(pcKey != NULL);
+    psEntry = SymTable_lookup(oSymTable, pcKey);
+    if (psEntry == NULL) return 0;
+    SymTable_unschedule(oSymTable, psEntry);
+    psEntry->expiry = uExpiry;
+    if (uExpiry != 0) SymTable_schedule(oSymTable, psEntry, 0);
+    return 1;
+}
+
+uint64_t SymTableTtl_getExpiry(SymTable_T oBase, const char *pcKey) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableTtl_backend);
+    assert(pcKey != NULL);
+    psEntry = SymTable_lookup(oSymTable, pcKey);
+    return psEntry != NULL ? psEntry->expiry : 0;
+}
+
+size_t SymTableTtl_reap(SymTable_T oBase, size_t uLimit) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    uint64_t uNow;
+    uint64_t uNext;
+    size_t uReaped = 0;
+    size_t uWork = 0;
+    assert(oSymTable != NULL);
+    assert(oBase->backend == &SymTableTtl_backend);
+
+    uNow = (*oSymTable->now)();
+    while (oSymTable->current <= uNow && uWork < uLimit) {
+        int iSlot = (int)(oSymTable->current & (WHEEL_SLOTS - 1));
+        TtlEntry *psEntry;
+
+        /* At the end of a turn of a level, the next slot of the level
+         * above is spread over the levels below. Resuming it after running
+         * out of the limit in the middle of it does no harm. */
+        if (iSlot == 0) {
+            int iLevel;
+            for (iLevel = 1; iLevel < WHEEL_LEVELS; iLevel++) {
+                int iUpper = (int)((oSymTable->current >>
+                                    (WHEEL_BITS * iLevel)) &
+                                   (WHEEL_SLOTS - 1));
+                uWork += SymTable_cascade(oSymTable, iLevel, iUpper,
+                                          uLimit - uWork, uNow);
+                if (oSymTable->slots[iLevel * WHEEL_SLOTS + iUpper] != NULL)
+                    return uReaped;
+                if (iUpper != 0) break;
+            }
+        }
+
+        while (uWork < uLimit &&
+               (psEntry = oSymTable->slots[iSlot]) != NULL) {
+            SymTable_unschedule(oSymTable, psEntry);
+            if (SymTable_isExpired(psEntry, uNow)) {
+                SymTable_expire(oSymTable, psEntry);
+                uReaped++;
+            } else
+                /* It was beyond the reach of the wheel */
+                SymTable_schedule(oSymTable, psEntry, uNow);
+            uWork++;
+        }
+        if (oSymTable->slots[iSlot] != NULL) break;
+
+        /* Jump over the empty slots, however long the table was idle */
+        uNext = SymTable_nextWork(oSymTable);
+        oSymTable->current = uNext <= uNow ? uNext : uNow + 1;
+    }
+    return uReaped;
+}
+
+/* TTL tables are created only by SymTableTtl_new, so return NULL. */
+static SymTable_T SymTableTtl_newDefault(void) { return NULL; }
+
+/* Free the TtlEntry pvValue. */
+static void SymTable_freeEntry(const char *pcKey, void *pvValue,
+                               void *pvExtra) {
+    (void)pcKey;
+    (void)pvExtra;
+    free(pvValue);
+}
+
+static void SymTableTtl_free(SymTable_T oBase) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    SymTable_map(oSymTable->table, SymTable_freeEntry, NULL);
+    SymTable_free(oSymTable->table);
+    free(oSymTable);
+}
+
+static size_t SymTableTtl_getLength(SymTable_T oBase) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_getLength(oSymTable->table);
+}
+
+static int SymTableTtl_put(SymTable_T oBase, const char *pcKey,
+                           const void *pvValue) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    size_t keyLength;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if (SymTable_lookup(oSymTable, pcKey) != NULL) return 0;
+    keyLength = strlen(pcKey) + 1;
+    psEntry = (TtlEntry *)malloc(sizeof(TtlEntry) + keyLength);
+    if (psEntry == NULL) return 0;
+    memcpy((char *)(psEntry + 1), pcKey, keyLength);
+    psEntry->next = NULL;
+    psEntry->prevLink = NULL;
+    psEntry->value = (void *)pvValue;
+    psEntry->expiry = 0;
+    psEntry->slot = -1;
+    if (!SymTable_put(oSymTable->table, pcKey, psEntry)) {
+        free(psEntry);
+        return 0;
+    }
+    oSymTable->bytes += sizeof(TtlEntry) + keyLength;
+    SymTableTtl_reap(oBase, PUT_REAP_LIMIT);
+    return 1;
+}
+
+static void *SymTableTtl_replace(SymTable_T oBase, const char *pcKey,
+                                 const void *pvValue) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    void *oldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_lookup(oSymTable, pcKey);
+    if (psEntry == NULL) return NULL;
+    oldValue = psEntry->value;
+    psEntry->value = (void *)pvValue;
+    return oldValue;
+}
+
+static int SymTableTtl_contains(SymTable_T oBase, const char *pcKey) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_lookup(oSymTable, pcKey) != NULL;
+}
+
+static void *SymTableTtl_get(SymTable_T oBase, const char *pcKey) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_lookup(oSymTable, pcKey);
+    return psEntry != NULL ? psEntry->value : NULL;
+}
+
+static void *SymTableTtl_remove(SymTable_T oBase, const char *pcKey) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    TtlEntry *psEntry;
+    void *value;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_lookup(oSymTable, pcKey);
+    if (psEntry == NULL) return NULL;
+    SymTable_unschedule(oSymTable, psEntry);
+    SymTable_remove(oSymTable->table, pcKey);
+    oSymTable->bytes -= sizeof(TtlEntry) + strlen(pcKey) + 1;
+    value = psEntry->value;
+    free(psEntry);
+    return value;
+}
+
+/* The state of a SymTable_map of a TTL table */
+struct TtlMap {
+    /* The function to apply to the bindings that have not expired */
+    void (*apply)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* Last argument of apply */
+    void *extra;
+    /* The time at which the map started */
+    uint64_t now;
+};
+
+/* Apply the function of the TtlMap pvExtra to the key pcKey and value of
+ * the TtlEntry pvValue, unless it has expired. */
+static void SymTable_applyLive(const char *pcKey, void *pvValue,
+                               void *pvExtra) {
+    struct TtlMap *psMap = (struct TtlMap *)pvExtra;
+    TtlEntry *psEntry = (TtlEntry *)pvValue;
+    if (!SymTable_isExpired(psEntry, psMap->now))
+        (*psMap->apply)(pcKey, psEntry->value, psMap->extra);
+}
+
+static void SymTableTtl_map(SymTable_T oBase,
+                            void (*pfApply)(const char *pcKey, void *pvValue,
+                                            void *pvExtra),
+                            const void *pvExtra) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    struct TtlMap sMap;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    sMap.apply = pfApply;
+    sMap.extra = (void *)pvExtra;
+    sMap.now = (*oSymTable->now)();
+    SymTable_map(oSymTable->table, SymTable_applyLive, &sMap);
+}
+
+static void SymTableTtl_getStats(SymTable_T oBase,
+                                 struct SymTableStats *psStats) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    if (oSymTable->table->backend->pfGetStats != NULL)
+        oSymTable->table->backend->pfGetStats(oSymTable->table, psStats);
+#ifdef SYMTABLE_STATS
+    psStats->bytesAllocated += sizeof(struct SymTableTtl) + oSymTable->bytes;
+#endif
+}
+
+/* The state of a SymTable_clone of a TTL table */
+struct TtlClone {
+    /* The clone, or NULL once a put into it has failed */
+    SymTable_T clone;
+    /* The time at which the clone started */
+    uint64_t now;
+};
+
+/* Bind pcKey in the clone of the TtlClone pvExtra to the value and expiry
+ * of the TtlEntry pvValue, unless it has expired. */
+static void SymTable_cloneEntry(const char *pcKey, void *pvValue,
+                                void *pvExtra) {
+    struct TtlClone *psClone = (struct TtlClone *)pvExtra;
+    TtlEntry *psEntry = (TtlEntry *)pvValue;
+    if (psClone->clone == NULL || SymTable_isExpired(psEntry, psClone->now))
+        return;
+    if (!SymTableTtl_put(psClone->clone, pcKey, psEntry->value)) {
+        SymTableTtl_free(psClone->clone);
+        psClone->clone = NULL;
+        return;
+    }
+    if (psEntry->expiry != 0)
+        SymTableTtl_setExpiry(psClone->clone, pcKey, psEntry->expiry);
+}
+
+static SymTable_T SymTableTtl_clone(SymTable_T oBase) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    SymTable_T oTable;
+    struct TtlClone sClone;
+    assert(oSymTable != NULL);
+
+    oTable = oSymTable->table->backend->pfNew();
+    if (oTable == NULL) return NULL;
+    sClone.clone = SymTable_newTtl(oTable, oSymTable->now, oSymTable->expire,
+                                   oSymTable->extra);
+    if (sClone.clone == NULL) return NULL;
+    sClone.now = (*oSymTable->now)();
+    SymTable_map(oSymTable->table, SymTable_cloneEntry, &sClone);
+    return sClone.clone;
+}
+
+static int SymTableTtl_reserve(SymTable_T oBase, size_t uCount) {
+    SymTableTtl_T oSymTable = (SymTableTtl_T)oBase;
+    assert(oSymTable != NULL);
+    return SymTable_reserve(oSymTable->table, uCount);
+}
+
+/* The function table of TTL tables, which is not registered because they
+ * need a backend to keep their entries in */
+const struct SymTableBackend SymTableTtl_backend = {
+    "ttl",
+    SymTableTtl_newDefault,
+    SymTableTtl_free,
+    SymTableTtl_getLength,
+    SymTableTtl_put,
+    SymTableTtl_replace,
+    SymTableTtl_contains,
+    SymTableTtl_get,
+    SymTableTtl_remove,
+    SymTableTtl_map,
+    SymTableTtl_getStats,
+    SymTableTtl_clone,
+    SymTableTtl_reserve,
+    NULL};
@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------*/
+/* symtablettl.h                                                      */
+/* Author: Ishaan Javali                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLETTL_H
+#define SYMTABLETTL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "symtable.h"
+
+/* A TTL SymTable object lets each binding carry an expiry time, in
+ * milliseconds on the table's clock. A binding whose expiry time has come
+ * is invisible: SymTable_get, SymTable_contains, SymTable_replace, and
+ * SymTable_remove remove it when they look it up, SymTable_map skips it,
+ * and SymTableTtl_reap, which each SymTable_put calls with a small limit,
+ * removes expired bindings in time proportional to their number rather than
+ * to the size of the table, using a hierarchical timer wheel. Every binding
+ * removed because it expired is passed to the expiry callback, which must
+ * not use the table. SymTable_getLength counts expired bindings that have
+ * not been removed yet. */
+
+/* Return a new TTL SymTable object that contains no bindings and keeps them
+ * in a table of the backend registered under the name pcBackend, or NULL if
+ * there is no such backend or insufficient memory is available. pfNow,
+ * which returns the current time in milliseconds and never goes backwards,
+ * is the table's clock; if it is NULL the table uses the monotonic clock.
+ * pfExpire, which may be NULL, is called with the key and value of each
+ * binding removed because it expired and with pvExtra. */
+SymTable_T SymTableTtl_new(const char *pcBackend, uint64_t (*pfNow)(void),
+                           void (*pfExpire)(const char *pcKey, void *pvValue,
+                                            void *pvExtra),
+                           const void *pvExtra);
+
+/* Return the current time on the clock of oSymTable. oSymTable must be a
+ * TTL SymTable. */
+uint64_t SymTableTtl_now(SymTable_T oSymTable);
+
+/* Make the binding of oSymTable whose key is pcKey expire at time
+ * uExpiry, or never if uExpiry is 0, and return 1, or return 0 if there is
+ * no such binding. oSymTable must be a TTL SymTable. */
+int SymTableTtl_setExpiry(SymTable_T oSymTable, const char *pcKey,
+                          uint64_t uExpiry);
+
+/* Return the expiry time of the binding of oSymTable whose key is pcKey,
+ * or 0 if it never expires or there is no such binding. oSymTable must be
+ * a TTL SymTable. */
+uint64_t SymTableTtl_getExpiry(SymTable_T oSymTable, const char *pcKey);
+
+/* Remove bindings of oSymTable that have expired, doing at most uLimit
+ * units of work, each the removal of a binding or its move between levels
+ * of the timer wheel, and return how many were removed. Expired bindings
+ * may remain even if fewer than uLimit were removed; a uLimit of SIZE_MAX
+ * removes them all. Empty stretches of the wheel are skipped in time that
+ * does not depend on how long the table was idle. oSymTable must be a TTL
+ * SymTable. */
+size_t SymTableTtl_reap(SymTable_T oSymTable, size_t uLimit);
+
+#endif
@@ -3,12 +3,29 @@
 /* Author: Bob Dondero                                                */
 /*--------------------------------------------------------------------*/
 
+#include "symset.h"
 #include "symtable.h"
+#include "symtablecache.h"
+#include "symtabledurable.h"
+#include "symtablehamt.h"
+#include "symtablehash.h"
+#include "symtablelist.h"
+#include "symtableint.h"
+#include "symtablemerge.h"
+#include "symtablescope.h"
+#include "symtableshard.h"
+#include "symtableshm.h"
+#include "symtablestats.h"
+#include "symtabletext.h"
+#include "symtablettl.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #ifndef S_SPLINT_S
 #include <sys/resource.h>
@@ -776,6 +793,2351 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test a SymTable object holding many keys that all hash to the
+   same bucket -- bucket 0 -- assuming a hash table implementation
+   with 509 buckets that uses the hash function from the assignment
+   specification. */
+
+static void testLongChains(void)
+{
+   enum {KEY_COUNT = 200, MAX_KEY_LENGTH = 10, BUCKET_COUNT = 509};
+   const size_t HASH_MULTIPLIER = 65599;
+
+   SymTable_T oSymTable;
+   char acKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   int iSuccessful;
+   int iKeyCount = 0;
+   int iCandidate;
+   size_t uHash;
+   size_t u;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object with many colliding keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iCandidate = 0; iKeyCount < KEY_COUNT; iCandidate++)
+   {
+      sprintf(acKeys[iKeyCount], "%d", iCandidate);
+      uHash = 0;
+      for (u = 0; acKeys[iKeyCount][u] != '\0'; u++)
+         uHash = uHash * HASH_MULTIPLIER + (size_t)acKeys[iKeyCount][u];
+      if (uHash % BUCKET_COUNT == 0)
+         iKeyCount++;
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, acKeys[i], acKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, acKeys[i], acKeys[i]);
+      ASSURE(! iSuccessful);
+      ASSURE(SymTable_get(oSymTable, acKeys[i]) == acKeys[i]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+   /* Remove all but a few keys, then put them back. */
+   for (i = 3; i < KEY_COUNT; i++)
+      ASSURE(SymTable_remove(oSymTable, acKeys[i]) == acKeys[i]);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_contains(oSymTable, acKeys[i]) == (i < 3));
+   for (i = 3; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, acKeys[i], acKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_replace(oSymTable, acKeys[i], acKeys[0])
+         == acKeys[i]);
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTableHash_sipHash against known answers of SipHash-1-3
+   under the key whose bytes are 0, 1, ..., 15, computed with an
+   implementation that matches the published SipHash-2-4 vectors
+   when run with 2 and 4 rounds. */
+
+static void testSipHash(void)
+{
+   enum {VECTOR_COUNT = 6};
+   static const char *apcKeys[VECTOR_COUNT] =
+      {"", "a", "abcdefg", "abcdefgh", "hello, world!",
+       "The quick brown fox"};
+   static const uint64_t auExpected[VECTOR_COUNT] =
+      {0xabac0158050fc4dcULL, 0x1c2697ab786a6237ULL,
+       0x639b490caba831bbULL, 0x12d8c08c2ee9e620ULL,
+       0x59cc40978f64af0eULL, 0x2f9078df4b9ca536ULL};
+   const uint64_t auSeed[2] =
+      {0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SipHash-1-3.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < VECTOR_COUNT; i++)
+      ASSURE(SymTableHash_sipHash(auSeed, apcKeys[i]) == auExpected[i]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test creating SymTable objects with each registered backend. */
+
+static void testBackends(void)
+{
+   SymTable_T oSymTable;
+   char acShortstop[] = "Shortstop";
+   const char *pcBackend;
+   char *pcValue;
+   int iSuccessful;
+   size_t u;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable objects created with each backend.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(SymTable_getBackendCount() >= 3);
+
+   for (u = 0; u < SymTable_getBackendCount(); u++)
+   {
+      pcBackend = SymTable_getBackendName(u);
+      oSymTable = SymTable_newWithBackend(pcBackend);
+      ASSURE(oSymTable != NULL);
+      ASSURE(strcmp(SymTable_getBackend(oSymTable), pcBackend) == 0);
+
+      iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+      ASSURE(! iSuccessful);
+      pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+      ASSURE(pcValue == acShortstop);
+      pcValue = (char*)SymTable_remove(oSymTable, "Jeter");
+      ASSURE(pcValue == acShortstop);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+
+      /* Reserving room keeps the table usable, whether or not the
+         backend resizes. */
+      iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_reserve(oSymTable, 10000);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_get(oSymTable, "Jeter") == acShortstop);
+      ASSURE(SymTable_getLength(oSymTable) == 1);
+
+      SymTable_free(oSymTable);
+   }
+
+   oSymTable = SymTable_newWithBackend("no such backend");
+   ASSURE(oSymTable == NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test cloning SymTable objects created with each registered
+   backend, and changing the clone and the original
+   independently. */
+
+static void testClone(void)
+{
+   enum {BINDING_COUNT = 1000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   char acKey[MAX_KEY_LENGTH];
+   char acOriginal[] = "original";
+   char acChanged[] = "changed";
+   int iSuccessful;
+   size_t u;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing cloning SymTable objects with each backend.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < SymTable_getBackendCount(); u++)
+   {
+      oSymTable = SymTable_newWithBackend(SymTable_getBackendName(u));
+      ASSURE(oSymTable != NULL);
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acOriginal);
+         ASSURE(iSuccessful);
+      }
+
+      oClone = SymTable_clone(oSymTable);
+      ASSURE(oClone != NULL);
+      ASSURE(strcmp(SymTable_getBackend(oClone),
+         SymTable_getBackend(oSymTable)) == 0);
+      ASSURE(SymTable_getLength(oClone) == BINDING_COUNT);
+
+      /* Change even keys in the clone and odd keys in the
+         original. */
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         if (i % 2 == 0)
+            ASSURE(SymTable_replace(oClone, acKey, acChanged)
+               == acOriginal);
+         else
+            ASSURE(SymTable_remove(oSymTable, acKey) == acOriginal);
+      }
+      iSuccessful = SymTable_put(oClone, "new", acChanged);
+      ASSURE(iSuccessful);
+
+      ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2);
+      ASSURE(SymTable_getLength(oClone) == BINDING_COUNT + 1);
+      ASSURE(! SymTable_contains(oSymTable, "new"));
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         if (i % 2 == 0)
+         {
+            ASSURE(SymTable_get(oSymTable, acKey) == acOriginal);
+            ASSURE(SymTable_get(oClone, acKey) == acChanged);
+         }
+         else
+         {
+            ASSURE(! SymTable_contains(oSymTable, acKey));
+            ASSURE(SymTable_get(oClone, acKey) == acOriginal);
+         }
+      }
+
+      /* The clone outlives the original. */
+      SymTable_free(oSymTable);
+      ASSURE(SymTable_get(oClone, "0") == acChanged);
+      SymTable_free(oClone);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the persistent versions of a SymTable object created with the
+   hamt backend. */
+
+static void testVersions(void)
+{
+   enum {VERSION_COUNT = 100, MAX_KEY_LENGTH = 10};
+
+   SymTable_T aoVersions[VERSION_COUNT + 1];
+   SymTable_T oVersion;
+   char acKey[MAX_KEY_LENGTH];
+   char acOriginal[] = "original";
+   char acChanged[] = "changed";
+   int i;
+   int j;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing persistent versions of a hamt SymTable object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Version i holds the keys 0 through i-1. */
+   aoVersions[0] = SymTable_newWithBackend("hamt");
+   ASSURE(aoVersions[0] != NULL);
+   for (i = 0; i < VERSION_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      aoVersions[i + 1] =
+         SymTableHamt_putVersion(aoVersions[i], acKey, acOriginal);
+      ASSURE(aoVersions[i + 1] != NULL);
+   }
+   ASSURE(SymTableHamt_putVersion(aoVersions[1], "0", acChanged)
+      == NULL);
+   ASSURE(SymTableHamt_replaceVersion(aoVersions[0], "0", acChanged)
+      == NULL);
+   ASSURE(SymTableHamt_removeVersion(aoVersions[0], "0") == NULL);
+
+   for (i = 0; i <= VERSION_COUNT; i++)
+   {
+      ASSURE(SymTable_getLength(aoVersions[i]) == (size_t)i);
+      for (j = 0; j < VERSION_COUNT; j++)
+      {
+         sprintf(acKey, "%d", j);
+         ASSURE(SymTable_contains(aoVersions[i], acKey) == (j < i));
+      }
+   }
+
+   /* Derive two versions from the last one, and change the last
+      one in place. */
+   oVersion = SymTableHamt_replaceVersion(aoVersions[VERSION_COUNT],
+      "0", acChanged);
+   ASSURE(oVersion != NULL);
+   ASSURE(SymTable_get(oVersion, "0") == acChanged);
+   ASSURE(SymTable_get(aoVersions[VERSION_COUNT], "0") == acOriginal);
+   SymTable_free(oVersion);
+
+   oVersion = SymTableHamt_removeVersion(aoVersions[VERSION_COUNT],
+      "1");
+   ASSURE(oVersion != NULL);
+   ASSURE(SymTable_getLength(oVersion) == VERSION_COUNT - 1);
+   ASSURE(! SymTable_contains(oVersion, "1"));
+   ASSURE(SymTable_contains(aoVersions[VERSION_COUNT], "1"));
+
+   ASSURE(SymTable_remove(aoVersions[VERSION_COUNT], "2")
+      == acOriginal);
+   ASSURE(SymTable_contains(oVersion, "2"));
+   ASSURE(SymTable_contains(aoVersions[VERSION_COUNT - 1], "2"));
+
+   /* Free the versions in an order unrelated to their creation. */
+   for (i = 0; i <= VERSION_COUNT; i += 2)
+      SymTable_free(aoVersions[i]);
+   ASSURE(SymTable_get(oVersion, "0") == acOriginal);
+   for (i = 1; i <= VERSION_COUNT; i += 2)
+      SymTable_free(aoVersions[i]);
+   ASSURE(SymTable_getLength(oVersion) == VERSION_COUNT - 1);
+   SymTable_free(oVersion);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test committing and rolling back transactions on SymTable objects
+   created with each registered backend. */
+
+static void testTransactions(void)
+{
+   enum {BINDING_COUNT = 100, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acOriginal[] = "original";
+   char acChanged[] = "changed";
+   int iSuccessful;
+   size_t u;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing transactions with each backend.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < SymTable_getBackendCount(); u++)
+   {
+      oSymTable = SymTable_newWithBackend(SymTable_getBackendName(u));
+      ASSURE(oSymTable != NULL);
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acOriginal);
+         ASSURE(iSuccessful);
+      }
+
+      /* Change every binding, several of them more than once, then
+         roll back. Failed operations must leave nothing to undo. */
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      ASSURE(! SymTable_beginTxn(oSymTable));
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         if (i % 3 == 0)
+            ASSURE(SymTable_replace(oSymTable, acKey, NULL)
+               == acOriginal);
+         else if (i % 3 == 1)
+         {
+            ASSURE(SymTable_remove(oSymTable, acKey) == acOriginal);
+            ASSURE(SymTable_put(oSymTable, acKey, acChanged));
+         }
+         else
+            ASSURE(SymTable_remove(oSymTable, acKey) == acOriginal);
+      }
+      ASSURE(SymTable_put(oSymTable, "new", acChanged));
+      ASSURE(SymTable_replace(oSymTable, "new", acOriginal)
+         == acChanged);
+      ASSURE(! SymTable_put(oSymTable, "new", acChanged));
+      ASSURE(SymTable_replace(oSymTable, "absent", acChanged) == NULL);
+      ASSURE(SymTable_remove(oSymTable, "absent") == NULL);
+      ASSURE(SymTable_remove(oSymTable, "2") == NULL);
+
+      iSuccessful = SymTable_rollback(oSymTable);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+      ASSURE(! SymTable_contains(oSymTable, "new"));
+      ASSURE(! SymTable_contains(oSymTable, "absent"));
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) == acOriginal);
+      }
+
+      /* Committed changes stay, and begin no longer fails. */
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_remove(oSymTable, "0") == acOriginal);
+      ASSURE(SymTable_replace(oSymTable, "1", acChanged) == acOriginal);
+      SymTable_commit(oSymTable);
+      ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT - 1);
+      ASSURE(! SymTable_contains(oSymTable, "0"));
+      ASSURE(SymTable_get(oSymTable, "1") == acChanged);
+
+      /* A table may be freed with a transaction open. */
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_put(oSymTable, "0", acChanged));
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a durable SymTable object recovers its bindings from its
+   snapshot and log, including a log whose last record is torn. */
+
+static void testDurable(void)
+{
+   enum {BINDING_COUNT = 1000, MAX_KEY_LENGTH = 10, MAX_PATH_LENGTH = 64};
+
+   SymTable_T oSymTable;
+   char acPath[MAX_PATH_LENGTH];
+   char acSnapshot[MAX_PATH_LENGTH];
+   char acLog[MAX_PATH_LENGTH];
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a durable SymTable object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Each test program has its own files. */
+   sprintf(acPath, "testsymtable.%ld.durable", (long)getpid());
+   sprintf(acSnapshot, "%s.snap", acPath);
+   sprintf(acLog, "%s.log", acPath);
+   remove(acSnapshot);
+   remove(acLog);
+
+   /* Values are stored as integers, which keep their meaning
+      across runs. */
+   oSymTable = SymTableDurable_open(acPath, "hash");
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)i);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_replace(oSymTable, acKey, NULL) == (void*)(size_t)i);
+   }
+   for (i = 1; i < BINDING_COUNT; i += 4)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == (void*)(size_t)i);
+   }
+   iSuccessful = SymTableDurable_sync(oSymTable);
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable);
+
+   /* Recover from the log alone, then from a snapshot and a log. */
+   oSymTable = SymTableDurable_open(acPath, "hash");
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT * 3 / 4);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 4 == 1)
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+      else
+         ASSURE(SymTable_get(oSymTable, acKey)
+            == (i % 2 == 0 ? NULL : (void*)(size_t)i));
+   }
+   iSuccessful = SymTableDurable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_remove(oSymTable, "3") == (void*)(size_t)3);
+   iSuccessful = SymTable_put(oSymTable, "new", (void*)(size_t)1);
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable);
+
+   /* A crash in the middle of a record leaves a torn tail, which
+      recovery discards. */
+   psFile = fopen(acLog, "ab");
+   ASSURE(psFile != NULL);
+   fputs("\001\377", psFile);
+   fclose(psFile);
+   oSymTable = SymTableDurable_open(acPath, "hybrid");
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT * 3 / 4);
+   ASSURE(! SymTable_contains(oSymTable, "3"));
+   ASSURE(SymTable_get(oSymTable, "new") == (void*)(size_t)1);
+   ASSURE(SymTable_get(oSymTable, "7") == (void*)(size_t)7);
+   iSuccessful = SymTable_put(oSymTable, "newer", (void*)(size_t)2);
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTableDurable_open(acPath, "hash");
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT * 3 / 4 + 1);
+   ASSURE(SymTable_get(oSymTable, "newer") == (void*)(size_t)2);
+   SymTable_free(oSymTable);
+
+   remove(acSnapshot);
+   remove(acLog);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test importing and exporting SymTable objects as text files. */
+
+static void testText(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oCopy;
+   SymTableText_T oText;
+   SymTableText_T oCopyText;
+   FILE *psFile;
+   char acPath[64];
+   char acShortstop[] = "Shortstop";
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing importing and exporting text files.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Each test program has its own file. */
+   sprintf(acPath, "testsymtable.%ld.txt", (long)getpid());
+
+   /* The last line lacks its newline, and Ruth appears twice. */
+   psFile = fopen(acPath, "w");
+   ASSURE(psFile != NULL);
+   fputs("Ruth\tCenter Field\nGehrig\tFirst Base\nMantle\n", psFile);
+   fputs("\tEmpty Key\nMaris\t\nRuth\tRight Field", psFile);
+   fclose(psFile);
+
+   oSymTable = SymTableText_import(acPath, "hash", &oText);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 5);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"),
+      "Right Field") == 0);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Gehrig"),
+      "First Base") == 0);
+   ASSURE(SymTable_contains(oSymTable, "Mantle"));
+   ASSURE(SymTable_get(oSymTable, "Mantle") == NULL);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, ""), "Empty Key") == 0);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Maris"), "") == 0);
+
+   /* Export, and import what was exported into another backend. */
+   iSuccessful = SymTableText_export(oSymTable, acPath);
+   ASSURE(iSuccessful);
+   oCopy = SymTableText_import(acPath, "hybrid", &oCopyText);
+   ASSURE(oCopy != NULL);
+   ASSURE(SymTable_getLength(oCopy) == 5);
+   ASSURE(strcmp((char*)SymTable_get(oCopy, "Ruth"),
+      "Right Field") == 0);
+   ASSURE(SymTable_contains(oCopy, "Mantle"));
+   ASSURE(SymTable_get(oCopy, "Mantle") == NULL);
+   ASSURE(strcmp((char*)SymTable_get(oCopy, "Maris"), "") == 0);
+   SymTable_free(oCopy);
+   SymTableText_free(oCopyText);
+
+   /* A key with a tab cannot be exported. */
+   iSuccessful = SymTable_put(oSymTable, "Jeter\t2", acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableText_export(oSymTable, acPath);
+   ASSURE(! iSuccessful);
+   SymTable_free(oSymTable);
+   SymTableText_free(oText);
+
+   oSymTable = SymTableText_import("testsymtable.missing", "hash",
+      &oText);
+   ASSURE(oSymTable == NULL);
+   remove(acPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Record in the string pvExtra the first character of the key pcKey
+   of an evicted binding. */
+
+static void recordEviction(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   char *pcEvicted = (char*)pvExtra;
+   size_t uLength = strlen(pcEvicted);
+
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+
+   pcEvicted[uLength] = pcKey[0];
+   pcEvicted[uLength + 1] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that cache SymTable objects evict their least recently used
+   bindings. */
+
+static void testCache(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   struct SymTableCacheCounts sCounts;
+   char acValue[] = "value";
+   char acEvicted[16] = "";
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing cache SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableCache_new("hash", 3, 0, recordEviction,
+      acEvicted);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "a", acValue));
+   ASSURE(SymTable_put(oSymTable, "b", acValue));
+   ASSURE(SymTable_put(oSymTable, "c", acValue));
+   ASSURE(! SymTable_put(oSymTable, "c", acValue));
+   ASSURE(strcmp(acEvicted, "") == 0);
+
+   /* A rollback could not restore evicted bindings, so a cache
+      refuses transactions. */
+   ASSURE(! SymTable_beginTxn(oSymTable));
+
+   /* Using a makes b the least recently used binding, and merely
+      looking for b does not change that. */
+   ASSURE(SymTable_get(oSymTable, "a") == acValue);
+   ASSURE(SymTable_contains(oSymTable, "b"));
+   ASSURE(SymTable_put(oSymTable, "d", acValue));
+   ASSURE(strcmp(acEvicted, "b") == 0);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   ASSURE(SymTable_get(oSymTable, "b") == NULL);
+
+   /* Replacing counts as a use; removing frees room without an
+      eviction. */
+   ASSURE(SymTable_replace(oSymTable, "c", acValue) == acValue);
+   ASSURE(SymTable_remove(oSymTable, "d") == acValue);
+   ASSURE(SymTable_put(oSymTable, "e", acValue));
+   ASSURE(strcmp(acEvicted, "b") == 0);
+   ASSURE(SymTable_put(oSymTable, "f", acValue));
+   ASSURE(strcmp(acEvicted, "ba") == 0);
+
+   SymTableCache_getCounts(oSymTable, &sCounts);
+   ASSURE(sCounts.hits == 1);
+   ASSURE(sCounts.misses == 1);
+   ASSURE(sCounts.evictions == 2);
+
+   /* A clone keeps the order of use: c is the oldest in both. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(SymTable_getLength(oClone) == 3);
+   ASSURE(SymTable_put(oClone, "g", acValue));
+   ASSURE(strcmp(acEvicted, "bac") == 0);
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   SymTable_free(oClone);
+   SymTable_free(oSymTable);
+
+   /* A byte limit that leaves room for a single binding. */
+   acEvicted[0] = '\0';
+   oSymTable = SymTableCache_new("hybrid", 0, 1, recordEviction,
+      acEvicted);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "x", acValue);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "y", acValue);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(SymTable_get(oSymTable, "y") == acValue);
+   ASSURE(strcmp(acEvicted, "x") == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The time on the clock of the TTL SymTable objects of testTtl */
+
+static uint64_t uTtlNow;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the time on the clock of the TTL SymTable objects of
+   testTtl. */
+
+static uint64_t getTtlNow(void)
+{
+   return uTtlNow;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count in the size_t pvExtra the bindings that expired. */
+
+static void countExpiry(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that the bindings of TTL SymTable objects expire, whether
+   they are looked up or reaped. */
+
+enum {TTL_COUNT = 1000};
+
+static void testTtl(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   char acKey[16];
+   char acValue[] = "value";
+   size_t uExpired = 0;
+   size_t uReaped;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing TTL SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uTtlNow = 1000;
+   oSymTable = SymTableTtl_new("hash", getTtlNow, countExpiry,
+      &uExpired);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableTtl_now(oSymTable) == 1000);
+
+   /* Key i expires at 1000 + i for the first half, never for most
+      of the second half, and beyond the reach of the wheel for the
+      last tenth. */
+   for (i = 0; i < TTL_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+      if (i < TTL_COUNT / 2)
+         ASSURE(SymTableTtl_setExpiry(oSymTable, acKey,
+            (uint64_t)(1000 + i)));
+      else if (i >= TTL_COUNT - TTL_COUNT / 10)
+         ASSURE(SymTableTtl_setExpiry(oSymTable, acKey,
+            (uint64_t)1000 + ((uint64_t)1 << 30) + (uint64_t)i));
+   }
+   ASSURE(! SymTableTtl_setExpiry(oSymTable, "missing", 1));
+   ASSURE(SymTableTtl_getExpiry(oSymTable, "1") == 1001);
+   ASSURE(SymTableTtl_getExpiry(oSymTable, "600") == 0);
+
+   /* Key 0 expired at once, but stays until it is looked up or
+      reaped. */
+   ASSURE(uExpired == 0);
+   ASSURE(SymTable_getLength(oSymTable) == TTL_COUNT);
+
+   /* Expired bindings disappear when looked up. */
+   uTtlNow = 1100;
+   ASSURE(SymTable_get(oSymTable, "50") == NULL);
+   ASSURE(! SymTable_contains(oSymTable, "100"));
+   ASSURE(SymTable_replace(oSymTable, "99", acValue) == NULL);
+   ASSURE(SymTable_remove(oSymTable, "98") == NULL);
+   ASSURE(SymTable_get(oSymTable, "101") == acValue);
+   ASSURE(uExpired == 4);
+
+   /* A clone leaves out the expired bindings. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(SymTable_getLength(oClone) == TTL_COUNT - 101);
+   ASSURE(SymTableTtl_getExpiry(oClone, "101") == 1101);
+
+   /* Reaping removes the rest in bounded steps. */
+   uReaped = SymTableTtl_reap(oSymTable, 10);
+   ASSURE(uReaped <= 10);
+   uReaped += SymTableTtl_reap(oSymTable, SIZE_MAX);
+   ASSURE(uReaped == 97);
+   ASSURE(uExpired == 101);
+   ASSURE(SymTable_getLength(oSymTable) == TTL_COUNT - 101);
+   ASSURE(SymTableTtl_reap(oSymTable, SIZE_MAX) == 0);
+
+   /* An expired key can be bound again, and an expiry can be
+      cleared. */
+   ASSURE(SymTable_put(oSymTable, "50", acValue));
+   ASSURE(SymTableTtl_setExpiry(oSymTable, "200", 0));
+
+   /* Going far ahead reaps every binding that expires, across all
+      levels of the wheel. */
+   uTtlNow = 1000 + ((uint64_t)1 << 30) + TTL_COUNT;
+   uReaped = SymTableTtl_reap(oSymTable, SIZE_MAX);
+   ASSURE(uReaped == TTL_COUNT / 2 - 102 + TTL_COUNT / 10);
+   ASSURE(SymTable_getLength(oSymTable) ==
+      TTL_COUNT / 2 - TTL_COUNT / 10 + 2);
+   ASSURE(SymTable_contains(oSymTable, "200"));
+   ASSURE(SymTable_contains(oSymTable, "50"));
+   ASSURE(! SymTable_contains(oSymTable, "999"));
+   SymTable_free(oSymTable);
+
+   /* The clone keeps its own expiries. */
+   uExpired = 0;
+   ASSURE(SymTableTtl_reap(oClone, SIZE_MAX) == TTL_COUNT / 2 - 101
+      + TTL_COUNT / 10);
+   ASSURE(uExpired == TTL_COUNT / 2 - 101 + TTL_COUNT / 10);
+   SymTable_free(oClone);
+
+   /* After a very long idle time, bindings in the top level of the
+      wheel are reaped in a few units of work each, and an empty
+      wheel is skipped at once. */
+   uTtlNow = 1000;
+   oSymTable = SymTableTtl_new("hash", getTtlNow, NULL, NULL);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < TTL_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acValue));
+      ASSURE(SymTableTtl_setExpiry(oSymTable, acKey,
+         (uint64_t)1000 + ((uint64_t)1 << 20) + (uint64_t)i));
+   }
+   uTtlNow = (uint64_t)1 << 50;
+   for (i = 0; i <= TTL_COUNT && SymTable_getLength(oSymTable) > 0; i++)
+      ASSURE(SymTableTtl_reap(oSymTable, 4) <= 4);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   ASSURE(SymTableTtl_reap(oSymTable, SIZE_MAX) == 0);
+   uTtlNow += (uint64_t)1 << 40;
+   ASSURE(SymTable_put(oSymTable, "late", acValue));
+   ASSURE(SymTableTtl_setExpiry(oSymTable, "late", uTtlNow + 10));
+   uTtlNow += 10;
+   ASSURE(SymTableTtl_reap(oSymTable, SIZE_MAX) == 1);
+   SymTable_free(oSymTable);
+
+   /* Removing an expired binding in a transaction is not undone by
+      a rollback, which would bring it back. */
+   uTtlNow = 1000;
+   oSymTable = SymTableTtl_new("hash", getTtlNow, NULL, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "expired", acValue));
+   ASSURE(SymTableTtl_setExpiry(oSymTable, "expired", 1001));
+   ASSURE(SymTable_put(oSymTable, "live", acValue));
+   uTtlNow = 1002;
+   ASSURE(SymTable_beginTxn(oSymTable));
+   ASSURE(SymTable_remove(oSymTable, "expired") == NULL);
+   ASSURE(SymTable_remove(oSymTable, "live") == acValue);
+   ASSURE(SymTable_rollback(oSymTable));
+   ASSURE(! SymTable_contains(oSymTable, "expired"));
+   ASSURE(SymTable_get(oSymTable, "live") == acValue);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add to the int64_t pvExtra the key iKey of a binding whose value
+   pvValue is the string form of iKey. */
+
+static void sumIntKey(int64_t iKey, void *pvValue, void *pvExtra)
+{
+   char acKey[32];
+
+   sprintf(acKey, "%ld", (long)iKey);
+   ASSURE(strcmp((char*)pvValue, acKey) == 0);
+   *(int64_t*)pvExtra += iKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTableInt objects, whose keys are integers, with
+   iBindingCount bindings. */
+
+static void testInt(int iBindingCount)
+{
+   SymTableInt_T oSymTableInt;
+   char acValue[] = "value";
+   char acOther[] = "other";
+   char *pcValues;
+   int64_t iSum;
+   int64_t iExpectedSum;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTableInt objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTableInt = SymTableInt_new();
+   ASSURE(oSymTableInt != NULL);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 0);
+   ASSURE(SymTableInt_get(oSymTableInt, 0) == NULL);
+
+   /* Keys at the extremes and zero are ordinary keys. */
+   ASSURE(SymTableInt_put(oSymTableInt, 0, acValue));
+   ASSURE(SymTableInt_put(oSymTableInt, INT64_MIN, acValue));
+   ASSURE(SymTableInt_put(oSymTableInt, INT64_MAX, NULL));
+   ASSURE(! SymTableInt_put(oSymTableInt, 0, acOther));
+   ASSURE(SymTableInt_contains(oSymTableInt, INT64_MAX));
+   ASSURE(SymTableInt_get(oSymTableInt, INT64_MAX) == NULL);
+   ASSURE(SymTableInt_replace(oSymTableInt, INT64_MIN, acOther)
+      == acValue);
+   ASSURE(SymTableInt_get(oSymTableInt, INT64_MIN) == acOther);
+   ASSURE(SymTableInt_replace(oSymTableInt, 1, acOther) == NULL);
+   ASSURE(SymTableInt_remove(oSymTableInt, 0) == acValue);
+   ASSURE(SymTableInt_remove(oSymTableInt, 0) == NULL);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 2);
+   SymTableInt_free(oSymTableInt);
+
+   /* Bind each key i to its string form, through several
+      resizes. */
+   pcValues = (char*)malloc((size_t)iBindingCount * 16 + 1);
+   ASSURE(pcValues != NULL);
+   oSymTableInt = SymTableInt_new();
+   ASSURE(oSymTableInt != NULL);
+   iExpectedSum = 0;
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(pcValues + 16 * i, "%d", i * 7);
+      iSuccessful = SymTableInt_put(oSymTableInt, (int64_t)i * 7,
+         pcValues + 16 * i);
+      ASSURE(iSuccessful);
+      iExpectedSum += (int64_t)i * 7;
+   }
+   ASSURE(SymTableInt_getLength(oSymTableInt) == (size_t)iBindingCount);
+   iSum = 0;
+   SymTableInt_map(oSymTableInt, sumIntKey, &iSum);
+   ASSURE(iSum == iExpectedSum);
+
+   /* Remove every other binding; the rest must stay reachable. */
+   for (i = 0; i < iBindingCount; i += 2)
+      ASSURE(SymTableInt_remove(oSymTableInt, (int64_t)i * 7)
+         == pcValues + 16 * i);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ASSURE(SymTableInt_contains(oSymTableInt, (int64_t)i * 7)
+         == (i % 2 == 1));
+      ASSURE(! SymTableInt_contains(oSymTableInt, (int64_t)i * 7 + 1));
+   }
+   ASSURE(SymTableInt_getLength(oSymTableInt)
+      == (size_t)(iBindingCount / 2));
+   ASSURE(SymTableInt_reserve(oSymTableInt, (size_t)iBindingCount * 2));
+   ASSURE(SymTableInt_get(oSymTableInt, 7) == (iBindingCount > 1 ?
+      pcValues + 16 : NULL));
+   SymTableInt_free(oSymTableInt);
+   free(pcValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* WordCounts, a table that maps strings to unboxed counts */
+
+#define SYMTABLE_TEMPLATE_NAME WordCounts
+#define SYMTABLE_TEMPLATE_KEY const char *
+#define SYMTABLE_TEMPLATE_VALUE long
+#define SYMTABLE_TEMPLATE_HASH SymTableTemplate_hashString
+#define SYMTABLE_TEMPLATE_EQUAL(pcKey1, pcKey2) \
+   (strcmp(pcKey1, pcKey2) == 0)
+#include "symtabletemplate.h"
+
+/* A Point is a value of PointTable. */
+
+struct Point
+{
+   /* The x coordinate */
+   int iX;
+   /* The y coordinate */
+   int iY;
+};
+
+/* PointTable, a table that maps integers to unboxed Points */
+
+#define SYMTABLE_TEMPLATE_NAME PointTable
+#define SYMTABLE_TEMPLATE_KEY unsigned int
+#define SYMTABLE_TEMPLATE_VALUE struct Point
+#define SYMTABLE_TEMPLATE_HASH SymTableTemplate_hashInt
+#define SYMTABLE_TEMPLATE_EQUAL SymTableTemplate_equal
+#include "symtabletemplate.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Test tables instantiated from symtabletemplate.h with
+   iBindingCount bindings. */
+
+static void testTemplate(int iBindingCount)
+{
+   static const char *apcWords[] =
+      {"the", "cat", "and", "the", "hat", "and", "the", "bat"};
+   WordCounts *poWords;
+   PointTable oPoints;
+   struct Point sPoint;
+   long *plCount;
+   long lCount = 0;
+   long lTotal;
+   const char *pcWord;
+   size_t uCursor;
+   unsigned int uKey;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing tables instantiated from symtabletemplate.h.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Count the words in place through the pointer to each value. */
+   poWords = WordCounts_new();
+   ASSURE(poWords != NULL);
+   for (i = 0; i < (int)(sizeof(apcWords) / sizeof(apcWords[0])); i++)
+   {
+      plCount = WordCounts_lookup(poWords, apcWords[i]);
+      if (plCount != NULL)
+         (*plCount)++;
+      else
+         ASSURE(WordCounts_put(poWords, apcWords[i], 1));
+   }
+   ASSURE(WordCounts_getLength(poWords) == 5);
+   ASSURE(WordCounts_get(poWords, "the", &lCount));
+   ASSURE(lCount == 3);
+   ASSURE(! WordCounts_get(poWords, "dog", &lCount));
+   ASSURE(! WordCounts_put(poWords, "cat", 7));
+   ASSURE(WordCounts_replace(poWords, "cat", 7, &lCount));
+   ASSURE(lCount == 1);
+   ASSURE(WordCounts_remove(poWords, "and", &lCount));
+   ASSURE(lCount == 2);
+   ASSURE(! WordCounts_contains(poWords, "and"));
+
+   lTotal = 0;
+   for (uCursor = 0;
+        WordCounts_next(poWords, &uCursor, &pcWord, &lCount); )
+   {
+      ASSURE(WordCounts_contains(poWords, pcWord));
+      lTotal += lCount;
+   }
+   ASSURE(lTotal == 3 + 7 + 1 + 1);
+   WordCounts_free(poWords);
+
+   /* An embedded table of structures, through several resizes. */
+   ASSURE(PointTable_init(&oPoints));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sPoint.iX = i;
+      sPoint.iY = -i;
+      iSuccessful = PointTable_put(&oPoints, (unsigned int)i, sPoint);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iBindingCount; i += 3)
+      ASSURE(PointTable_remove(&oPoints, (unsigned int)i, NULL));
+   ASSURE(PointTable_reserve(&oPoints, (size_t)iBindingCount * 2));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      iSuccessful = PointTable_get(&oPoints, (unsigned int)i, &sPoint);
+      ASSURE(iSuccessful == (i % 3 != 0));
+      if (iSuccessful)
+         ASSURE(sPoint.iX == i && sPoint.iY == -i);
+   }
+   i = 0;
+   for (uCursor = 0; PointTable_next(&oPoints, &uCursor, &uKey, NULL); )
+   {
+      ASSURE(uKey % 3 != 0);
+      i++;
+   }
+   ASSURE((size_t)i == PointTable_getLength(&oPoints));
+   PointTable_destroy(&oPoints);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that the filter of filtered hash SymTable objects stays
+   correct as keys are added and removed, and that it spares most
+   lookups of absent keys their key comparisons. */
+
+enum {FILTER_BINDING_COUNT = 20000};
+
+static void testFilter(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   struct SymTableStats sStats;
+   size_t uComparisons;
+   char acKey[32];
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing filtered hash SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableHash_new(SYMTABLEHASH_FILTERED |
+      SYMTABLEHASH_KEYED);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < FILTER_BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+
+   /* Misses compare keys only for the few false positives. */
+   SymTable_getStats(oSymTable, &sStats);
+   uComparisons = sStats.keyComparisons;
+   for (i = 0; i < FILTER_BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "miss%d", i);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   if (SymTable_getStats(oSymTable, &sStats))
+      ASSURE(sStats.keyComparisons - uComparisons
+         < FILTER_BINDING_COUNT / 20);
+
+   /* Removing most keys rebuilds the filter along the way. */
+   for (i = 0; i < FILTER_BINDING_COUNT; i++)
+      if (i % 4 != 0)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+      }
+
+   /* A clone is filtered too. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(strcmp(SymTable_getBackend(oClone), "hash-keyed") == 0);
+   for (i = 0; i < FILTER_BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 4 == 0));
+      ASSURE(SymTable_contains(oClone, acKey) == (i % 4 == 0));
+   }
+   SymTable_getStats(oClone, &sStats);
+   uComparisons = sStats.keyComparisons;
+   for (i = 0; i < FILTER_BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "miss%d", i);
+      ASSURE(! SymTable_contains(oClone, acKey));
+   }
+   if (SymTable_getStats(oClone, &sStats))
+      ASSURE(sStats.keyComparisons - uComparisons
+         < FILTER_BINDING_COUNT / 20);
+   SymTable_free(oClone);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Append to the string pvExtra the key pcKey, which is one
+   character long. */
+
+static void appendKey(const char *pcKey, void *pvExtra)
+{
+   char *pcKeys = (char*)pvExtra;
+   size_t uLength = strlen(pcKeys);
+
+   assert(strlen(pcKey) == 1);
+
+   pcKeys[uLength] = pcKey[0];
+   pcKeys[uLength + 1] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the string pcKeys holds the characters of pcExpected,
+   in any order, and 0 otherwise. */
+
+static int sameKeys(const char *pcKeys, const char *pcExpected)
+{
+   if (strlen(pcKeys) != strlen(pcExpected))
+      return 0;
+   for (; *pcExpected != '\0'; pcExpected++)
+      if (strchr(pcKeys, *pcExpected) == NULL)
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymSet objects with iBindingCount keys. */
+
+static void testSet(int iBindingCount)
+{
+   SymSet_T oSymSet1;
+   SymSet_T oSymSet2;
+   SymSet_T oResult;
+   char acKeys[16];
+   char acKey[32];
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymSet objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymSet1 = SymSet_new();
+   ASSURE(oSymSet1 != NULL);
+   oSymSet2 = SymSet_new();
+   ASSURE(oSymSet2 != NULL);
+   ASSURE(SymSet_getLength(oSymSet1) == 0);
+   ASSURE(SymSet_add(oSymSet1, "a"));
+   ASSURE(SymSet_add(oSymSet1, "b"));
+   ASSURE(SymSet_add(oSymSet1, "c"));
+   ASSURE(! SymSet_add(oSymSet1, "c"));
+   ASSURE(SymSet_add(oSymSet1, ""));
+   ASSURE(SymSet_remove(oSymSet1, ""));
+   ASSURE(! SymSet_remove(oSymSet1, ""));
+   ASSURE(SymSet_add(oSymSet2, "b"));
+   ASSURE(SymSet_add(oSymSet2, "c"));
+   ASSURE(SymSet_add(oSymSet2, "d"));
+   ASSURE(SymSet_contains(oSymSet1, "a"));
+   ASSURE(! SymSet_contains(oSymSet1, "d"));
+   ASSURE(SymSet_getLength(oSymSet1) == 3);
+
+   acKeys[0] = '\0';
+   SymSet_map(oSymSet1, appendKey, acKeys);
+   ASSURE(sameKeys(acKeys, "abc"));
+
+   oResult = SymSet_union(oSymSet1, oSymSet2);
+   ASSURE(oResult != NULL);
+   acKeys[0] = '\0';
+   SymSet_map(oResult, appendKey, acKeys);
+   ASSURE(sameKeys(acKeys, "abcd"));
+   SymSet_free(oResult);
+
+   oResult = SymSet_intersection(oSymSet1, oSymSet2);
+   ASSURE(oResult != NULL);
+   acKeys[0] = '\0';
+   SymSet_map(oResult, appendKey, acKeys);
+   ASSURE(sameKeys(acKeys, "bc"));
+   SymSet_free(oResult);
+
+   oResult = SymSet_difference(oSymSet1, oSymSet2);
+   ASSURE(oResult != NULL);
+   acKeys[0] = '\0';
+   SymSet_map(oResult, appendKey, acKeys);
+   ASSURE(sameKeys(acKeys, "a"));
+   SymSet_free(oResult);
+
+   oResult = SymSet_difference(oSymSet2, oSymSet2);
+   ASSURE(oResult != NULL);
+   ASSURE(SymSet_getLength(oResult) == 0);
+   SymSet_free(oResult);
+   SymSet_free(oSymSet1);
+   SymSet_free(oSymSet2);
+
+   /* Multiples of 2 and of 3, through several expansions. */
+   oSymSet1 = SymSet_new();
+   ASSURE(oSymSet1 != NULL);
+   oSymSet2 = SymSet_new();
+   ASSURE(oSymSet2 != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymSet_add(oSymSet1, acKey);
+         ASSURE(iSuccessful);
+      }
+      if (i % 3 == 0)
+      {
+         iSuccessful = SymSet_add(oSymSet2, acKey);
+         ASSURE(iSuccessful);
+      }
+   }
+   oResult = SymSet_intersection(oSymSet1, oSymSet2);
+   ASSURE(oResult != NULL);
+   ASSURE(SymSet_getLength(oResult) == (size_t)(iBindingCount + 5) / 6);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymSet_contains(oResult, acKey) == (i % 6 == 0));
+   }
+   SymSet_free(oResult);
+   oResult = SymSet_union(oSymSet1, oSymSet2);
+   ASSURE(oResult != NULL);
+   ASSURE(SymSet_getLength(oResult) == SymSet_getLength(oSymSet1)
+      + SymSet_getLength(oSymSet2) - (size_t)(iBindingCount + 5) / 6);
+   SymSet_free(oResult);
+   SymSet_free(oSymSet1);
+   SymSet_free(oSymSet2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Append to the string pvExtra the key pcKey, which is one
+   character long, ignoring pvValue. */
+
+static void appendBindingKey(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pvValue;
+   appendKey(pcKey, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store in pcKeys the keys of oSymTable, each one character long, in
+   the order SymTable_map visits them. */
+
+static void getKeyOrder(SymTable_T oSymTable, char *pcKeys)
+{
+   pcKeys[0] = '\0';
+   SymTable_map(oSymTable, appendBindingKey, pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test list SymTable objects created with the move-to-front and
+   transpose policies: each lookup hit reorders the list, and every
+   operation still finds the right binding afterwards. */
+
+static void testListPolicies(void)
+{
+   SymTable_T oSymTable;
+   char acValues[] = "abcd";
+   char acKeys[8];
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the self-organizing policies of list SymTable ");
+   printf("objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Each key is bound to its own character of acValues. */
+   oSymTable = SymTableList_new(SYMTABLE_LIST_MOVE_TO_FRONT);
+   ASSURE(oSymTable != NULL);
+   SymTable_put(oSymTable, "a", &acValues[0]);
+   SymTable_put(oSymTable, "b", &acValues[1]);
+   SymTable_put(oSymTable, "c", &acValues[2]);
+   SymTable_put(oSymTable, "d", &acValues[3]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "abcd") == 0);
+   ASSURE(SymTable_get(oSymTable, "c") == &acValues[2]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cabd") == 0);
+   ASSURE(SymTable_contains(oSymTable, "d"));
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "dcab") == 0);
+   ASSURE(SymTable_replace(oSymTable, "a", &acValues[1])
+      == &acValues[0]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "adcb") == 0);
+   /* A hit on the head and a miss leave the order alone. */
+   ASSURE(SymTable_get(oSymTable, "a") == &acValues[1]);
+   ASSURE(SymTable_get(oSymTable, "e") == NULL);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "adcb") == 0);
+   ASSURE(SymTable_remove(oSymTable, "c") == &acValues[2]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "adb") == 0);
+   ASSURE(SymTable_get(oSymTable, "b") == &acValues[1]);
+   ASSURE(SymTable_get(oSymTable, "d") == &acValues[3]);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTableList_new(SYMTABLE_LIST_TRANSPOSE);
+   ASSURE(oSymTable != NULL);
+   SymTable_put(oSymTable, "a", &acValues[0]);
+   SymTable_put(oSymTable, "b", &acValues[1]);
+   SymTable_put(oSymTable, "c", &acValues[2]);
+   SymTable_put(oSymTable, "d", &acValues[3]);
+   ASSURE(SymTable_get(oSymTable, "c") == &acValues[2]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "acbd") == 0);
+   /* Swapping with the head makes a new head. */
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cabd") == 0);
+   ASSURE(SymTable_replace(oSymTable, "d", &acValues[0])
+      == &acValues[3]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cadb") == 0);
+   ASSURE(SymTable_get(oSymTable, "c") == &acValues[2]);
+   ASSURE(SymTable_get(oSymTable, "e") == NULL);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cadb") == 0);
+   ASSURE(SymTable_remove(oSymTable, "a") == &acValues[0]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cdb") == 0);
+   ASSURE(SymTable_get(oSymTable, "d") == &acValues[0]);
+   ASSURE(SymTable_get(oSymTable, "b") == &acValues[1]);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   SymTable_free(oSymTable);
+
+   /* A list of one node has nothing to reorder. */
+   oSymTable = SymTableList_new(SYMTABLE_LIST_TRANSPOSE);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "a", &acValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "a") == &acValues[0]);
+   ASSURE(SymTable_contains(oSymTable, "a"));
+   ASSURE(SymTable_replace(oSymTable, "a", &acValues[1])
+      == &acValues[0]);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "a") == 0);
+   ASSURE(SymTable_remove(oSymTable, "a") == &acValues[1]);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTable_put(oSymTable, "b", &acValues[1]);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "b") == 0);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTableList_new(SYMTABLE_LIST_MOVE_TO_FRONT);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "a", &acValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "a") == &acValues[0]);
+   ASSURE(SymTable_remove(oSymTable, "a") == &acValues[0]);
+   ASSURE(SymTable_get(oSymTable, "a") == NULL);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTableList_putUnique, and the tail of list SymTable objects
+   after each change that can move it: removing the last node,
+   emptying the list, and a lookup that moves the last node. A stale
+   tail would lose or misplace the next node appended. */
+
+static void testListTail(void)
+{
+   SymTable_T oSymTable;
+   char acKeys[8];
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the tail of list SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Bindings added by putUnique are seen by put's duplicate
+      check, and put appends after them. */
+   oSymTable = SymTableList_new(SYMTABLE_LIST_STATIC);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTableList_putUnique(oSymTable, "a", NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableList_putUnique(oSymTable, "b", NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "b", NULL);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "c", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "abc") == 0);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   /* Removing the last node makes its predecessor the tail. */
+   ASSURE(SymTable_remove(oSymTable, "c") == NULL);
+   iSuccessful = SymTable_put(oSymTable, "d", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "abd") == 0);
+   ASSURE(SymTable_remove(oSymTable, "d") == NULL);
+   iSuccessful = SymTableList_putUnique(oSymTable, "e", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "abe") == 0);
+
+   /* Emptying the list leaves no tail. */
+   SymTable_remove(oSymTable, "a");
+   SymTable_remove(oSymTable, "e");
+   SymTable_remove(oSymTable, "b");
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTableList_putUnique(oSymTable, "f", NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "g", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "fg") == 0);
+   SymTable_free(oSymTable);
+
+   /* Moving the last node to the front makes its predecessor the
+      tail. */
+   oSymTable = SymTableList_new(SYMTABLE_LIST_MOVE_TO_FRONT);
+   ASSURE(oSymTable != NULL);
+   SymTableList_putUnique(oSymTable, "a", NULL);
+   SymTableList_putUnique(oSymTable, "b", NULL);
+   SymTableList_putUnique(oSymTable, "c", NULL);
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   iSuccessful = SymTable_put(oSymTable, "d", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "cabd") == 0);
+   ASSURE(SymTable_contains(oSymTable, "d"));
+   iSuccessful = SymTableList_putUnique(oSymTable, "e", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "dcabe") == 0);
+   SymTable_free(oSymTable);
+
+   /* So does swapping the last node with its predecessor. */
+   oSymTable = SymTableList_new(SYMTABLE_LIST_TRANSPOSE);
+   ASSURE(oSymTable != NULL);
+   SymTableList_putUnique(oSymTable, "a", NULL);
+   SymTableList_putUnique(oSymTable, "b", NULL);
+   SymTableList_putUnique(oSymTable, "c", NULL);
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   iSuccessful = SymTable_put(oSymTable, "d", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "acbd") == 0);
+   ASSURE(SymTable_contains(oSymTable, "d"));
+   iSuccessful = SymTableList_putUnique(oSymTable, "e", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "acdbe") == 0);
+   ASSURE(SymTable_remove(oSymTable, "e") == NULL);
+   ASSURE(SymTable_contains(oSymTable, "b"));
+   iSuccessful = SymTable_put(oSymTable, "f", NULL);
+   ASSURE(iSuccessful);
+   getKeyOrder(oSymTable, acKeys);
+   ASSURE(strcmp(acKeys, "acbdf") == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the key pcKey, a decimal number, is greater than the
+   int that pvExtra points to, and store it there. pvValue must
+   point to the same number. */
+
+static void checkAscending(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   int *piPrevious = (int*)pvExtra;
+   int iKey;
+
+   ASSURE(sscanf(pcKey, "%d", &iKey) == 1);
+   ASSURE(iKey > *piPrevious);
+   ASSURE(*(int*)pvValue == iKey);
+   *piPrevious = iKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that SymTable objects created with the compact backend,
+   holding up to 2 * iBindingCount bindings, are mapped in the order
+   their bindings were put. */
+
+static void testCompact(int iBindingCount)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   char acKeys[8];
+   char acKey[32];
+   int *piValues;
+   size_t uExpected = 0;
+   int iPrevious;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing compact SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithBackend("compact");
+   ASSURE(oSymTable != NULL);
+   SymTable_put(oSymTable, "d", NULL);
+   SymTable_put(oSymTable, "a", NULL);
+   SymTable_put(oSymTable, "c", NULL);
+   SymTable_put(oSymTable, "b", NULL);
+   acKeys[0] = '\0';
+   SymTable_map(oSymTable, appendBindingKey, acKeys);
+   ASSURE(strcmp(acKeys, "dacb") == 0);
+
+   /* A key put again after its removal moves to the end, and
+      replacing a value does not move its key. */
+   SymTable_remove(oSymTable, "a");
+   SymTable_put(oSymTable, "a", NULL);
+   SymTable_replace(oSymTable, "c", acKeys);
+   acKeys[0] = '\0';
+   SymTable_map(oSymTable, appendBindingKey, acKeys);
+   ASSURE(strcmp(acKeys, "dcba") == 0);
+   SymTable_free(oSymTable);
+
+   /* The order survives growth, the closing of the holes left by
+      removals, and cloning. */
+   piValues = (int*)malloc(2 * (size_t)iBindingCount * sizeof(int));
+   ASSURE(piValues != NULL || iBindingCount == 0);
+   oSymTable = SymTable_newWithBackend("compact");
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < 2 * iBindingCount; i++)
+   {
+      piValues[i] = i;
+      if (i < iBindingCount || i % 3 != 0)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &piValues[i]);
+         ASSURE(iSuccessful);
+         uExpected++;
+      }
+      if (i < iBindingCount && i % 3 != 0)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &piValues[i]);
+         uExpected--;
+      }
+   }
+   ASSURE(SymTable_getLength(oSymTable) == uExpected);
+   iPrevious = -1;
+   SymTable_map(oSymTable, checkAscending, &iPrevious);
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   iPrevious = -1;
+   SymTable_map(oClone, checkAscending, &iPrevious);
+   for (i = 0; i < 2 * iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oClone, acKey)
+         == (i < iBindingCount ? i % 3 == 0 : i % 3 != 0));
+   }
+   SymTable_free(oClone);
+   SymTable_free(oSymTable);
+   free(piValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A ShardWorker object is the work of one thread of testShard. */
+
+struct ShardWorker
+{
+   /* The thread */
+   pthread_t thread;
+   /* The table shared by the threads */
+   SymTableShard_T oSymTableShard;
+   /* The thread uses the keys "<iThread>.<i>" for i in
+      0..iBindingCount-1 */
+   int iThread;
+   int iBindingCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Put, get, replace, and remove the keys of the ShardWorker
+   pvWorker, which no other thread uses, in its shared table. */
+
+static void *runShardWorker(void *pvWorker)
+{
+   struct ShardWorker *psWorker = (struct ShardWorker*)pvWorker;
+   char acKey[32];
+   int iSuccessful;
+   int i;
+
+   for (i = 0; i < psWorker->iBindingCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWorker->iThread, i);
+      iSuccessful = SymTableShard_put(psWorker->oSymTableShard, acKey,
+         psWorker);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < psWorker->iBindingCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWorker->iThread, i);
+      ASSURE(SymTableShard_get(psWorker->oSymTableShard, acKey)
+         == psWorker);
+      if (i % 2 == 0)
+         ASSURE(SymTableShard_remove(psWorker->oSymTableShard, acKey)
+            == psWorker);
+      else
+         ASSURE(SymTableShard_replace(psWorker->oSymTableShard, acKey,
+            NULL) == psWorker);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the size_t that pvExtra points to, ignoring pcKey and
+   pvValue. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTableShard objects with iBindingCount keys per thread,
+   used by one thread and then by several at once. */
+
+static void testShard(int iBindingCount)
+{
+   enum {SHARD_COUNT = 8, THREAD_COUNT = 4};
+   enum {SPREAD_SHARD_COUNT = 64, SPREAD_KEY_COUNT = 1000};
+
+   SymTableShard_T oSymTableShard;
+   SymTable_T oSymTable;
+   struct SymTableStats sStats;
+   struct ShardWorker asWorkers[THREAD_COUNT];
+   int aiNodes[SHARD_COUNT];
+   char acShortstop[] = "Shortstop";
+   char acKey[32];
+   size_t uCount;
+   size_t u;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTableShard objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(SymTableShard_getNodeCount() >= 1);
+   for (i = 1; i < SymTableShard_getNodeCount(); i++)
+      ASSURE(SymTableShard_getNodeId(i - 1) < SymTableShard_getNodeId(i));
+   ASSURE(SymTableShard_new(0, NULL, NULL) == NULL);
+   ASSURE(SymTableShard_new(SHARD_COUNT, "no such backend", NULL)
+      == NULL);
+
+   /* Shards are placed on the nodes they are given. */
+   for (i = 0; i < SHARD_COUNT; i++)
+      aiNodes[i] = SymTableShard_getNodeId(
+         (SHARD_COUNT - 1 - i) % SymTableShard_getNodeCount());
+   oSymTableShard = SymTableShard_new(SHARD_COUNT, "compact", aiNodes);
+   ASSURE(oSymTableShard != NULL);
+   ASSURE(SymTableShard_getShardCount(oSymTableShard) == SHARD_COUNT);
+   for (u = 0; u < SHARD_COUNT; u++)
+      ASSURE(SymTableShard_getNode(oSymTableShard, u) == aiNodes[u]);
+
+   iSuccessful = SymTableShard_put(oSymTableShard, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableShard_put(oSymTableShard, "Jeter", NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableShard_contains(oSymTableShard, "Jeter"));
+   ASSURE(SymTableShard_get(oSymTableShard, "Jeter") == acShortstop);
+   ASSURE(SymTableShard_getShard(oSymTableShard, "Jeter")
+      < SHARD_COUNT);
+   ASSURE(SymTableShard_getLength(oSymTableShard) == 1);
+   ASSURE(SymTableShard_remove(oSymTableShard, "Jeter") == acShortstop);
+   ASSURE(! SymTableShard_contains(oSymTableShard, "Jeter"));
+   SymTableShard_free(oSymTableShard);
+
+   /* The keys of one shard spread over the whole index of a compact
+      table, which picks home slots from the low bits of the same
+      hash that picks the shard, so that runs of probes stay short;
+      had the shard come from the low bits too, every key would share
+      one home slot in SPREAD_SHARD_COUNT. */
+   oSymTableShard = SymTableShard_new(SPREAD_SHARD_COUNT, NULL, NULL);
+   ASSURE(oSymTableShard != NULL);
+   oSymTable = SymTable_newWithBackend("compact");
+   ASSURE(oSymTable != NULL);
+   uCount = 0;
+   for (i = 0; uCount < SPREAD_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (SymTableShard_getShard(oSymTableShard, acKey) != 0)
+         continue;
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+      uCount++;
+   }
+   SymTable_getStats(oSymTable, &sStats);
+   ASSURE(sStats.meanChainLength < 8.0);
+   SymTable_free(oSymTable);
+   SymTableShard_free(oSymTableShard);
+
+   /* Threads using disjoint keys do not disturb each other. */
+   oSymTableShard = SymTableShard_new(SHARD_COUNT, NULL, NULL);
+   ASSURE(oSymTableShard != NULL);
+   for (i = 0; i < THREAD_COUNT; i++)
+   {
+      asWorkers[i].oSymTableShard = oSymTableShard;
+      asWorkers[i].iThread = i;
+      asWorkers[i].iBindingCount = iBindingCount;
+      ASSURE(pthread_create(&asWorkers[i].thread, NULL,
+         runShardWorker, &asWorkers[i]) == 0);
+   }
+   for (i = 0; i < THREAD_COUNT; i++)
+      pthread_join(asWorkers[i].thread, NULL);
+
+   ASSURE(SymTableShard_getLength(oSymTableShard)
+      == (size_t)(THREAD_COUNT * (iBindingCount / 2)));
+   uCount = 0;
+   SymTableShard_map(oSymTableShard, countBinding, &uCount);
+   ASSURE(uCount == SymTableShard_getLength(oSymTableShard));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d.%d", THREAD_COUNT - 1, i);
+      ASSURE(SymTableShard_contains(oSymTableShard, acKey)
+         == (i % 2 != 0));
+   }
+   SymTableShard_free(oSymTableShard);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge a table of backend pcSrcBackend that binds the keys i in
+   0..iBindingCount-1 with i % 3 == 0 into a table of backend
+   pcDstBackend that binds those with i % 2 == 0, resolving conflicts
+   as eConflict says, and check both tables afterwards. */
+
+static void checkMerge(const char *pcDstBackend,
+   const char *pcSrcBackend, enum SymTableConflict eConflict,
+   int iBindingCount)
+{
+   SymTable_T oDst;
+   SymTable_T oSrc;
+   char acDst[] = "dst";
+   char acSrc[] = "src";
+   char acKey[32];
+   char *pcWinner;
+   char *pcLoser;
+   size_t uBoth = 0;
+   size_t uEither = 0;
+   int iSuccessful;
+   int i;
+
+   oDst = SymTable_newWithBackend(pcDstBackend);
+   oSrc = SymTable_newWithBackend(pcSrcBackend);
+   ASSURE(oDst != NULL);
+   ASSURE(oSrc != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 2 == 0)
+         ASSURE(SymTable_put(oDst, acKey, acDst));
+      if (i % 3 == 0)
+         ASSURE(SymTable_put(oSrc, acKey, acSrc));
+      if (i % 6 == 0)
+         uBoth++;
+      if (i % 2 == 0 || i % 3 == 0)
+         uEither++;
+   }
+
+   iSuccessful = SymTable_merge(oDst, oSrc, eConflict);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oDst) == uEither);
+   ASSURE(SymTable_getLength(oSrc) == uBoth);
+   pcWinner = eConflict == SYMTABLE_KEEP_DST ? acDst : acSrc;
+   pcLoser = eConflict == SYMTABLE_KEEP_DST ? acSrc : acDst;
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 6 == 0)
+      {
+         ASSURE(SymTable_get(oDst, acKey) == pcWinner);
+         ASSURE(SymTable_get(oSrc, acKey) == pcLoser);
+      }
+      else
+      {
+         ASSURE(! SymTable_contains(oSrc, acKey));
+         if (i % 2 == 0)
+            ASSURE(SymTable_get(oDst, acKey) == acDst);
+         else if (i % 3 == 0)
+            ASSURE(SymTable_get(oDst, acKey) == acSrc);
+         else
+            ASSURE(! SymTable_contains(oDst, acKey));
+      }
+   }
+
+   /* Both tables remain usable. */
+   iSuccessful = SymTable_put(oSrc, "Jeter", acSrc);
+   ASSURE(iSuccessful);
+   if (iBindingCount > 0)
+      ASSURE(SymTable_remove(oDst, "0") == pcWinner);
+   SymTable_free(oDst);
+   SymTable_free(oSrc);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge THREAD_COUNT tables of backend pcBackend, where table k binds
+   the keys i in 0..iBindingCount-1 with i % 8 == k or i % 3 == 0 to
+   &aiTables[k], with SymTableMerge_reduce, and check the result. */
+
+static void checkReduce(const char *pcBackend,
+   enum SymTableConflict eConflict, size_t uThreadCount,
+   int iBindingCount)
+{
+   enum {TABLE_COUNT = 8};
+
+   SymTable_T aoTables[TABLE_COUNT];
+   int aiTables[TABLE_COUNT];
+   char acKey[32];
+   size_t uShared = 0;
+   size_t uLosers = 0;
+   int iSuccessful;
+   int i, k;
+
+   for (k = 0; k < TABLE_COUNT; k++)
+   {
+      aiTables[k] = k;
+      aoTables[k] = SymTable_newWithBackend(pcBackend);
+      ASSURE(aoTables[k] != NULL);
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      for (k = 0; k < TABLE_COUNT; k++)
+         if (i % TABLE_COUNT == k || i % 3 == 0)
+            ASSURE(SymTable_put(aoTables[k], acKey, &aiTables[k]));
+      if (i % 3 == 0)
+         uShared++;
+   }
+
+   iSuccessful = SymTableMerge_reduce(aoTables, TABLE_COUNT, eConflict,
+      uThreadCount);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(aoTables[0]) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 3 != 0)
+         ASSURE(SymTable_get(aoTables[0], acKey)
+            == &aiTables[i % TABLE_COUNT]);
+      else if (eConflict == SYMTABLE_KEEP_DST)
+         ASSURE(SymTable_get(aoTables[0], acKey) == &aiTables[0]);
+      else
+         ASSURE(SymTable_get(aoTables[0], acKey)
+            == &aiTables[TABLE_COUNT - 1]);
+   }
+   for (k = 1; k < TABLE_COUNT; k++)
+      uLosers += SymTable_getLength(aoTables[k]);
+   ASSURE(uLosers == (TABLE_COUNT - 1) * uShared);
+   for (k = 0; k < TABLE_COUNT; k++)
+      SymTable_free(aoTables[k]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_merge and SymTableMerge_reduce with iBindingCount
+   keys. */
+
+static void testMerge(int iBindingCount)
+{
+   enum {SMALL_COUNT = 40};
+
+   const char *pcBackend;
+   size_t u, v;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing merging SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < SymTable_getBackendCount(); u++)
+   {
+      pcBackend = SymTable_getBackendName(u);
+      checkMerge(pcBackend, pcBackend, SYMTABLE_KEEP_DST, iBindingCount);
+      checkMerge(pcBackend, pcBackend, SYMTABLE_KEEP_SRC, iBindingCount);
+      /* Small tables exercise the inline entries of the hash
+         backends, and mixed backends the merge through puts. */
+      for (v = 0; v < SymTable_getBackendCount(); v++)
+      {
+         checkMerge(pcBackend, SymTable_getBackendName(v),
+            SYMTABLE_KEEP_DST, SMALL_COUNT);
+         checkMerge(SymTable_getBackendName(v), pcBackend,
+            SYMTABLE_KEEP_SRC, 5);
+      }
+   }
+
+   checkReduce("hash", SYMTABLE_KEEP_DST, 4, iBindingCount);
+   checkReduce("hash", SYMTABLE_KEEP_SRC, 1, iBindingCount);
+   checkReduce("compact", SYMTABLE_KEEP_SRC, 3, iBindingCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A ShmReader object is the work of the reading thread of
+   testShm. */
+
+struct ShmReader
+{
+   /* The thread */
+   pthread_t thread;
+   /* The reader's own attachment to the shared table */
+   SymTable_T oSymTable;
+   /* The keys "s<i>" for i in 0..iStableCount-1 stay bound to i + 1 */
+   int iStableCount;
+   /* Number of lookups that found a wrong value */
+   int iWrongCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Get the stable keys of the ShmReader pvReader over and over until
+   its table binds the key "stop", counting the lookups that find a
+   wrong value while another thread changes the table. */
+
+static void *runShmReader(void *pvReader)
+{
+   struct ShmReader *psReader = (struct ShmReader*)pvReader;
+   char acKey[32];
+   int i;
+
+   while (! SymTable_contains(psReader->oSymTable, "stop"))
+      for (i = 0; i < psReader->iStableCount; i++)
+      {
+         sprintf(acKey, "s%d", i);
+         if (SymTable_get(psReader->oSymTable, acKey)
+            != (void*)(size_t)(i + 1))
+            psReader->iWrongCount++;
+      }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test shared SymTable objects with iBindingCount bindings: two
+   attachments to one object, which map it at different addresses,
+   a full object, and a thread and then a child process reading while
+   another writes. The name of the object includes the process ID, so
+   that test programs running at once do not share it. */
+
+static void testShm(int iBindingCount)
+{
+   enum {BYTES_PER_BINDING = 128, SMALL_BYTES = 4096,
+      STABLE_COUNT = 100};
+
+   char acName[64];
+   const char *pcName = acName;
+   size_t uBytes = SMALL_BYTES + (size_t)BYTES_PER_BINDING
+      * (size_t)(2 * iBindingCount + STABLE_COUNT);
+   SymTable_T oSymTable;
+   SymTable_T oSymTable2;
+   SymTable_T oClone;
+   struct ShmReader sReader;
+   char acKey[32];
+   size_t uCount;
+   pid_t iPid;
+   int iStatus;
+   int iReaped;
+   int iSuccessful;
+   int iFullCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing shared SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sprintf(acName, "/testsymtable.%ld.shm", (long)getpid());
+   ASSURE(SymTableShm_attach(pcName) == NULL);
+   ASSURE(SymTableShm_create(pcName, 64) == NULL);
+   ASSURE(! SymTableShm_unlink(pcName));
+
+   /* Bindings put through one attachment are seen through the
+      other, and the name can go while both are attached. */
+   oSymTable = SymTableShm_create(pcName, uBytes);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShm_create(pcName, uBytes) == NULL);
+   ASSURE(strcmp(SymTable_getBackend(oSymTable), "shm") == 0);
+   oSymTable2 = SymTableShm_attach(pcName);
+   ASSURE(oSymTable2 != NULL);
+   ASSURE(SymTableShm_unlink(pcName));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)i);
+      ASSURE(iSuccessful);
+   }
+   if (iBindingCount > 0)
+   {
+      iSuccessful = SymTable_put(oSymTable2, "0", NULL);
+      ASSURE(! iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable2) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable2, acKey) == (void*)(size_t)i);
+      if (i % 2 == 0)
+         ASSURE(SymTable_remove(oSymTable2, acKey) == (void*)(size_t)i);
+      else
+         ASSURE(SymTable_replace(oSymTable2, acKey, NULL)
+            == (void*)(size_t)i);
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 != 0));
+      ASSURE(SymTable_get(oSymTable, acKey) == NULL);
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)(iBindingCount / 2));
+
+   /* A clone is an ordinary table. */
+   oClone = SymTable_clone(oSymTable2);
+   ASSURE(oClone != NULL);
+   ASSURE(strcmp(SymTable_getBackend(oClone), "hash") == 0);
+   ASSURE(SymTable_getLength(oClone) == (size_t)(iBindingCount / 2));
+   SymTable_free(oClone);
+
+   /* A thread reading through its own attachment never sees a stable
+      binding change while another writes around it. */
+   for (i = 0; i < STABLE_COUNT; i++)
+   {
+      sprintf(acKey, "s%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)(i + 1));
+      ASSURE(iSuccessful);
+   }
+   sReader.oSymTable = oSymTable2;
+   sReader.iStableCount = STABLE_COUNT;
+   sReader.iWrongCount = 0;
+   ASSURE(pthread_create(&sReader.thread, NULL, runShmReader,
+      &sReader) == 0);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "c%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)i);
+      ASSURE(iSuccessful);
+      if (i % 3 != 0)
+         ASSURE(SymTable_remove(oSymTable, acKey) == (void*)(size_t)i);
+   }
+   iSuccessful = SymTable_put(oSymTable, "stop", NULL);
+   ASSURE(iSuccessful);
+   pthread_join(sReader.thread, NULL);
+   ASSURE(sReader.iWrongCount == 0);
+   SymTable_free(oSymTable);
+   SymTable_free(oSymTable2);
+
+   /* So does a child process with its own attachment, which takes the
+      lock to put "ready" before it starts reading. Its exit status is
+      0 if every lookup found the right value. */
+   oSymTable = SymTableShm_create(pcName, uBytes);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < STABLE_COUNT; i++)
+   {
+      sprintf(acKey, "s%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)(i + 1));
+      ASSURE(iSuccessful);
+   }
+   fflush(stdout);
+   iPid = fork();
+   ASSURE(iPid >= 0);
+   if (iPid == 0)
+   {
+      sReader.oSymTable = SymTableShm_attach(pcName);
+      if (sReader.oSymTable == NULL
+         || ! SymTable_put(sReader.oSymTable, "ready", NULL))
+         _exit(EXIT_FAILURE);
+      sReader.iWrongCount = 0;
+      runShmReader(&sReader);
+      SymTable_free(sReader.oSymTable);
+      _exit(sReader.iWrongCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+   }
+   if (iPid > 0)
+   {
+      iReaped = 0;
+      while (! iReaped && ! SymTable_contains(oSymTable, "ready"))
+         iReaped = waitpid(iPid, &iStatus, WNOHANG) == iPid;
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "c%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, (void*)(size_t)i);
+         ASSURE(iSuccessful);
+         if (i % 3 != 0)
+            ASSURE(SymTable_remove(oSymTable, acKey) == (void*)(size_t)i);
+      }
+      iSuccessful = SymTable_put(oSymTable, "stop", NULL);
+      ASSURE(iSuccessful);
+      if (! iReaped)
+         ASSURE(waitpid(iPid, &iStatus, 0) == iPid);
+      ASSURE(WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == EXIT_SUCCESS);
+   }
+   SymTable_free(oSymTable);
+   ASSURE(SymTableShm_unlink(pcName));
+
+   /* A full object refuses puts until a removal frees space of the
+      same size. */
+   oSymTable = SymTableShm_create(pcName, SMALL_BYTES);
+   ASSURE(oSymTable != NULL);
+   iFullCount = 0;
+   for (i = 0; i < SMALL_BYTES; i++)
+   {
+      sprintf(acKey, "%07d", i);
+      if (! SymTable_put(oSymTable, acKey, NULL))
+         break;
+      iFullCount++;
+   }
+   ASSURE(iFullCount > 0 && iFullCount < SMALL_BYTES);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iFullCount);
+   ASSURE(! SymTable_put(oSymTable, "a much longer key", NULL));
+   ASSURE(SymTable_remove(oSymTable, "0000000") == NULL);
+   ASSURE(! SymTable_contains(oSymTable, "0000000"));
+   iSuccessful = SymTable_put(oSymTable, "x", (void*)(size_t)1);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "x") == (void*)(size_t)1);
+   ASSURE(! SymTable_put(oSymTable, "y", NULL));
+   SymTable_free(oSymTable);
+   ASSURE(SymTableShm_unlink(pcName));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the statistics reported for SymTable objects created with
+   each registered backend. */
+
+static void testStats(void)
+{
+   enum {BINDING_COUNT = 100, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct SymTableStats sStats;
+   char acKey[MAX_KEY_LENGTH];
+   int iCountersMaintained;
+   int iSuccessful;
+   size_t uChainCount;
+   size_t u;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the statistics of each backend.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < SymTable_getBackendCount(); u++)
+   {
+      oSymTable = SymTable_newWithBackend(SymTable_getBackendName(u));
+      ASSURE(oSymTable != NULL);
+
+      SymTable_getStats(oSymTable, &sStats);
+      ASSURE(sStats.numBindings == 0);
+      ASSURE(sStats.maxChainLength == 0);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+         ASSURE(iSuccessful);
+      }
+      /* A backend may put without comparing keys, but a successful
+         lookup compares at least once. */
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_contains(oSymTable, acKey));
+      }
+
+      iCountersMaintained = SymTable_getStats(oSymTable, &sStats);
+      ASSURE(sStats.numBindings == BINDING_COUNT);
+      ASSURE(sStats.numChains > 0);
+      ASSURE(sStats.maxChainLength > 0);
+      ASSURE(sStats.meanChainLength >= 1.0);
+      ASSURE(sStats.meanChainLength <= (double)sStats.maxChainLength);
+      uChainCount = 0;
+      for (i = 0; i < SYMTABLE_CHAIN_HISTOGRAM_SIZE; i++)
+         uChainCount += sStats.chainHistogram[i];
+      ASSURE(uChainCount == sStats.numChains);
+      if (iCountersMaintained)
+      {
+         ASSURE(sStats.keyComparisons > 0);
+         ASSURE(sStats.bytesAllocated > 0);
+      }
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableScope object, which is built on SymTable objects,
+   with a stack of nested scopes. */
+
+static void testScopes(void)
+{
+   enum {SCOPE_COUNT = 20};
+
+   SymTableScope_T oScope;
+   char acOuter[] = "outer";
+   char acInner[] = "inner";
+   char acOther[] = "other";
+   char *pcValue;
+   int iSuccessful;
+   size_t uDepth;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTableScope object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oScope = SymTableScope_new();
+   ASSURE(oScope != NULL);
+   ASSURE(SymTableScope_getDepth(oScope) == 0);
+
+   iSuccessful = SymTableScope_put(oScope, "x", acOuter);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableScope_put(oScope, "x", acOuter);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTableScope_put(oScope, "y", acOuter);
+   ASSURE(iSuccessful);
+
+   /* Shadow x in an inner scope. */
+   SymTableScope_pushScope(oScope);
+   ASSURE(SymTableScope_getDepth(oScope) == 1);
+   iSuccessful = SymTableScope_put(oScope, "x", acInner);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableScope_put(oScope, "z", acInner);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTableScope_get(oScope, "x", &uDepth);
+   ASSURE(pcValue == acInner);
+   ASSURE(uDepth == 1);
+   pcValue = (char*)SymTableScope_get(oScope, "y", &uDepth);
+   ASSURE(pcValue == acOuter);
+   ASSURE(uDepth == 0);
+   ASSURE(SymTableScope_getLength(oScope) == 3);
+
+   /* Replace changes only the visible binding. */
+   pcValue = (char*)SymTableScope_replace(oScope, "x", acOther);
+   ASSURE(pcValue == acInner);
+   pcValue = (char*)SymTableScope_get(oScope, "x", NULL);
+   ASSURE(pcValue == acOther);
+
+   /* Popping the scope uncovers the outer x and removes z. */
+   SymTableScope_popScope(oScope);
+   ASSURE(SymTableScope_getDepth(oScope) == 0);
+   pcValue = (char*)SymTableScope_get(oScope, "x", &uDepth);
+   ASSURE(pcValue == acOuter);
+   ASSURE(uDepth == 0);
+   ASSURE(! SymTableScope_contains(oScope, "z"));
+   ASSURE(SymTableScope_getLength(oScope) == 2);
+
+   /* A name defined in the outermost scope is found from deep
+      inside, and each level can shadow it again. */
+   for (i = 1; i <= SCOPE_COUNT; i++)
+   {
+      SymTableScope_pushScope(oScope);
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymTableScope_put(oScope, "x", acInner);
+         ASSURE(iSuccessful);
+      }
+   }
+   pcValue = (char*)SymTableScope_get(oScope, "y", &uDepth);
+   ASSURE(pcValue == acOuter);
+   ASSURE(uDepth == 0);
+   pcValue = (char*)SymTableScope_get(oScope, "x", &uDepth);
+   ASSURE(pcValue == acInner);
+   ASSURE(uDepth == SCOPE_COUNT);
+   SymTableScope_popScope(oScope);
+   pcValue = (char*)SymTableScope_get(oScope, "x", &uDepth);
+   ASSURE(pcValue == acInner);
+   ASSURE(uDepth == SCOPE_COUNT - 2);
+   for (i = 1; i < SCOPE_COUNT; i++)
+      SymTableScope_popScope(oScope);
+   pcValue = (char*)SymTableScope_get(oScope, "x", &uDepth);
+   ASSURE(pcValue == acOuter);
+   ASSURE(uDepth == 0);
+
+   /* Free a SymTableScope object with open scopes. */
+   SymTableScope_pushScope(oScope);
+   iSuccessful = SymTableScope_put(oScope, "x", acInner);
+   ASSURE(iSuccessful);
+   SymTableScope_free(oScope);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to be large, that is, to
    contain iBindingCount bindings. Write the time consumed to stdout. */
 
@@ -960,6 +3322,28 @@ int main(int argc, char *argv[])
    testLongKey();
    testTableOfTables();
    testCollisions();
+   testLongChains();
+   testSipHash();
+   testBackends();
+   testClone();
+   testVersions();
+   testTransactions();
+   testDurable();
+   testText();
+   testCache();
+   testTtl();
+   testInt(iBindingCount);
+   testTemplate(iBindingCount);
+   testFilter();
+   testSet(iBindingCount);
+   testListPolicies();
+   testListTail();
+   testCompact(iBindingCount);
+   testShard(iBindingCount);
+   testMerge(iBindingCount);
+   testShm(iBindingCount);
+   testStats();
+   testScopes();
    testLargeTable(iBindingCount);
 
    printf("------------------------------------------------------\n");